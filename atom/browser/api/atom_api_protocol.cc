@@ -4,12 +4,15 @@
 
 #include "atom/browser/api/atom_api_protocol.h"
 
+#include <utility>
+
 #include "atom/browser/atom_browser_client.h"
 #include "atom/browser/atom_browser_main_parts.h"
 #include "atom/browser/browser.h"
 #include "atom/browser/net/url_request_async_asar_job.h"
 #include "atom/browser/net/url_request_buffer_job.h"
 #include "atom/browser/net/url_request_fetch_job.h"
+#include "atom/browser/net/url_request_stream_job.h"
 #include "atom/browser/net/url_request_string_job.h"
 #include "atom/common/native_mate_converters/callback.h"
 #include "atom/common/native_mate_converters/v8_value_converter.h"
@@ -45,6 +48,15 @@ namespace atom {
 
 namespace api {
 
+namespace {
+
+void RunStatsCallback(const Protocol::StatsCallback& callback,
+                      std::unique_ptr<base::DictionaryValue> stats) {
+  callback.Run(*stats);
+}
+
+}  // namespace
+
 // TODO(bridiver)
 // https://github.com/electron/electron/commit/1beba5bdc086671bed9205faa694817f5a07c6ad
 // causes a hang on shutdown
@@ -138,6 +150,96 @@ Protocol::ProtocolError Protocol::UninterceptProtocolInIO(
           PROTOCOL_OK : PROTOCOL_NOT_INTERCEPTED;
 }
 
+void Protocol::SetNativeRoutes(
+    const std::string& scheme, mate::Arguments* args) {
+  // Object of routes or null.
+  std::unique_ptr<NativeProtocolRoutes> routes;
+  base::DictionaryValue dict;
+  v8::Local<v8::Value> value;
+  if (args->GetNext(&dict)) {
+    std::string error;
+    routes = NativeProtocolRoutes::Create(scheme, dict, &error);
+    if (!routes) {
+      args->ThrowError(error);
+      return;
+    }
+  } else if (!(args->GetNext(&value) && value->IsNull())) {
+    args->ThrowError("Must pass null or an Object");
+    return;
+  }
+
+  CompletionCallback callback;
+  args->GetNext(&callback);
+  content::BrowserThread::PostTaskAndReplyWithResult(
+      content::BrowserThread::IO, FROM_HERE,
+      base::Bind(&Protocol::SetNativeRoutesInIO,
+                 request_context_getter_, scheme, base::Passed(&routes)),
+      base::Bind(&Protocol::OnIOCompleted,
+                 GetWeakPtr(), callback));
+}
+
+// static
+Protocol::ProtocolError Protocol::SetNativeRoutesInIO(
+    scoped_refptr<brightray::URLRequestContextGetter> request_context_getter,
+    const std::string& scheme,
+    std::unique_ptr<NativeProtocolRoutes> routes) {
+  auto job_factory = static_cast<AtomURLRequestJobFactory*>(
+      request_context_getter->job_factory());
+  return job_factory->SetNativeRoutes(scheme, std::move(routes)) ?
+      PROTOCOL_OK : PROTOCOL_NOT_REGISTERED;
+}
+
+void Protocol::SetResponseCacheSize(uint32_t size) {
+  content::BrowserThread::PostTask(
+      content::BrowserThread::IO, FROM_HERE,
+      base::Bind(&Protocol::SetResponseCacheSizeInIO,
+                 request_context_getter_, size));
+}
+
+// static
+void Protocol::SetResponseCacheSizeInIO(
+    scoped_refptr<brightray::URLRequestContextGetter> request_context_getter,
+    uint32_t size) {
+  auto job_factory = static_cast<AtomURLRequestJobFactory*>(
+      request_context_getter->job_factory());
+  job_factory->response_cache()->SetMaxSize(size);
+}
+
+void Protocol::InvalidateResponseCache(mate::Arguments* args) {
+  // All responses are removed when there is no prefix.
+  std::string prefix;
+  args->GetNext(&prefix);
+  content::BrowserThread::PostTask(
+      content::BrowserThread::IO, FROM_HERE,
+      base::Bind(&Protocol::InvalidateResponseCacheInIO,
+                 request_context_getter_, prefix));
+}
+
+// static
+void Protocol::InvalidateResponseCacheInIO(
+    scoped_refptr<brightray::URLRequestContextGetter> request_context_getter,
+    const std::string& prefix) {
+  auto job_factory = static_cast<AtomURLRequestJobFactory*>(
+      request_context_getter->job_factory());
+  job_factory->response_cache()->Invalidate(prefix);
+}
+
+void Protocol::GetResponseCacheStats(const StatsCallback& callback) {
+  content::BrowserThread::PostTaskAndReplyWithResult(
+      content::BrowserThread::IO, FROM_HERE,
+      base::Bind(&Protocol::GetResponseCacheStatsInIO,
+                 request_context_getter_),
+      base::Bind(&RunStatsCallback, callback));
+}
+
+// static
+std::unique_ptr<base::DictionaryValue> Protocol::GetResponseCacheStatsInIO(
+    scoped_refptr<brightray::URLRequestContextGetter> request_context_getter) {
+  auto job_factory = static_cast<AtomURLRequestJobFactory*>(
+      request_context_getter->job_factory());
+  return job_factory->response_cache()->GetStats();
+}
+
 const base::ListValue*
 Protocol::GetNavigatorHandlers(const std::string& partition) {
   auto browser_context = atom::AtomBrowserContext::From(partition, false);
@@ -238,6 +340,8 @@ void Protocol::BuildPrototype(
                  &Protocol::RegisterProtocol<URLRequestAsyncAsarJob>)
       .SetMethod("registerHttpProtocol",
                  &Protocol::RegisterProtocol<URLRequestFetchJob>)
+      .SetMethod("registerStreamProtocol",
+                 &Protocol::RegisterProtocol<URLRequestStreamJob>)
       .SetMethod("unregisterProtocol", &Protocol::UnregisterProtocol)
       .SetMethod("isProtocolHandled", &Protocol::IsProtocolHandled)
       .SetMethod("interceptStringProtocol",
@@ -248,7 +352,14 @@ void Protocol::BuildPrototype(
                  &Protocol::InterceptProtocol<URLRequestAsyncAsarJob>)
       .SetMethod("interceptHttpProtocol",
                  &Protocol::InterceptProtocol<URLRequestFetchJob>)
+      .SetMethod("interceptStreamProtocol",
+                 &Protocol::InterceptProtocol<URLRequestStreamJob>)
       .SetMethod("uninterceptProtocol", &Protocol::UninterceptProtocol)
+      .SetMethod("setNativeRoutes", &Protocol::SetNativeRoutes)
+      .SetMethod("setResponseCacheSize", &Protocol::SetResponseCacheSize)
+      .SetMethod("invalidateResponseCache",
+                 &Protocol::InvalidateResponseCache)
+      .SetMethod("getResponseCacheStats", &Protocol::GetResponseCacheStats)
       .SetMethod("isNavigatorProtocolHandled",
                  &Protocol::IsNavigatorProtocolHandled)
       .SetMethod("getNavigatorHandlers",
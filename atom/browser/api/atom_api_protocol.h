@@ -35,6 +35,7 @@ class Protocol : public mate::TrackableObject<Protocol> {
       base::Callback<void(const base::DictionaryValue&, v8::Local<v8::Value>)>;
   using CompletionCallback = base::Callback<void(v8::Local<v8::Value>)>;
   using BooleanCallback = base::Callback<void(bool)>;
+  using StatsCallback = base::Callback<void(const base::DictionaryValue&)>;
 
   static mate::Handle<Protocol> Create(
       v8::Isolate* isolate, AtomBrowserContext* browser_context);
@@ -66,17 +67,20 @@ class Protocol : public mate::TrackableObject<Protocol> {
     CustomProtocolHandler(
         v8::Isolate* isolate,
         net::URLRequestContextGetter* request_context,
-        const Handler& handler)
+        const Handler& handler,
+        ProtocolResponseCache* response_cache)
         : isolate_(isolate),
           request_context_(request_context),
-          handler_(handler) {}
+          handler_(handler),
+          response_cache_(response_cache) {}
     ~CustomProtocolHandler() override {}
 
     net::URLRequestJob* MaybeCreateJob(
         net::URLRequest* request,
         net::NetworkDelegate* network_delegate) const override {
       RequestJob* request_job = new RequestJob(request, network_delegate);
-      request_job->SetHandlerInfo(isolate_, request_context_.get(), handler_);
+      request_job->SetHandlerInfo(isolate_, request_context_.get(), handler_,
+                                  response_cache_.get());
       return request_job;
     }
 
@@ -84,6 +88,7 @@ class Protocol : public mate::TrackableObject<Protocol> {
     v8::Isolate* isolate_;
     scoped_refptr<net::URLRequestContextGetter> request_context_;
     Protocol::Handler handler_;
+    scoped_refptr<ProtocolResponseCache> response_cache_;
 
     DISALLOW_COPY_AND_ASSIGN(CustomProtocolHandler);
   };
@@ -117,7 +122,8 @@ class Protocol : public mate::TrackableObject<Protocol> {
       return PROTOCOL_REGISTERED;
     std::unique_ptr<CustomProtocolHandler<RequestJob>> protocol_handler(
         new CustomProtocolHandler<RequestJob>(
-            isolate, request_context_getter.get(), handler));
+            isolate, request_context_getter.get(), handler,
+            job_factory->response_cache()));
     if (job_factory->SetProtocolHandler(scheme, std::move(protocol_handler)))
       return PROTOCOL_OK;
     else
@@ -166,12 +172,33 @@ class Protocol : public mate::TrackableObject<Protocol> {
       return PROTOCOL_FAIL;
     std::unique_ptr<CustomProtocolHandler<RequestJob>> protocol_handler(
         new CustomProtocolHandler<RequestJob>(
-            isolate, request_context_getter.get(), handler));
+            isolate, request_context_getter.get(), handler,
+            job_factory->response_cache()));
     if (!job_factory->InterceptProtocol(scheme, std::move(protocol_handler)))
       return PROTOCOL_INTERCEPTED;
     return PROTOCOL_OK;
   }
 
+  // Set the routes of |scheme| that are served in IO thread.
+  void SetNativeRoutes(const std::string& scheme, mate::Arguments* args);
+  static ProtocolError SetNativeRoutesInIO(
+      scoped_refptr<brightray::URLRequestContextGetter> request_context_getter,
+      const std::string& scheme,
+      std::unique_ptr<NativeProtocolRoutes> routes);
+
+  // Configure the cache of responses sent by the handlers.
+  void SetResponseCacheSize(uint32_t size);
+  static void SetResponseCacheSizeInIO(
+      scoped_refptr<brightray::URLRequestContextGetter> request_context_getter,
+      uint32_t size);
+  void InvalidateResponseCache(mate::Arguments* args);
+  static void InvalidateResponseCacheInIO(
+      scoped_refptr<brightray::URLRequestContextGetter> request_context_getter,
+      const std::string& prefix);
+  void GetResponseCacheStats(const StatsCallback& callback);
+  static std::unique_ptr<base::DictionaryValue> GetResponseCacheStatsInIO(
+      scoped_refptr<brightray::URLRequestContextGetter> request_context_getter);
+
   // Restore the |scheme| to its original protocol handler.
   void UninterceptProtocol(const std::string& scheme, mate::Arguments* args);
   static ProtocolError UninterceptProtocolInIO(
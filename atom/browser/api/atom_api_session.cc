@@ -16,6 +16,7 @@
 #include "atom/browser/atom_browser_context.h"
 #include "atom/browser/atom_browser_main_parts.h"
 #include "atom/browser/net/atom_cert_verifier.h"
+#include "atom/browser/spare_renderer_pool.h"
 #include "atom/common/native_mate_converters/callback.h"
 #include "atom/common/native_mate_converters/content_converter.h"
 #include "atom/common/native_mate_converters/gurl_converter.h"
@@ -514,6 +515,20 @@ std::string Session::GetUserAgent() {
   return browser_context_->GetUserAgent();
 }
 
+void Session::SetSpareRendererPoolSize(int size, mate::Arguments* args) {
+  if (size < 0) {
+    args->ThrowError("Size must not be negative");
+    return;
+  }
+  browser_context_->spare_renderer_pool()->SetSize(size);
+}
+
+v8::Local<v8::Value> Session::GetSpareRendererPoolStats(
+    v8::Isolate* isolate) {
+  return mate::ConvertToV8(
+      isolate, *browser_context_->spare_renderer_pool()->GetStats());
+}
+
 void Session::SetEnableBrotli(bool enabled) {
   auto getter = browser_context_->GetRequestContext();
   getter->GetNetworkTaskRunner()->PostTask(
@@ -619,6 +634,10 @@ void Session::BuildPrototype(v8::Isolate* isolate,
       .SetMethod("setUserAgent", &Session::SetUserAgent)
       .SetMethod("getUserAgent", &Session::GetUserAgent)
       .SetMethod("setEnableBrotli", &Session::SetEnableBrotli)
+      .SetMethod("setSpareRendererPoolSize",
+                 &Session::SetSpareRendererPoolSize)
+      .SetMethod("getSpareRendererPoolStats",
+                 &Session::GetSpareRendererPoolStats)
       .SetMethod("equal", &Session::Equal)
       .SetProperty("userPrefs", &Session::UserPrefs)
       .SetProperty("cookies", &Session::Cookies)
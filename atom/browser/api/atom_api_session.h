@@ -77,6 +77,8 @@ class Session: public mate::TrackableObject<Session>,
   void SetUserAgent(const std::string& user_agent, mate::Arguments* args);
   std::string GetUserAgent();
   void SetEnableBrotli(bool enabled);
+  void SetSpareRendererPoolSize(int size, mate::Arguments* args);
+  v8::Local<v8::Value> GetSpareRendererPoolStats(v8::Isolate* isolate);
   v8::Local<v8::Value> Cookies(v8::Isolate* isolate);
   v8::Local<v8::Value> Protocol(v8::Isolate* isolate);
   v8::Local<v8::Value> WebRequest(v8::Isolate* isolate);
@@ -4,14 +4,18 @@
 
 #include "atom/browser/api/atom_api_web_contents.h"
 
+#include <memory>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "atom/browser/api/atom_api_debugger.h"
 #include "atom/browser/api/atom_api_session.h"
 #include "atom/browser/api/atom_api_web_request.h"
 #include "atom/browser/api/atom_api_window.h"
 #include "atom/browser/api/event.h"
+#include "atom/browser/api/frame_encoder.h"
 #include "atom/browser/atom_browser_client.h"
 #include "atom/browser/atom_browser_context.h"
 #include "atom/browser/atom_browser_main_parts.h"
@@ -35,8 +39,11 @@
 #include "atom/common/native_mate_converters/gurl_converter.h"
 #include "atom/common/native_mate_converters/image_converter.h"
 #include "atom/common/native_mate_converters/string16_converter.h"
+#include "atom/common/native_mate_converters/v8_value_serializer.h"
 #include "atom/common/native_mate_converters/value_converter.h"
 #include "atom/common/options_switches.h"
+#include "base/memory/shared_memory.h"
+#include "base/threading/sequenced_worker_pool.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
 #include "brave/browser/brave_content_browser_client.h"
@@ -51,6 +58,7 @@
 #include "components/ui/zoom/zoom_controller.h"
 #include "content/browser/renderer_host/render_widget_host_impl.h"
 #include "content/public/browser/browser_plugin_guest_manager.h"
+#include "content/public/browser/browser_thread.h"
 #include "content/public/browser/favicon_status.h"
 #include "content/public/browser/native_web_keyboard_event.h"
 #include "content/public/browser/navigation_details.h"
@@ -218,6 +226,116 @@ void OnCapturePageDone(base::Callback<void(const gfx::Image&)> callback,
   callback.Run(gfx::Image::CreateFrom1xBitmap(bitmap));
 }
 
+// The captures being encoded are shared by all pages, so a burst of captures
+// does not take every thread of the blocking pool, and the bitmaps waiting to
+// be encoded are bounded.
+const size_t kMaxRunningCaptureEncodings = 4;
+const size_t kMaxQueuedCaptureEncodings = 256;
+
+FrameEncoder* GetCapturePageEncoder() {
+  CR_DEFINE_STATIC_LOCAL(
+      FrameEncoder, encoder,
+      (content::BrowserThread::GetBlockingPool()
+           ->GetTaskRunnerWithShutdownBehavior(
+               base::SequencedWorkerPool::SKIP_ON_SHUTDOWN),
+       kMaxRunningCaptureEncodings, kMaxQueuedCaptureEncodings));
+  return &encoder;
+}
+
+using EncodedCaptureCallback =
+    base::Callback<void(v8::Local<v8::Value>, v8::Local<v8::Value>)>;
+
+void OnCapturePageEncoded(v8::Isolate* isolate,
+                          const EncodedCaptureCallback& callback,
+                          scoped_refptr<base::RefCountedBytes> data) {
+  v8::Locker locker(isolate);
+  v8::HandleScope handle_scope(isolate);
+  v8::Local<v8::Object> buffer;
+  if (!data || !node::Buffer::Copy(isolate,
+                                   reinterpret_cast<const char*>(data->front()),
+                                   data->size()).ToLocal(&buffer)) {
+    callback.Run(v8::Exception::Error(
+                     mate::StringToV8(isolate, "Failed to capture the page")),
+                 v8::Null(isolate));
+    return;
+  }
+  callback.Run(v8::Null(isolate), buffer);
+}
+
+// Called when CapturePage is done and the bitmap has to be encoded.
+void OnCapturePageDoneForEncoding(v8::Isolate* isolate,
+                                  FrameEncoder::Format format,
+                                  int quality,
+                                  const EncodedCaptureCallback& callback,
+                                  const SkBitmap& bitmap,
+                                  content::ReadbackResponse response) {
+  if (response != content::ReadbackResponse::READBACK_SUCCESS) {
+    OnCapturePageEncoded(isolate, callback, nullptr);
+    return;
+  }
+  if (!GetCapturePageEncoder()->Encode(
+          bitmap, format, quality,
+          base::Bind(&OnCapturePageEncoded, isolate, callback))) {
+    v8::Locker locker(isolate);
+    v8::HandleScope handle_scope(isolate);
+    callback.Run(v8::Exception::Error(mate::StringToV8(
+                     isolate, "Too many captures are being encoded")),
+                 v8::Null(isolate));
+  }
+}
+
+// Copies the large IPC buffers to a shared memory region owned by |process|.
+bool WriteSharedMemory(base::ProcessHandle process,
+                       size_t size,
+                       const SharedMemoryFiller& fill,
+                       base::SharedMemoryHandle* handle) {
+  base::SharedMemory memory;
+  if (!memory.CreateAndMapAnonymous(size))
+    return false;
+  fill.Run(static_cast<char*>(memory.memory()));
+  return memory.ShareToProcess(process, handle);
+}
+
+// Keeps the shared memory region written while serializing a broadcast, so
+// every receiving process gets a read-only handle of the same region.
+class BroadcastSharedMemory {
+ public:
+  BroadcastSharedMemory() {}
+
+  bool Write(size_t size,
+             const SharedMemoryFiller& fill,
+             base::SharedMemoryHandle* handle) {
+    base::SharedMemoryCreateOptions options;
+    options.size = size;
+    options.share_read_only = true;
+    std::unique_ptr<base::SharedMemory> memory(new base::SharedMemory);
+    if (!memory->Create(options) || !memory->Map(size))
+      return false;
+    fill.Run(static_cast<char*>(memory->memory()));
+    region_ = std::move(memory);
+    // Replaced with the handle of each receiver.
+    *handle = base::SharedMemoryHandle();
+    return true;
+  }
+
+  bool ShareToProcess(base::ProcessHandle process,
+                      std::vector<base::SharedMemoryHandle>* handles) {
+    handles->clear();
+    if (!region_)
+      return true;
+    base::SharedMemoryHandle handle;
+    if (!region_->ShareReadOnlyToProcess(process, &handle))
+      return false;
+    handles->push_back(handle);
+    return true;
+  }
+
+ private:
+  std::unique_ptr<base::SharedMemory> region_;
+
+  DISALLOW_COPY_AND_ASSIGN(BroadcastSharedMemory);
+};
+
 }  // namespace
 
 WebContents::WebContents(v8::Isolate* isolate,
@@ -879,6 +997,10 @@ bool WebContents::OnMessageReceived(const IPC::Message& message) {
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(WebContents, message)
     IPC_MESSAGE_HANDLER(AtomViewHostMsg_Message, OnRendererMessage)
+    IPC_MESSAGE_HANDLER(AtomViewHostMsg_StructuredMessage,
+                        OnRendererStructuredMessage)
+    IPC_MESSAGE_HANDLER(AtomViewHostMsg_Invoke, OnRendererInvoke)
+    IPC_MESSAGE_HANDLER(AtomViewHostMsg_InvokeCancel, OnRendererInvokeCancel)
     IPC_MESSAGE_HANDLER_DELAY_REPLY(AtomViewHostMsg_Message_Sync,
                                     OnRendererMessageSync)
     IPC_MESSAGE_HANDLER_CODE(ViewHostMsg_SetCursor, OnCursorChange,
@@ -1495,6 +1617,78 @@ bool WebContents::SendIPCMessage(bool all_frames,
   return Send(new AtomViewMsg_Message(routing_id(), all_frames, channel, args));
 }
 
+bool WebContents::SendStructuredIPCMessage(mate::Arguments* args,
+                                           bool all_frames,
+                                           const base::string16& channel,
+                                           v8::Local<v8::Value> value) {
+  base::ProcessHandle process =
+      web_contents()->GetRenderProcessHost()->GetHandle();
+  SerializedV8Value serialized;
+  std::string error;
+  if (!SerializeV8Value(isolate(), value,
+                        base::Bind(&WriteSharedMemory, process),
+                        &serialized, &error)) {
+    if (!error.empty())
+      args->ThrowError(error);
+    return false;
+  }
+  return Send(new AtomViewMsg_StructuredMessage(
+      routing_id(), all_frames, channel, serialized));
+}
+
+// static
+int WebContents::Broadcast(
+    mate::Arguments* args,
+    const std::vector<mate::Handle<WebContents>>& targets,
+    const base::string16& channel,
+    v8::Local<v8::Value> value) {
+  BroadcastSharedMemory shared_memory;
+  SerializedV8Value serialized;
+  std::string error;
+  if (!SerializeV8Value(args->isolate(), value,
+                        base::Bind(&BroadcastSharedMemory::Write,
+                                   base::Unretained(&shared_memory)),
+                        &serialized, &error)) {
+    if (!error.empty())
+      args->ThrowError(error);
+    return 0;
+  }
+
+  int sent = 0;
+  for (const auto& target : targets) {
+    if (target.IsEmpty() || !target->web_contents())
+      continue;
+    base::ProcessHandle process =
+        target->web_contents()->GetRenderProcessHost()->GetHandle();
+    if (shared_memory.ShareToProcess(process, &serialized.shared_buffers) &&
+        target->Send(new AtomViewMsg_BroadcastMessage(
+            target->routing_id(), channel, serialized)))
+      ++sent;
+  }
+  return sent;
+}
+
+void WebContents::ReplyInvoke(int request_id,
+                              bool success,
+                              v8::Local<v8::Value> result) {
+  base::ProcessHandle process =
+      web_contents()->GetRenderProcessHost()->GetHandle();
+  SerializedV8Value serialized;
+  std::string error;
+  v8::TryCatch try_catch(isolate());
+  if (!SerializeV8Value(isolate(), result,
+                        base::Bind(&WriteSharedMemory, process),
+                        &serialized, &error)) {
+    // The renderer gets the error instead of the result.
+    if (try_catch.HasCaught())
+      error = *v8::String::Utf8Value(try_catch.Exception());
+    SendInvokeError(request_id, error);
+    return;
+  }
+  Send(new AtomViewMsg_InvokeReply(routing_id(), request_id, success,
+                                   serialized));
+}
+
 void WebContents::SendInputEvent(v8::Isolate* isolate,
                                  v8::Local<v8::Value> input_event) {
   const auto view = web_contents()->GetRenderWidgetHostView();
@@ -1530,10 +1724,39 @@ void WebContents::SendInputEvent(v8::Isolate* isolate,
 }
 
 void WebContents::BeginFrameSubscription(mate::Arguments* args) {
-  bool only_dirty = false;
+  FrameSubscriber::Options options;
   FrameSubscriber::FrameCaptureCallback callback;
 
-  args->GetNext(&only_dirty);
+  v8::Local<v8::Value> peek = args->PeekNext();
+  mate::Dictionary dict;
+  if (!peek.IsEmpty() && !peek->IsFunction() && args->GetNext(&dict)) {
+    dict.Get("onlyDirty", &options.only_dirty);
+    dict.Get("maxSize", &options.max_size);
+    dict.Get("maxPendingFrames", &options.max_pending_frames);
+    dict.Get("reuseBuffer", &options.reuse_buffer);
+    std::string format;
+    if (dict.Get("format", &format)) {
+      if (format == "i420") {
+        options.format = FrameSubscriber::PixelFormat::I420;
+      } else if (FrameEncoder::ParseFormat(format, &options.encode_format)) {
+        options.encode = true;
+      } else if (format != "bgra") {
+        args->ThrowError("Unsupported pixel format: " + format);
+        return;
+      }
+    }
+    if (dict.Get("quality", &options.quality) &&
+        (options.quality < 0 || options.quality > 100)) {
+      args->ThrowError("quality must be between 0 and 100");
+      return;
+    }
+    if (options.max_pending_frames < 1) {
+      args->ThrowError("maxPendingFrames must be at least 1");
+      return;
+    }
+  } else {
+    args->GetNext(&options.only_dirty);
+  }
   if (!args->GetNext(&callback)) {
     args->ThrowError();
     return;
@@ -1542,7 +1765,7 @@ void WebContents::BeginFrameSubscription(mate::Arguments* args) {
   const auto view = web_contents()->GetRenderWidgetHostView();
   if (view) {
     std::unique_ptr<FrameSubscriber> frame_subscriber(new FrameSubscriber(
-        isolate(), view, callback, only_dirty));
+        isolate(), view, callback, options));
     view->BeginFrameSubscription(std::move(frame_subscriber));
   }
 }
@@ -1584,19 +1807,55 @@ void WebContents::StartDrag(const mate::Dictionary& item,
 
 void WebContents::CapturePage(mate::Arguments* args) {
   gfx::Rect rect;
+  mate::Dictionary options;
+  std::string format;
   base::Callback<void(const gfx::Image&)> callback;
+  EncodedCaptureCallback encoded_callback;
+
+  // The |options| are told apart from the |rect| by their "format".
+  if (args->Length() == 3) {
+    if (!args->GetNext(&rect) || !args->GetNext(&options) ||
+        !options.Get("format", &format)) {
+      args->ThrowError();
+      return;
+    }
+  } else if (args->Length() == 2) {
+    if (mate::ConvertFromV8(isolate(), args->PeekNext(), &options) &&
+        options.Get("format", &format)) {
+      args->GetNext(&options);
+    } else if (!args->GetNext(&rect)) {
+      args->ThrowError();
+      return;
+    }
+  }
 
-  if (!(args->Length() == 1 && args->GetNext(&callback)) &&
-      !(args->Length() == 2 && args->GetNext(&rect)
-                            && args->GetNext(&callback))) {
+  bool encode = !format.empty();
+  if (!(encode ? args->GetNext(&encoded_callback) :
+                 args->GetNext(&callback))) {
     args->ThrowError();
     return;
   }
 
+  FrameEncoder::Format encode_format = FrameEncoder::Format::PNG;
+  int quality = 90;
+  if (encode) {
+    if (!FrameEncoder::ParseFormat(format, &encode_format)) {
+      args->ThrowError("Unsupported image format: " + format);
+      return;
+    }
+    if (options.Get("quality", &quality) && (quality < 0 || quality > 100)) {
+      args->ThrowError("quality must be between 0 and 100");
+      return;
+    }
+  }
+
   const auto view = web_contents()->GetRenderWidgetHostView();
   const auto host = view ? view->GetRenderWidgetHost() : nullptr;
   if (!view || !host) {
-    callback.Run(gfx::Image());
+    if (encode)
+      OnCapturePageEncoded(isolate(), encoded_callback, nullptr);
+    else
+      callback.Run(gfx::Image());
     return;
   }
 
@@ -1615,10 +1874,13 @@ void WebContents::CapturePage(mate::Arguments* args) {
   if (scale > 1.0f)
     bitmap_size = gfx::ScaleToCeiledSize(view_size, scale);
 
-  host->CopyFromBackingStore(gfx::Rect(rect.origin(), view_size),
-                             bitmap_size,
-                             base::Bind(&OnCapturePageDone, callback),
-                             kBGRA_8888_SkColorType);
+  host->CopyFromBackingStore(
+      gfx::Rect(rect.origin(), view_size),
+      bitmap_size,
+      encode ? base::Bind(&OnCapturePageDoneForEncoding, isolate(),
+                          encode_format, quality, encoded_callback) :
+               base::Bind(&OnCapturePageDone, callback),
+      kBGRA_8888_SkColorType);
 }
 
 void WebContents::OnCursorChange(const content::WebCursor& cursor) {
@@ -1787,6 +2049,8 @@ void WebContents::BuildPrototype(v8::Isolate* isolate,
       .SetMethod("clone", &WebContents::Clone)
       .SetMethod("tabTraverse", &WebContents::TabTraverse)
       .SetMethod("_send", &WebContents::SendIPCMessage)
+      .SetMethod("_sendStructured", &WebContents::SendStructuredIPCMessage)
+      .SetMethod("_replyInvoke", &WebContents::ReplyInvoke)
       .SetMethod("sendInputEvent", &WebContents::SendInputEvent)
       .SetMethod("beginFrameSubscription",
                  &WebContents::BeginFrameSubscription)
@@ -1845,6 +2109,54 @@ void WebContents::OnRendererMessage(const base::string16& channel,
   Emit(base::UTF16ToUTF8(channel), args);
 }
 
+void WebContents::OnRendererStructuredMessage(
+    const base::string16& channel,
+    const SerializedV8Value& value) {
+  // The renderer can still write to the regions, so they are copied.
+  SharedMemoryList shared_buffers = TakeSharedMemory(value, true);
+  v8::Locker locker(isolate());
+  v8::HandleScope handle_scope(isolate());
+  v8::Context::Scope context_scope(GetWrapper()->CreationContext());
+  v8::Local<v8::Value> args =
+      DeserializeV8Value(isolate(), value.data, &shared_buffers, true);
+  if (args.IsEmpty() || !args->IsArray())
+    return;
+  // webContents.emit(channel, new Event(), args...);
+  Emit(base::UTF16ToUTF8(channel), args);
+}
+
+void WebContents::OnRendererInvoke(int request_id,
+                                   const base::string16& channel,
+                                   const SerializedV8Value& value) {
+  // The renderer can still write to the regions, so they are copied.
+  SharedMemoryList shared_buffers = TakeSharedMemory(value, true);
+  v8::Locker locker(isolate());
+  v8::HandleScope handle_scope(isolate());
+  v8::Context::Scope context_scope(GetWrapper()->CreationContext());
+  v8::Local<v8::Value> args =
+      DeserializeV8Value(isolate(), value.data, &shared_buffers, true);
+  if (args.IsEmpty() || !args->IsArray()) {
+    SendInvokeError(request_id, "Received malformed arguments");
+    return;
+  }
+  // webContents.emit('-ipc-invoke', new Event(), requestId, channel, args);
+  Emit("-ipc-invoke", request_id, channel, args);
+}
+
+void WebContents::OnRendererInvokeCancel(int request_id) {
+  Emit("-ipc-invoke-cancel", request_id);
+}
+
+void WebContents::SendInvokeError(int request_id, const std::string& error) {
+  v8::HandleScope handle_scope(isolate());
+  SerializedV8Value serialized;
+  std::string unused;
+  SerializeV8Value(isolate(), mate::StringToV8(isolate(), error),
+                   SharedMemoryWriter(), &serialized, &unused);
+  Send(new AtomViewMsg_InvokeReply(routing_id(), request_id, false,
+                                   serialized));
+}
+
 void WebContents::OnRendererMessageSync(const base::string16& channel,
                                         const base::ListValue& args,
                                         IPC::Message* message) {
@@ -1907,6 +2219,7 @@ void Initialize(v8::Local<v8::Object> exports, v8::Local<v8::Value> unused,
                  &mate::TrackableObject<atom::api::WebContents>::FromWeakMapID);
   dict.SetMethod("getAllWebContents",
                  &mate::TrackableObject<atom::api::WebContents>::GetAll);
+  dict.SetMethod("_broadcast", &atom::api::WebContents::Broadcast);
 }
 
 }  // namespace
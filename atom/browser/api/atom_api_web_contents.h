@@ -53,6 +53,7 @@ class Dictionary;
 
 namespace atom {
 
+struct SerializedV8Value;
 struct SetSizeParams;
 class AtomBrowserContext;
 class WebViewGuestDelegate;
@@ -191,6 +192,20 @@ class WebContents : public mate::TrackableObject<WebContents>,
   bool SendIPCMessage(bool all_frames,
                       const base::string16& channel,
                       const base::ListValue& args);
+  bool SendStructuredIPCMessage(mate::Arguments* args,
+                                bool all_frames,
+                                const base::string16& channel,
+                                v8::Local<v8::Value> value);
+
+  // Replies to an ipcRenderer.invoke request.
+  void ReplyInvoke(int request_id, bool success, v8::Local<v8::Value> result);
+
+  // Sends the message to the main frames of |targets|, serializing |value|
+  // once for all of them. Returns the number of WebContents it was sent to.
+  static int Broadcast(mate::Arguments* args,
+                       const std::vector<mate::Handle<WebContents>>& targets,
+                       const base::string16& channel,
+                       v8::Local<v8::Value> value);
 
   // Send WebInputEvent to the page.
   void SendInputEvent(v8::Isolate* isolate, v8::Local<v8::Value> input_event);
@@ -386,6 +401,17 @@ class WebContents : public mate::TrackableObject<WebContents>,
   void OnRendererMessage(const base::string16& channel,
                          const base::ListValue& args);
 
+  // Called when received a structured clone message from renderer.
+  void OnRendererStructuredMessage(const base::string16& channel,
+                                   const SerializedV8Value& value);
+
+  // Called when the renderer invokes a handler, or stops waiting for it.
+  void OnRendererInvoke(int request_id,
+                        const base::string16& channel,
+                        const SerializedV8Value& value);
+  void OnRendererInvokeCancel(int request_id);
+  void SendInvokeError(int request_id, const std::string& error);
+
   // Called when received a synchronous message from renderer.
   void OnRendererMessageSync(const base::string16& channel,
                              const base::ListValue& args,
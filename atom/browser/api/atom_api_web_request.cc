@@ -11,15 +11,125 @@
 #include "atom/common/native_mate_converters/gurl_converter.h"
 #include "atom/common/native_mate_converters/net_converter.h"
 #include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
 #include "content/public/browser/browser_thread.h"
 #include "native_mate/dictionary.h"
 #include "native_mate/object_template_builder.h"
+#include "native_mate/wrappable.h"
 #include "v8/include/v8.h"
 
 using content::BrowserThread;
 
+namespace {
+
+// Keeps the native details alive for the lazy properties of a details object.
+class LazyDetails : public mate::Wrappable<LazyDetails> {
+ public:
+  static v8::Local<v8::Object> Create(v8::Isolate* isolate,
+                                      atom::RequestDetails* details) {
+    return (new LazyDetails(isolate, details))->GetWrapper();
+  }
+
+  static void BuildPrototype(v8::Isolate* isolate,
+                             v8::Local<v8::ObjectTemplate> prototype) {
+  }
+
+  const atom::RequestDetails& details() const { return *details_.get(); }
+
+ protected:
+  LazyDetails(v8::Isolate* isolate, atom::RequestDetails* details)
+      : details_(details) {
+    Init(isolate);
+  }
+  ~LazyDetails() override {}
+
+ private:
+  scoped_refptr<atom::RequestDetails> details_;
+
+  DISALLOW_COPY_AND_ASSIGN(LazyDetails);
+};
+
+using LazyField = v8::Local<v8::Value>(*)(v8::Isolate* isolate,
+                                          const atom::RequestDetails& details);
+
+v8::Local<v8::Value> GetRequestHeaders(v8::Isolate* isolate,
+                                       const atom::RequestDetails& details) {
+  return mate::ConvertToV8(isolate, *details.GetRequestHeaders());
+}
+
+v8::Local<v8::Value> GetResponseHeaders(v8::Isolate* isolate,
+                                        const atom::RequestDetails& details) {
+  return mate::ConvertToV8(isolate, *details.GetResponseHeaders());
+}
+
+v8::Local<v8::Value> GetUploadData(v8::Isolate* isolate,
+                                   const atom::RequestDetails& details) {
+  const base::ListValue* list = nullptr;
+  if (!details.GetUploadData()->GetAsList(&list))
+    return v8::Undefined(isolate);
+  return mate::ConvertToV8(isolate, *list);
+}
+
+// Converts the field on the first read, and replaces the accessor with the
+// result, so later reads and writes act on a plain property.
+template<LazyField field>
+void GetLazyProperty(v8::Local<v8::Name> name,
+                     const v8::PropertyCallbackInfo<v8::Value>& info) {
+  v8::Isolate* isolate = info.GetIsolate();
+  LazyDetails* lazy = nullptr;
+  if (!mate::ConvertFromV8(isolate, info.Data(), &lazy))
+    return;
+
+  v8::Local<v8::Value> value = field(isolate, lazy->details());
+  ignore_result(info.Holder()->DefineOwnProperty(
+      isolate->GetCurrentContext(), name, value));
+  info.GetReturnValue().Set(value);
+}
+
+void SetLazyProperty(v8::Local<v8::Name> name,
+                     v8::Local<v8::Value> value,
+                     const v8::PropertyCallbackInfo<void>& info) {
+  ignore_result(info.This()->DefineOwnProperty(
+      info.GetIsolate()->GetCurrentContext(), name, value));
+}
+
+template<LazyField field>
+void SetLazyField(v8::Isolate* isolate,
+                  v8::Local<v8::Object> object,
+                  v8::Local<v8::Object> holder,
+                  const base::StringPiece& name) {
+  ignore_result(object->SetAccessor(
+      isolate->GetCurrentContext(), mate::StringToSymbol(isolate, name),
+      &GetLazyProperty<field>, &SetLazyProperty, holder));
+}
+
+}  // namespace
+
 namespace mate {
 
+// static
+v8::Local<v8::Value> Converter<atom::RequestDetails*>::ToV8(
+    v8::Isolate* isolate, atom::RequestDetails* details) {
+  v8::Local<v8::Value> value = ConvertToV8(isolate, details->fields());
+  if (!value->IsObject() ||
+      (!details->has_request_headers() && !details->has_response_headers() &&
+       !details->has_upload_data()))
+    return value;
+
+  v8::Local<v8::Object> object = value.As<v8::Object>();
+  v8::Local<v8::Object> holder = LazyDetails::Create(isolate, details);
+  if (details->has_request_headers())
+    SetLazyField<&GetRequestHeaders>(isolate, object, holder,
+                                     "requestHeaders");
+  if (details->has_response_headers())
+    SetLazyField<&GetResponseHeaders>(isolate, object, holder,
+                                      "responseHeaders");
+  if (details->has_upload_data())
+    SetLazyField<&GetUploadData>(isolate, object, holder, "uploadData");
+  return object;
+}
+
 template<>
 struct Converter<URLPattern> {
   static bool FromV8(v8::Isolate* isolate, v8::Local<v8::Value> val,
@@ -58,6 +168,31 @@ namespace atom {
 
 namespace api {
 
+namespace {
+
+// Reads the optional { urls } filter, throws an error and returns false when
+// the filter or any of its patterns is invalid.
+bool GetURLPatterns(mate::Arguments* args, URLPatterns* patterns) {
+  v8::Local<v8::Value> value = args->PeekNext();
+  if (value.IsEmpty() || value->IsFunction() || value->IsNull())
+    return true;
+
+  mate::Dictionary dict;
+  if (!args->GetNext(&dict)) {
+    args->ThrowError("Filter must be an Object");
+    return false;
+  }
+  v8::Local<v8::Value> urls;
+  if (dict.Get("urls", &urls) &&
+      !mate::ConvertFromV8(args->isolate(), urls, patterns)) {
+    args->ThrowError("Invalid url pattern");
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
 WebRequest::WebRequest(v8::Isolate* isolate,
                        AtomBrowserContext* browser_context)
     : browser_context_(browser_context) {
@@ -139,10 +274,63 @@ void WebRequest::Fetch(mate::Arguments* args) {
 
 template<AtomNetworkDelegate::SimpleEvent type>
 void WebRequest::SetSimpleListener(mate::Arguments* args) {
+  // The listener receives arrays of details when the filter has a batch.
+  v8::Local<v8::Value> value = args->PeekNext();
+  mate::Dictionary filter;
+  mate::Dictionary batch;
+  if (!value.IsEmpty() && value->IsObject() &&
+      mate::ConvertFromV8(isolate(), value, &filter) &&
+      filter.Get("batch", &batch)) {
+    SetBatchListener(type, batch, args);
+    return;
+  }
+
   SetListener<AtomNetworkDelegate::SimpleListener>(
       &AtomNetworkDelegate::SetSimpleListenerInIO, type, args);
 }
 
+void WebRequest::SetBatchListener(AtomNetworkDelegate::SimpleEvent type,
+                                  const mate::Dictionary& batch,
+                                  mate::Arguments* args) {
+  AtomNetworkDelegate::BatchOptions options;
+  int interval;
+  if (batch.Get("interval", &interval) && interval >= 0)
+    options.interval = base::TimeDelta::FromMilliseconds(interval);
+  int max_size;
+  if (batch.Get("maxSize", &max_size) && max_size > 0)
+    options.max_size = max_size;
+
+  // { urls, batch }.
+  URLPatterns patterns;
+  if (!GetURLPatterns(args, &patterns))
+    return;
+
+  // Function or null.
+  v8::Local<v8::Value> value;
+  AtomNetworkDelegate::BatchListener listener;
+  if (!args->GetNext(&listener) &&
+      !(args->GetNext(&value) && value->IsNull())) {
+    args->ThrowError("Must pass null or a Function");
+    return;
+  }
+
+  auto delegate = browser_context_->network_delegate();
+  if (listener.is_null()) {
+    BrowserThread::PostTask(
+        BrowserThread::IO, FROM_HERE,
+        base::Bind(&AtomNetworkDelegate::SetSimpleListenerInIO,
+                   base::Unretained(delegate), type, patterns,
+                   AtomNetworkDelegate::SimpleListener()));
+    return;
+  }
+
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&AtomNetworkDelegate::SetBatchListenerInIO,
+                 base::Unretained(delegate), type, patterns, options,
+                 listener));
+}
+
 template<AtomNetworkDelegate::ResponseEvent type>
 void WebRequest::SetResponseListener(mate::Arguments* args) {
   SetListener<AtomNetworkDelegate::ResponseListener>(
@@ -153,8 +341,8 @@ template<typename Listener, typename Method, typename Event>
 void WebRequest::SetListener(Method method, Event type, mate::Arguments* args) {
   // { urls }.
   URLPatterns patterns;
-  mate::Dictionary dict;
-  args->GetNext(&dict) && dict.Get("urls", &patterns);
+  if (!GetURLPatterns(args, &patterns))
+    return;
 
   // Function or null.
   v8::Local<v8::Value> value;
@@ -171,6 +359,51 @@ void WebRequest::SetListener(Method method, Event type, mate::Arguments* args) {
                                      patterns, listener));
 }
 
+void WebRequest::SetRules(mate::Arguments* args) {
+  // Array of rules or null.
+  std::unique_ptr<RequestRules> rules;
+  base::ListValue list;
+  v8::Local<v8::Value> value;
+  if (args->GetNext(&list)) {
+    std::string error;
+    rules = RequestRules::Create(list, &error);
+    if (!rules) {
+      args->ThrowError(error);
+      return;
+    }
+  } else if (!(args->GetNext(&value) && value->IsNull())) {
+    args->ThrowError("Must pass null or an Array");
+    return;
+  }
+
+  auto delegate = browser_context_->network_delegate();
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+                          base::Bind(&AtomNetworkDelegate::SetRulesInIO,
+                                     base::Unretained(delegate),
+                                     base::Passed(&rules)));
+}
+
+v8::Local<v8::Value> WebRequest::GetEventStats(v8::Isolate* isolate) {
+  auto delegate = browser_context_->network_delegate();
+  mate::Dictionary stats = mate::Dictionary::CreateEmpty(isolate);
+  for (const auto& iter : delegate->stats()->GetCounters()) {
+    const RequestEventCounters& counters = iter.second;
+    double average_latency = 0;
+    if (counters.dispatched)
+      average_latency =
+          counters.total_latency.InMillisecondsF() / counters.dispatched;
+    mate::Dictionary event = mate::Dictionary::CreateEmpty(isolate);
+    event.Set("dispatched", static_cast<double>(counters.dispatched));
+    event.Set("lazyFields", static_cast<double>(counters.lazy_fields));
+    event.Set("materializedFields",
+              static_cast<double>(counters.materialized_fields));
+    event.Set("averageLatency", average_latency);
+    event.Set("maxLatency", counters.max_latency.InMillisecondsF());
+    stats.Set(iter.first, event);
+  }
+  return stats.GetHandle();
+}
+
 // static
 mate::Handle<WebRequest> WebRequest::Create(
     v8::Isolate* isolate,
@@ -206,6 +439,10 @@ void WebRequest::BuildPrototype(v8::Isolate* isolate,
       .SetMethod("onErrorOccurred",
                  &WebRequest::SetSimpleListener<
                     AtomNetworkDelegate::kOnErrorOccurred>)
+      .SetMethod("setRules",
+                 &WebRequest::SetRules)
+      .SetMethod("getEventStats",
+                 &WebRequest::GetEventStats)
       .SetMethod("fetch",
                  &WebRequest::Fetch);
 }
@@ -67,6 +67,14 @@ struct Converter<net::HttpRequestHeaders> {
   }
 };
 
+// Creates the details object passed to webRequest listeners, the headers and
+// upload data are only converted when they are read.
+template<>
+struct Converter<atom::RequestDetails*> {
+  static v8::Local<v8::Value> ToV8(v8::Isolate* isolate,
+                                   atom::RequestDetails* details);
+};
+
 class Dictionary;
 
 }  // namespace mate
@@ -103,6 +111,13 @@ class WebRequest : public mate::TrackableObject<WebRequest>,
   void SetResponseListener(mate::Arguments* args);
   template<typename Listener, typename Method, typename Event>
   void SetListener(Method method, Event type, mate::Arguments* args);
+  void SetBatchListener(AtomNetworkDelegate::SimpleEvent type,
+                        const mate::Dictionary& batch,
+                        mate::Arguments* args);
+
+  void SetRules(mate::Arguments* args);
+
+  v8::Local<v8::Value> GetEventStats(v8::Isolate* isolate);
 
  private:
   scoped_refptr<AtomBrowserContext> browser_context_;
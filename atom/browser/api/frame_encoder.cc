@@ -0,0 +1,131 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/api/frame_encoder.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/task_runner_util.h"
+#include "ui/gfx/codec/jpeg_codec.h"
+#include "ui/gfx/codec/png_codec.h"
+
+namespace atom {
+
+namespace api {
+
+namespace {
+
+scoped_refptr<base::RefCountedBytes> EncodeBitmap(
+    const SkBitmap& bitmap, FrameEncoder::Format format, int quality) {
+  std::vector<unsigned char> data;
+  SkAutoLockPixels lock(bitmap);
+  const unsigned char* pixels =
+      static_cast<const unsigned char*>(bitmap.getPixels());
+  if (!pixels)
+    return nullptr;
+
+  switch (format) {
+    case FrameEncoder::Format::PNG:
+      if (!gfx::PNGCodec::EncodeBGRASkBitmap(bitmap, false, &data))
+        return nullptr;
+      break;
+    case FrameEncoder::Format::JPEG:
+      if (!gfx::JPEGCodec::Encode(pixels, gfx::JPEGCodec::FORMAT_SkBitmap,
+                                  bitmap.width(), bitmap.height(),
+                                  bitmap.rowBytes(), quality, &data))
+        return nullptr;
+      break;
+  }
+  return base::RefCountedBytes::TakeVector(&data);
+}
+
+}  // namespace
+
+FrameEncoder::Request::Request() : format(Format::PNG), quality(0) {
+}
+
+FrameEncoder::Request::Request(const Request& other) = default;
+
+FrameEncoder::Request::~Request() {
+}
+
+FrameEncoder::FrameEncoder(scoped_refptr<base::TaskRunner> task_runner,
+                           size_t max_running,
+                           size_t max_queued)
+    : task_runner_(task_runner),
+      max_running_(max_running),
+      max_queued_(max_queued),
+      running_(0),
+      weak_factory_(this) {
+}
+
+FrameEncoder::~FrameEncoder() {
+}
+
+// static
+bool FrameEncoder::ParseFormat(const std::string& name, Format* format) {
+  if (name == "png")
+    *format = Format::PNG;
+  else if (name == "jpeg")
+    *format = Format::JPEG;
+  else
+    return false;
+  return true;
+}
+
+// static
+const char* FrameEncoder::FormatToString(Format format) {
+  switch (format) {
+    case Format::PNG:
+      return "png";
+    case Format::JPEG:
+      return "jpeg";
+  }
+  return "";
+}
+
+bool FrameEncoder::Encode(const SkBitmap& bitmap,
+                          Format format,
+                          int quality,
+                          const EncodeCallback& callback) {
+  Request request;
+  request.bitmap = bitmap;
+  request.format = format;
+  request.quality = quality;
+  request.callback = callback;
+
+  if (running_ < max_running_) {
+    Start(request);
+    return true;
+  }
+  if (queue_.size() >= max_queued_)
+    return false;
+  queue_.push_back(request);
+  return true;
+}
+
+void FrameEncoder::Start(const Request& request) {
+  ++running_;
+  base::PostTaskAndReplyWithResult(
+      task_runner_.get(), FROM_HERE,
+      base::Bind(&EncodeBitmap, request.bitmap, request.format,
+                 request.quality),
+      base::Bind(&FrameEncoder::OnEncoded, weak_factory_.GetWeakPtr(),
+                 request.callback));
+}
+
+void FrameEncoder::OnEncoded(const EncodeCallback& callback,
+                             scoped_refptr<base::RefCountedBytes> data) {
+  --running_;
+  if (!queue_.empty()) {
+    Start(queue_.front());
+    queue_.pop_front();
+  }
+  callback.Run(data);
+}
+
+}  // namespace api
+
+}  // namespace atom
@@ -0,0 +1,87 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_API_FRAME_ENCODER_H_
+#define ATOM_BROWSER_API_FRAME_ENCODER_H_
+
+#include <deque>
+#include <string>
+
+#include "base/callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/memory/weak_ptr.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace base {
+class TaskRunner;
+}
+
+namespace atom {
+
+namespace api {
+
+// Encodes captured bitmaps on a worker thread, so the UI thread is not blocked
+// by the encoding. It can only be used on the UI thread.
+class FrameEncoder {
+ public:
+  enum class Format {
+    PNG,
+    JPEG,
+  };
+
+  // Called with the encoded data, or nullptr when the encoding failed.
+  using EncodeCallback =
+      base::Callback<void(scoped_refptr<base::RefCountedBytes>)>;
+
+  // Runs at most |max_running| encodings on |task_runner| at once, and keeps
+  // at most |max_queued| more waiting for them.
+  FrameEncoder(scoped_refptr<base::TaskRunner> task_runner,
+               size_t max_running,
+               size_t max_queued);
+  ~FrameEncoder();
+
+  static bool ParseFormat(const std::string& name, Format* format);
+  static const char* FormatToString(Format format);
+
+  // The |quality| from 0 to 100 is ignored by PNG. Returns false without
+  // calling |callback| when the queue is full.
+  bool Encode(const SkBitmap& bitmap,
+              Format format,
+              int quality,
+              const EncodeCallback& callback);
+
+ private:
+  struct Request {
+    Request();
+    Request(const Request& other);
+    ~Request();
+
+    SkBitmap bitmap;
+    Format format;
+    int quality;
+    EncodeCallback callback;
+  };
+
+  void Start(const Request& request);
+  void OnEncoded(const EncodeCallback& callback,
+                 scoped_refptr<base::RefCountedBytes> data);
+
+  scoped_refptr<base::TaskRunner> task_runner_;
+  size_t max_running_;
+  size_t max_queued_;
+
+  size_t running_;
+  std::deque<Request> queue_;
+
+  base::WeakPtrFactory<FrameEncoder> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(FrameEncoder);
+};
+
+}  // namespace api
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_API_FRAME_ENCODER_H_
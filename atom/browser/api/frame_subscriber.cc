@@ -4,24 +4,106 @@
 
 #include "atom/browser/api/frame_subscriber.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "base/bind.h"
+#include "base/threading/sequenced_worker_pool.h"
 #include "atom/common/native_mate_converters/gfx_converter.h"
 #include "atom/common/node_includes.h"
+#include "content/public/browser/browser_thread.h"
 #include "content/public/browser/render_widget_host.h"
+#include "native_mate/dictionary.h"
+#include "third_party/libyuv/include/libyuv/convert.h"
 
 namespace atom {
 
 namespace api {
 
+namespace {
+
+void ReleaseFrameMemory(char* data, void* hint) {
+  static_cast<base::RefCountedBytes*>(hint)->Release();
+}
+
+// Scales |size| down to fit in |max_size|, keeping the aspect ratio.
+gfx::Size GetOutputSize(const gfx::Size& size, const gfx::Size& max_size) {
+  if (max_size.IsEmpty() ||
+      (size.width() <= max_size.width() && size.height() <= max_size.height()))
+    return size;
+  float scale = std::min(
+      static_cast<float>(max_size.width()) / size.width(),
+      static_cast<float>(max_size.height()) / size.height());
+  gfx::Size output = gfx::ScaleToFlooredSize(size, scale);
+  output.SetToMax(gfx::Size(1, 1));
+  return output;
+}
+
+size_t GetFrameSize(FrameSubscriber::PixelFormat format, int width,
+                    int height) {
+  if (format == FrameSubscriber::PixelFormat::I420) {
+    size_t chroma_size = ((width + 1) / 2) * ((height + 1) / 2);
+    return width * height + 2 * chroma_size;
+  }
+  return width * height * 4;
+}
+
+bool WriteFrame(FrameSubscriber::PixelFormat format,
+                const SkBitmap& bitmap,
+                uint8_t* data,
+                size_t size) {
+  if (format == FrameSubscriber::PixelFormat::BGRA)
+    return bitmap.copyPixelsTo(data, size);
+
+  SkAutoLockPixels lock(bitmap);
+  int width = bitmap.width();
+  int height = bitmap.height();
+  int chroma_width = (width + 1) / 2;
+  uint8_t* y = data;
+  uint8_t* u = y + width * height;
+  uint8_t* v = u + chroma_width * ((height + 1) / 2);
+  // The BGRA pixels are what libyuv calls ARGB, which is little-endian.
+  return libyuv::ARGBToI420(
+      static_cast<const uint8_t*>(bitmap.getPixels()), bitmap.rowBytes(),
+      y, width, u, chroma_width, v, chroma_width, width, height) == 0;
+}
+
+}  // namespace
+
+FrameSubscriber::Options::Options()
+    : only_dirty(false),
+      format(PixelFormat::BGRA),
+      max_pending_frames(2),
+      reuse_buffer(false),
+      encode(false),
+      encode_format(FrameEncoder::Format::PNG),
+      quality(90) {
+}
+
 FrameSubscriber::FrameSubscriber(v8::Isolate* isolate,
                                  content::RenderWidgetHostView* view,
                                  const FrameCaptureCallback& callback,
-                                 bool only_dirty)
+                                 const Options& options)
     : isolate_(isolate),
       view_(view),
       callback_(callback),
-      only_dirty_(only_dirty),
+      options_(options),
+      pending_frames_(0),
+      dropped_frames_(0),
+      buffer_size_(0),
       weak_factory_(this) {
+  if (options_.encode) {
+    // The pending frames are bounded by |max_pending_frames|, so the queue
+    // never rejects one.
+    encoder_.reset(new FrameEncoder(
+        content::BrowserThread::GetBlockingPool()
+            ->GetTaskRunnerWithShutdownBehavior(
+                base::SequencedWorkerPool::SKIP_ON_SHUTDOWN),
+        1, options_.max_pending_frames));
+  }
+}
+
+FrameSubscriber::~FrameSubscriber() {
 }
 
 bool FrameSubscriber::ShouldCaptureFrame(
@@ -36,44 +118,161 @@ bool FrameSubscriber::ShouldCaptureFrame(
   if (dirty_rect.IsEmpty())
     return false;
 
+  // Do not queue more readbacks when the frames are produced faster than they
+  // can be read back and delivered.
+  if (pending_frames_ >= options_.max_pending_frames) {
+    ++dropped_frames_;
+    return false;
+  }
+
   gfx::Rect rect = gfx::Rect(view_->GetVisibleViewportSize());
-  if (only_dirty_)
+  if (options_.only_dirty)
     rect = dirty_rect;
 
+  ++pending_frames_;
   host->CopyFromBackingStore(
       rect,
-      rect.size(),
+      GetOutputSize(rect.size(), options_.max_size),
       base::Bind(&FrameSubscriber::OnFrameDelivered,
-                 weak_factory_.GetWeakPtr(), callback_, rect),
+                 weak_factory_.GetWeakPtr(), rect, present_time),
       kBGRA_8888_SkColorType);
 
   return false;
 }
 
-void FrameSubscriber::OnFrameDelivered(const FrameCaptureCallback& callback,
-                                       const gfx::Rect& damage_rect,
+void FrameSubscriber::OnFrameDelivered(const gfx::Rect& damage_rect,
+                                       base::TimeTicks present_time,
                                        const SkBitmap& bitmap,
                                        content::ReadbackResponse response) {
-  if (response != content::ReadbackResponse::READBACK_SUCCESS)
+  if (response != content::ReadbackResponse::READBACK_SUCCESS) {
+    --pending_frames_;
+    return;
+  }
+
+  // A newer frame has already been delivered.
+  if (present_time < last_present_time_) {
+    --pending_frames_;
+    ++dropped_frames_;
+    return;
+  }
+
+  // The frame stays pending until it is encoded.
+  if (encoder_) {
+    if (!encoder_->Encode(
+            bitmap, options_.encode_format, options_.quality,
+            base::Bind(&FrameSubscriber::OnFrameEncoded,
+                       weak_factory_.GetWeakPtr(), damage_rect, present_time,
+                       gfx::Size(bitmap.width(), bitmap.height())))) {
+      --pending_frames_;
+      ++dropped_frames_;
+    }
     return;
+  }
+
+  --pending_frames_;
+
+  v8::Locker locker(isolate_);
+  v8::HandleScope handle_scope(isolate_);
+
+  size_t size = GetFrameSize(options_.format, bitmap.width(), bitmap.height());
+  v8::Local<v8::Object> buffer;
+  if (!GetBuffer(size).ToLocal(&buffer) ||
+      !WriteFrame(options_.format, bitmap,
+                  reinterpret_cast<uint8_t*>(node::Buffer::Data(buffer)),
+                  size))
+    return;
+
+  DeliverFrame(buffer, damage_rect, present_time,
+               gfx::Size(bitmap.width(), bitmap.height()));
+}
+
+void FrameSubscriber::OnFrameEncoded(
+    const gfx::Rect& damage_rect,
+    base::TimeTicks present_time,
+    const gfx::Size& size,
+    scoped_refptr<base::RefCountedBytes> data) {
+  --pending_frames_;
+  if (!data)
+    return;
+
+  if (present_time < last_present_time_) {
+    ++dropped_frames_;
+    return;
+  }
 
   v8::Locker locker(isolate_);
   v8::HandleScope handle_scope(isolate_);
 
-  size_t rgb_arr_size = bitmap.width() * bitmap.height() *
-    bitmap.bytesPerPixel();
-  v8::MaybeLocal<v8::Object> buffer = node::Buffer::New(isolate_, rgb_arr_size);
-  if (buffer.IsEmpty())
+  // The size of the encoded frames changes, so they are never written to the
+  // reused buffer, the Buffer takes the encoded data instead of a copy.
+  data->AddRef();
+  v8::Local<v8::Object> buffer;
+  if (!node::Buffer::New(isolate_,
+                         reinterpret_cast<char*>(data->front()),
+                         data->size(), &ReleaseFrameMemory, data.get())
+           .ToLocal(&buffer)) {
+    data->Release();
     return;
+  }
 
-  bitmap.copyPixelsTo(
-    reinterpret_cast<uint8_t*>(node::Buffer::Data(buffer.ToLocalChecked())),
-    rgb_arr_size);
+  DeliverFrame(buffer, damage_rect, present_time, size);
+}
 
+void FrameSubscriber::DeliverFrame(v8::Local<v8::Object> buffer,
+                                   const gfx::Rect& damage_rect,
+                                   base::TimeTicks present_time,
+                                   const gfx::Size& size) {
   v8::Local<v8::Value> damage =
       mate::Converter<gfx::Rect>::ToV8(isolate_, damage_rect);
 
-  callback_.Run(buffer.ToLocalChecked(), damage);
+  const char* format;
+  if (options_.encode)
+    format = FrameEncoder::FormatToString(options_.encode_format);
+  else if (options_.format == PixelFormat::I420)
+    format = "i420";
+  else
+    format = "bgra";
+
+  mate::Dictionary info = mate::Dictionary::CreateEmpty(isolate_);
+  info.Set("timestamp", (present_time - base::TimeTicks()).InMillisecondsF());
+  info.Set("width", size.width());
+  info.Set("height", size.height());
+  info.Set("format", format);
+  info.Set("droppedFrames", dropped_frames_);
+
+  last_present_time_ = present_time;
+  dropped_frames_ = 0;
+
+  callback_.Run(buffer, damage, info.GetHandle());
+}
+
+v8::MaybeLocal<v8::Object> FrameSubscriber::GetBuffer(size_t size) {
+  if (!options_.reuse_buffer)
+    return node::Buffer::New(isolate_, size);
+
+  if (!buffer_.IsEmpty() && buffer_size_ == size)
+    return buffer_.Get(isolate_);
+
+  // Only the dirty rectangles change the size of the frames, the memory is
+  // reallocated when they get larger than ever.
+  if (!memory_ || memory_->size() < size) {
+    std::vector<unsigned char> data(size);
+    memory_ = base::RefCountedBytes::TakeVector(&data);
+  }
+
+  // The Buffer can outlive us, so it keeps its own reference to the memory.
+  memory_->AddRef();
+  v8::Local<v8::Object> buffer;
+  if (!node::Buffer::New(isolate_,
+                         reinterpret_cast<char*>(memory_->data().data()),
+                         size, &ReleaseFrameMemory, memory_.get())
+           .ToLocal(&buffer)) {
+    memory_->Release();
+    return v8::MaybeLocal<v8::Object>();
+  }
+  buffer_.Reset(isolate_, buffer);
+  buffer_size_ = size;
+  return buffer;
 }
 
 }  // namespace api
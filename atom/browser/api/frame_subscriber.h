@@ -5,8 +5,13 @@
 #ifndef ATOM_BROWSER_API_FRAME_SUBSCRIBER_H_
 #define ATOM_BROWSER_API_FRAME_SUBSCRIBER_H_
 
+#include <memory>
+
+#include "atom/browser/api/frame_encoder.h"
 #include "base/callback.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 #include "content/public/browser/render_widget_host_view.h"
 #include "content/public/browser/render_widget_host_view_frame_subscriber.h"
 #include "content/public/browser/readback_types.h"
@@ -21,12 +26,40 @@ namespace api {
 class FrameSubscriber : public content::RenderWidgetHostViewFrameSubscriber {
  public:
   using FrameCaptureCallback =
-      base::Callback<void(v8::Local<v8::Value>, v8::Local<v8::Value>)>;
+      base::Callback<void(v8::Local<v8::Value>,
+                          v8::Local<v8::Value>,
+                          v8::Local<v8::Value>)>;
+
+  enum class PixelFormat {
+    BGRA,
+    // Planar Y, U and V, with the U and V planes subsampled by 2.
+    I420,
+  };
+
+  struct Options {
+    Options();
+
+    bool only_dirty;
+    PixelFormat format;
+    // Frames larger than |max_size| are scaled down to fit in it, unless it is
+    // empty.
+    gfx::Size max_size;
+    // New frames are dropped while this many frames are being read back.
+    int max_pending_frames;
+    // Delivers the frames in the same Buffer, which is only valid until the
+    // callback returns.
+    bool reuse_buffer;
+    // Delivers the frames encoded in |encode_format| instead of raw pixels.
+    bool encode;
+    FrameEncoder::Format encode_format;
+    int quality;
+  };
 
   FrameSubscriber(v8::Isolate* isolate,
                   content::RenderWidgetHostView* view,
                   const FrameCaptureCallback& callback,
-                  bool only_dirty);
+                  const Options& options);
+  ~FrameSubscriber() override;
 
   bool ShouldCaptureFrame(const gfx::Rect& damage_rect,
                           base::TimeTicks present_time,
@@ -34,15 +67,42 @@ class FrameSubscriber : public content::RenderWidgetHostViewFrameSubscriber {
                           DeliverFrameCallback* callback) override;
 
  private:
-  void OnFrameDelivered(const FrameCaptureCallback& callback,
-                        const gfx::Rect& damage_rect,
+  void OnFrameDelivered(const gfx::Rect& damage_rect,
+                        base::TimeTicks present_time,
                         const SkBitmap& bitmap,
                         content::ReadbackResponse response);
+  void OnFrameEncoded(const gfx::Rect& damage_rect,
+                      base::TimeTicks present_time,
+                      const gfx::Size& size,
+                      scoped_refptr<base::RefCountedBytes> data);
+
+  // Runs the callback with a frame written in |buffer|.
+  void DeliverFrame(v8::Local<v8::Object> buffer,
+                    const gfx::Rect& damage_rect,
+                    base::TimeTicks present_time,
+                    const gfx::Size& size);
+
+  // Returns a Buffer of |size| bytes to write a frame in.
+  v8::MaybeLocal<v8::Object> GetBuffer(size_t size);
 
   v8::Isolate* isolate_;
   content::RenderWidgetHostView* view_;
   FrameCaptureCallback callback_;
-  bool only_dirty_;
+  Options options_;
+
+  int pending_frames_;
+  // The frames dropped since the last delivered one.
+  int dropped_frames_;
+  base::TimeTicks last_present_time_;
+
+  // Encodes the frames one at a time, when |options_.encode| is set.
+  std::unique_ptr<FrameEncoder> encoder_;
+
+  // The memory of the reused Buffer, which is also referenced by the Buffers
+  // created on it.
+  scoped_refptr<base::RefCountedBytes> memory_;
+  v8::Global<v8::Object> buffer_;
+  size_t buffer_size_;
 
   base::WeakPtrFactory<FrameSubscriber> weak_factory_;
 
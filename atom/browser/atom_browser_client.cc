@@ -16,13 +16,13 @@
 #include "atom/browser/atom_resource_dispatcher_host_delegate.h"
 #include "atom/browser/atom_speech_recognition_manager_delegate.h"
 #include "atom/browser/native_window.h"
+#include "atom/browser/spare_renderer_pool.h"
 #include "atom/browser/web_contents_permission_helper.h"
 #include "atom/browser/web_contents_preferences.h"
 #include "atom/browser/window_list.h"
 #include "atom/common/options_switches.h"
 #include "base/command_line.h"
 #include "base/files/file_util.h"
-#include "base/stl_util.h"
 #include "base/strings/string_util.h"
 #include "base/strings/string_number_conversions.h"
 #include "chrome/browser/printing/printing_message_filter.h"
@@ -80,8 +80,9 @@ AtomBrowserClient::~AtomBrowserClient() {
 content::WebContents* AtomBrowserClient::GetWebContentsFromProcessID(
     int process_id) {
   // If the process is a pending process, we should use the old one.
-  if (ContainsKey(pending_processes_, process_id))
-    process_id = pending_processes_[process_id];
+  auto it = pending_processes_.find(process_id);
+  if (it != pending_processes_.end())
+    process_id = it->second;
 
   // Certain render process will be created with no associated render view,
   // for example: ServiceWorker.
@@ -175,8 +176,18 @@ void AtomBrowserClient::OverrideSiteInstanceForNavigation(
   if (url.SchemeIs(url::kJavaScriptScheme))
     return;
 
-  scoped_refptr<content::SiteInstance> site_instance =
-      content::SiteInstance::CreateForURL(browser_context, url);
+  // Take a renderer that was launched ahead of time when there is one.
+  scoped_refptr<content::SiteInstance> site_instance;
+  auto pool = static_cast<AtomBrowserContext*>(browser_context)->
+      spare_renderer_pool();
+  if (pool->enabled()) {
+    content::WebContents* web_contents =
+        GetWebContentsFromProcessID(current_instance->GetProcess()->GetID());
+    if (web_contents)
+      site_instance = pool->Claim(web_contents);
+  }
+  if (!site_instance)
+    site_instance = content::SiteInstance::CreateForURL(browser_context, url);
   *new_instance = site_instance.get();
 
   // Make sure the |site_instance| is not freed when this function returns.
@@ -223,6 +234,11 @@ void AtomBrowserClient::AppendExtraCommandLineSwitches(
   }
 #endif
 
+  // Spares are launched before any WebContents uses them.
+  if (SpareRendererPool::AppendExtraCommandLineSwitches(process_id,
+                                                        command_line))
+    return;
+
   content::WebContents* web_contents = GetWebContentsFromProcessID(process_id);
   if (!web_contents)
     return;
@@ -339,11 +355,13 @@ void AtomBrowserClient::WebNotificationAllowed(
 void AtomBrowserClient::RenderProcessHostDestroyed(
     content::RenderProcessHost* host) {
   int process_id = host->GetID();
-  for (const auto& entry : pending_processes_) {
-    if (entry.first == process_id || entry.second == process_id) {
-      pending_processes_.erase(entry.first);
-      break;
-    }
+  pending_processes_.erase(process_id);
+  auto it = pending_processes_.begin();
+  while (it != pending_processes_.end()) {
+    if (it->second == process_id)
+      it = pending_processes_.erase(it);
+    else
+      ++it;
   }
 }
 
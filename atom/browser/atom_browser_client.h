@@ -5,8 +5,8 @@
 #ifndef ATOM_BROWSER_ATOM_BROWSER_CLIENT_H_
 #define ATOM_BROWSER_ATOM_BROWSER_CLIENT_H_
 
-#include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "brightray/browser/browser_client.h"
@@ -107,7 +107,7 @@ class AtomBrowserClient : public brightray::BrowserClient,
 
  private:
   // pending_render_process => current_render_process.
-  std::map<int, int> pending_processes_;
+  std::unordered_map<int, int> pending_processes_;
 
   std::unique_ptr<AtomResourceDispatcherHostDelegate>
       resource_dispatcher_host_delegate_;
@@ -14,6 +14,7 @@
 #include "atom/browser/net/asar/asar_protocol_handler.h"
 #include "atom/browser/net/http_protocol_handler.h"
 #include "atom/browser/atom_permission_manager.h"
+#include "atom/browser/spare_renderer_pool.h"
 #include "atom/browser/web_view_manager.h"
 #include "atom/common/atom_version.h"
 #include "atom/common/chrome_version.h"
@@ -67,6 +68,7 @@ AtomBrowserContext::AtomBrowserContext(
     const std::string& partition, bool in_memory,
     const base::DictionaryValue& options)
     : brightray::BrowserContext(partition, in_memory),
+      spare_renderer_pool_(new SpareRendererPool(this)),
       network_delegate_(new AtomNetworkDelegate) {
   // Construct user agent string.
   Browser* browser = Browser::Get();
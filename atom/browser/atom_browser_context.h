@@ -14,6 +14,7 @@ namespace atom {
 class AtomDownloadManagerDelegate;
 class AtomNetworkDelegate;
 class AtomPermissionManager;
+class SpareRendererPool;
 class WebViewManager;
 
 class AtomBrowserContext : public brightray::BrowserContext {
@@ -48,6 +49,9 @@ class AtomBrowserContext : public brightray::BrowserContext {
   virtual AtomNetworkDelegate* network_delegate() const {
       return network_delegate_; }
 
+  SpareRendererPool* spare_renderer_pool() const {
+      return spare_renderer_pool_.get(); }
+
  protected:
   AtomBrowserContext(const std::string& partition, bool in_memory,
                      const base::DictionaryValue& options);
@@ -57,6 +61,7 @@ class AtomBrowserContext : public brightray::BrowserContext {
   std::unique_ptr<AtomDownloadManagerDelegate> download_manager_delegate_;
   std::unique_ptr<WebViewManager> guest_manager_;
   std::unique_ptr<AtomPermissionManager> permission_manager_;
+  std::unique_ptr<SpareRendererPool> spare_renderer_pool_;
   std::string user_agent_;
   bool use_cache_;
 
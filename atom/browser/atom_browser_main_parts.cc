@@ -13,11 +13,14 @@
 #include "atom/browser/javascript_environment.h"
 #include "atom/browser/node_debugger.h"
 #include "atom/common/api/atom_bindings.h"
+#include "atom/common/asar/prefetch_profile.h"
 #include "atom/common/node_bindings.h"
 #include "atom/common/node_includes.h"
 #include "base/command_line.h"
+#include "base/threading/sequenced_worker_pool.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "chrome/browser/browser_process.h"
+#include "content/public/browser/browser_thread.h"
 #include "v8/include/v8-debug.h"
 
 #if defined(USE_X11)
@@ -27,6 +30,13 @@
 
 namespace atom {
 
+namespace {
+
+// How long the archive reads of startup are recorded for the prefetch profile.
+const int kPrefetchSeconds = 10;
+
+}  // namespace
+
 template<typename T>
 void Erase(T* container, typename T::iterator iter) {
   container->erase(iter);
@@ -103,6 +113,16 @@ void AtomBrowserMainParts::PostEarlyInitialization() {
 
   node_bindings_->Initialize();
 
+  // Warm up the archives read during startup before init.js runs. Saving the
+  // profiles is skipped when the blocking pool shuts down before it starts.
+  base::SequencedWorkerPool* pool = content::BrowserThread::GetBlockingPool();
+  asar::StartPrefetching(
+      NodeBindings::GetResourcesPath(true),
+      base::TimeDelta::FromSeconds(kPrefetchSeconds),
+      pool->GetSequencedTaskRunnerWithShutdownBehavior(
+          pool->GetSequenceToken(),
+          base::SequencedWorkerPool::SKIP_ON_SHUTDOWN));
+
   // Support the "--debug" switch.
   node_debugger_.reset(new NodeDebugger(js_env_->isolate()));
 
@@ -100,7 +100,7 @@ void URLRequestAsarJob::InitializeFileJob(
 
 void URLRequestAsarJob::Start() {
   if (type_ == TYPE_ASAR) {
-    remaining_bytes_ = static_cast<int64_t>(file_info_.size);
+    remaining_bytes_ = static_cast<int64_t>(file_info_.stored_size());
 
     int flags = base::File::FLAG_OPEN |
                 base::File::FLAG_READ |
@@ -181,6 +181,9 @@ bool URLRequestAsarJob::IsRedirectResponse(GURL* location,
 }
 
 std::unique_ptr<net::Filter> URLRequestAsarJob::SetupFilter() const {
+  // Compressed entries are streamed as stored and inflated by the filter.
+  if (type_ == TYPE_ASAR && file_info_.compressed)
+    return net::Filter::GZipFactory();
   // Bug 9936 - .svgz files needs to be decompressed.
   return base::LowerCaseEqualsASCII(file_path_.Extension(), ".svgz")
       ? net::Filter::GZipFactory() : nullptr;
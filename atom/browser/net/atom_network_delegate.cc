@@ -44,106 +44,109 @@ namespace {
 using ResponseHeadersContainer =
     std::pair<scoped_refptr<net::HttpResponseHeaders>*, const std::string&>;
 
+const char* kSimpleEventNames[] = {
+  "onSendHeaders",
+  "onBeforeRedirect",
+  "onResponseStarted",
+  "onCompleted",
+  "onErrorOccurred",
+};
+
+const char* kResponseEventNames[] = {
+  "onBeforeRequest",
+  "onBeforeSendHeaders",
+  "onHeadersReceived",
+};
+
 void RunSimpleListener(const AtomNetworkDelegate::SimpleListener& listener,
-                       std::unique_ptr<base::DictionaryValue> details) {
-  return listener.Run(*(details.get()));
+                       scoped_refptr<RequestDetails> details) {
+  details->RecordDispatch();
+  return listener.Run(details.get());
+}
+
+void RunBatchListener(
+    const AtomNetworkDelegate::BatchListener& listener,
+    const std::vector<scoped_refptr<RequestDetails>>& batch) {
+  std::vector<RequestDetails*> details;
+  details.reserve(batch.size());
+  for (const auto& item : batch) {
+    item->RecordDispatch();
+    details.push_back(item.get());
+  }
+  return listener.Run(details);
 }
 
 void RunResponseListener(
     const AtomNetworkDelegate::ResponseListener& listener,
-    std::unique_ptr<base::DictionaryValue> details,
+    scoped_refptr<RequestDetails> details,
     const AtomNetworkDelegate::ResponseCallback& callback) {
-  return listener.Run(*(details.get()), callback);
+  details->RecordDispatch();
+  return listener.Run(details.get(), callback);
 }
 
 // Test whether the URL of |request| matches |patterns|.
 bool MatchesFilterCondition(net::URLRequest* request,
-                            const URLPatterns& patterns) {
-  if (patterns.empty())
-    return true;
-
-  for (const auto& pattern : patterns) {
-    if (pattern.MatchesURL(request->url()))
-      return true;
-  }
-  return false;
+                            const URLPatternMatcher& patterns) {
+  return patterns.empty() || patterns.MatchesURL(request->url());
 }
 
 // Overloaded by multiple types to fill the |details| object.
-void ToDictionary(base::DictionaryValue* details, net::URLRequest* request) {
-  FillRequestDetails(details, request);
-  details->SetInteger("id", request->identifier());
-  details->SetDouble("timestamp", base::Time::Now().ToDoubleT() * 1000);
-  details->SetString("firstPartyUrl",
+void FillDetails(RequestDetails* details, net::URLRequest* request) {
+  base::DictionaryValue* fields = details->mutable_fields();
+  FillRequestDetails(fields, request);
+  // The upload data is only converted when it is read.
+  std::unique_ptr<base::Value> upload_data;
+  if (fields->RemoveWithoutPathExpansion("uploadData", &upload_data))
+    details->SetUploadData(std::move(upload_data));
+  fields->SetInteger("id", request->identifier());
+  fields->SetDouble("timestamp", base::Time::Now().ToDoubleT() * 1000);
+  fields->SetString("firstPartyUrl",
     request->first_party_for_cookies().spec());
   auto info = content::ResourceRequestInfo::ForRequest(request);
-  details->SetString("resourceType",
-                     info ? ResourceTypeToString(info->GetResourceType())
-                          : "other");
+  fields->SetString("resourceType",
+                    info ? ResourceTypeToString(info->GetResourceType())
+                         : "other");
 }
 
-void ToDictionary(base::DictionaryValue* details,
-                  const net::HttpRequestHeaders& headers) {
-  std::unique_ptr<base::DictionaryValue> dict(new base::DictionaryValue);
-  net::HttpRequestHeaders::Iterator it(headers);
-  while (it.GetNext())
-    dict->SetString(it.name(), it.value());
-  details->Set("requestHeaders", std::move(dict));
+void FillDetails(RequestDetails* details,
+                 const net::HttpRequestHeaders& headers) {
+  details->SetRequestHeaders(headers);
 }
 
-void ToDictionary(base::DictionaryValue* details,
-                  const net::HttpResponseHeaders* headers) {
-  if (!headers)
-    return;
-
-  std::unique_ptr<base::DictionaryValue> dict(new base::DictionaryValue);
-  size_t iter = 0;
-  std::string key;
-  std::string value;
-  while (headers->EnumerateHeaderLines(&iter, &key, &value)) {
-    if (dict->HasKey(key)) {
-      base::ListValue* values = nullptr;
-      if (dict->GetList(key, &values))
-        values->AppendString(value);
-    } else {
-      std::unique_ptr<base::ListValue> values(new base::ListValue);
-      values->AppendString(value);
-      dict->Set(key, std::move(values));
-    }
-  }
-  details->Set("responseHeaders", std::move(dict));
-  details->SetString("statusLine", headers->GetStatusLine());
-  details->SetInteger("statusCode", headers->response_code());
+void FillDetails(RequestDetails* details,
+                 const net::HttpResponseHeaders* headers) {
+  details->SetResponseHeaders(headers);
 }
 
-void ToDictionary(base::DictionaryValue* details, const GURL& location) {
-  details->SetString("redirectURL", location.spec());
+void FillDetails(RequestDetails* details, const GURL& location) {
+  details->mutable_fields()->SetString("redirectURL", location.spec());
 }
 
-void ToDictionary(base::DictionaryValue* details,
-                  const net::HostPortPair& host_port) {
+void FillDetails(RequestDetails* details,
+                 const net::HostPortPair& host_port) {
   if (host_port.host().empty())
-    details->SetString("ip", host_port.host());
+    details->mutable_fields()->SetString("ip", host_port.host());
 }
 
-void ToDictionary(base::DictionaryValue* details, bool from_cache) {
-  details->SetBoolean("fromCache", from_cache);
+void FillDetails(RequestDetails* details, bool from_cache) {
+  details->mutable_fields()->SetBoolean("fromCache", from_cache);
 }
 
-void ToDictionary(base::DictionaryValue* details,
-                  const net::URLRequestStatus& status) {
-  details->SetString("error", net::ErrorToString(status.error()));
+void FillDetails(RequestDetails* details,
+                 const net::URLRequestStatus& status) {
+  details->mutable_fields()->SetString("error",
+                                       net::ErrorToString(status.error()));
 }
 
 // Helper function to fill |details| with arbitrary |args|.
 template<typename Arg>
-void FillDetailsObject(base::DictionaryValue* details, Arg arg) {
-  ToDictionary(details, arg);
+void FillDetailsObject(RequestDetails* details, Arg arg) {
+  FillDetails(details, arg);
 }
 
 template<typename Arg, typename... Args>
-void FillDetailsObject(base::DictionaryValue* details, Arg arg, Args... args) {
-  ToDictionary(details, arg);
+void FillDetailsObject(RequestDetails* details, Arg arg, Args... args) {
+  FillDetails(details, arg);
   FillDetailsObject(details, args...);
 }
 
@@ -198,7 +201,19 @@ void ReadFromResponseObject(const base::DictionaryValue& response,
 
 }  // namespace
 
-AtomNetworkDelegate::AtomNetworkDelegate() {
+AtomNetworkDelegate::BatchOptions::BatchOptions()
+    : interval(base::TimeDelta::FromMilliseconds(100)),
+      max_size(100) {
+}
+
+AtomNetworkDelegate::SimpleListenerInfo::SimpleListenerInfo() {
+}
+
+AtomNetworkDelegate::SimpleListenerInfo::~SimpleListenerInfo() {
+}
+
+AtomNetworkDelegate::AtomNetworkDelegate()
+    : stats_(new RequestEventStats) {
 }
 
 AtomNetworkDelegate::~AtomNetworkDelegate() {
@@ -208,20 +223,50 @@ void AtomNetworkDelegate::SetSimpleListenerInIO(
     SimpleEvent type,
     const URLPatterns& patterns,
     const SimpleListener& callback) {
-  if (callback.is_null())
+  // Deliver what the replaced batch listener has accumulated.
+  FlushBatch(type);
+
+  if (callback.is_null()) {
     simple_listeners_.erase(type);
-  else
-    simple_listeners_[type] = { patterns, callback };
+    return;
+  }
+
+  SimpleListenerInfo& info = simple_listeners_[type];
+  info.url_patterns.SetPatterns(patterns);
+  info.listener = callback;
+  info.batch_listener.Reset();
+}
+
+void AtomNetworkDelegate::SetBatchListenerInIO(
+    SimpleEvent type,
+    const URLPatterns& patterns,
+    const BatchOptions& options,
+    const BatchListener& callback) {
+  FlushBatch(type);
+
+  SimpleListenerInfo& info = simple_listeners_[type];
+  info.url_patterns.SetPatterns(patterns);
+  info.listener.Reset();
+  info.batch_listener = callback;
+  info.batch_options = options;
 }
 
 void AtomNetworkDelegate::SetResponseListenerInIO(
     ResponseEvent type,
     const URLPatterns& patterns,
     const ResponseListener& callback) {
-  if (callback.is_null())
+  if (callback.is_null()) {
     response_listeners_.erase(type);
-  else
-    response_listeners_[type] = { patterns, callback };
+    return;
+  }
+
+  ResponseListenerInfo& info = response_listeners_[type];
+  info.url_patterns.SetPatterns(patterns);
+  info.listener = callback;
+}
+
+void AtomNetworkDelegate::SetRulesInIO(std::unique_ptr<RequestRules> rules) {
+  rules_ = std::move(rules);
 }
 
 void AtomNetworkDelegate::SetDevToolsNetworkEmulationClientId(
@@ -234,6 +279,17 @@ int AtomNetworkDelegate::OnBeforeURLRequest(
     net::URLRequest* request,
     const net::CompletionCallback& callback,
     GURL* new_url) {
+  if (rules_) {
+    switch (rules_->GetAction(request, new_url)) {
+      case RequestRules::ACTION_BLOCK:
+        return net::ERR_BLOCKED_BY_CLIENT;
+      case RequestRules::ACTION_REDIRECT:
+        return net::OK;
+      case RequestRules::ACTION_NONE:
+        break;
+    }
+  }
+
   if (!ContainsKey(response_listeners_, kOnBeforeRequest))
     return brightray::NetworkDelegate::OnBeforeURLRequest(
         request, callback, new_url);
@@ -255,6 +311,8 @@ int AtomNetworkDelegate::OnBeforeSendHeaders(
     headers->SetHeader(
         DevToolsNetworkTransaction::kDevToolsEmulateNetworkConditionsClientId,
         client_id);
+  if (rules_)
+    rules_->ModifyRequestHeaders(request, headers);
   if (!ContainsKey(response_listeners_, kOnBeforeSendHeaders))
     return brightray::NetworkDelegate::OnBeforeSendHeaders(
         request, callback, headers);
@@ -280,13 +338,18 @@ int AtomNetworkDelegate::OnHeadersReceived(
     const net::HttpResponseHeaders* original,
     scoped_refptr<net::HttpResponseHeaders>* override,
     GURL* allowed) {
+  // The listener sees the headers as modified by the rules.
+  const net::HttpResponseHeaders* headers = original;
+  if (rules_ && rules_->ModifyResponseHeaders(request, original, override))
+    headers = override->get();
+
   if (!ContainsKey(response_listeners_, kOnHeadersReceived))
     return brightray::NetworkDelegate::OnHeadersReceived(
         request, callback, original, override, allowed);
 
   return HandleResponseEvent(
       kOnHeadersReceived, request, callback,
-      std::make_pair(override, original->GetStatusLine()), original);
+      std::make_pair(override, headers->GetStatusLine()), headers);
 }
 
 void AtomNetworkDelegate::OnBeforeRedirect(net::URLRequest* request,
@@ -366,7 +429,8 @@ int AtomNetworkDelegate::HandleResponseEvent(
   if (!MatchesFilterCondition(request, info.url_patterns))
     return net::OK;
 
-  std::unique_ptr<base::DictionaryValue> details(new base::DictionaryValue);
+  scoped_refptr<RequestDetails> details(
+      new RequestDetails(kResponseEventNames[type], stats_));
   FillDetailsObject(details.get(), request, args...);
 
   // The |request| could be destroyed before the |callback| is called.
@@ -377,24 +441,52 @@ int AtomNetworkDelegate::HandleResponseEvent(
                  base::Unretained(this), request->identifier(), out);
   BrowserThread::PostTask(
       BrowserThread::UI, FROM_HERE,
-      base::Bind(RunResponseListener, info.listener, base::Passed(&details),
-                 response));
+      base::Bind(RunResponseListener, info.listener, details, response));
   return net::ERR_IO_PENDING;
 }
 
 template<typename...Args>
 void AtomNetworkDelegate::HandleSimpleEvent(
     SimpleEvent type, net::URLRequest* request, Args... args) {
-  const auto& info = simple_listeners_[type];
+  auto& info = simple_listeners_[type];
   if (!MatchesFilterCondition(request, info.url_patterns))
     return;
 
-  std::unique_ptr<base::DictionaryValue> details(new base::DictionaryValue);
+  scoped_refptr<RequestDetails> details(
+      new RequestDetails(kSimpleEventNames[type], stats_));
   FillDetailsObject(details.get(), request, args...);
 
+  if (info.batch_listener.is_null()) {
+    BrowserThread::PostTask(
+        BrowserThread::UI, FROM_HERE,
+        base::Bind(RunSimpleListener, info.listener, details));
+    return;
+  }
+
+  info.batch.push_back(details);
+  if (info.batch.size() >= info.batch_options.max_size)
+    FlushBatch(type);
+  else if (!info.batch_timer.IsRunning())
+    info.batch_timer.Start(FROM_HERE, info.batch_options.interval,
+                           base::Bind(&AtomNetworkDelegate::FlushBatch,
+                                      base::Unretained(this), type));
+}
+
+void AtomNetworkDelegate::FlushBatch(SimpleEvent type) {
+  auto iter = simple_listeners_.find(type);
+  if (iter == simple_listeners_.end())
+    return;
+
+  SimpleListenerInfo& info = iter->second;
+  info.batch_timer.Stop();
+  if (info.batch.empty())
+    return;
+
+  std::vector<scoped_refptr<RequestDetails>> batch;
+  batch.swap(info.batch);
   BrowserThread::PostTask(
       BrowserThread::UI, FROM_HERE,
-      base::Bind(RunSimpleListener, info.listener, base::Passed(&details)));
+      base::Bind(RunBatchListener, info.batch_listener, batch));
 }
 
 template<typename T>
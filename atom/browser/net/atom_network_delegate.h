@@ -6,14 +6,19 @@
 #define ATOM_BROWSER_NET_ATOM_NETWORK_DELEGATE_H_
 
 #include <map>
-#include <set>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "atom/browser/net/request_details.h"
+#include "atom/browser/net/request_rules.h"
+#include "atom/browser/net/url_pattern_matcher.h"
 #include "brightray/browser/network_delegate.h"
 #include "base/callback.h"
 #include "base/synchronization/lock.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "base/values.h"
-#include "extensions/common/url_pattern.h"
 #include "net/base/net_errors.h"
 #include "net/http/http_request_headers.h"
 #include "net/http/http_response_headers.h"
@@ -21,16 +26,16 @@
 
 namespace atom {
 
-using URLPatterns = std::set<URLPattern>;
-
 const char* ResourceTypeToString(content::ResourceType type);
 
 class AtomNetworkDelegate : public brightray::NetworkDelegate {
  public:
   using ResponseCallback = base::Callback<void(const base::DictionaryValue&)>;
-  using SimpleListener = base::Callback<void(const base::DictionaryValue&)>;
-  using ResponseListener = base::Callback<void(const base::DictionaryValue&,
+  using SimpleListener = base::Callback<void(RequestDetails*)>;
+  using ResponseListener = base::Callback<void(RequestDetails*,
                                                const ResponseCallback&)>;
+  using BatchListener =
+      base::Callback<void(const std::vector<RequestDetails*>&)>;
 
   enum SimpleEvent {
     kOnSendHeaders,
@@ -46,13 +51,32 @@ class AtomNetworkDelegate : public brightray::NetworkDelegate {
     kOnHeadersReceived,
   };
 
+  // How events are accumulated for a BatchListener.
+  struct BatchOptions {
+    BatchOptions();
+
+    // Longest time an event waits before its batch is delivered.
+    base::TimeDelta interval;
+    // A batch is delivered as soon as it has this many events.
+    size_t max_size;
+  };
+
   struct SimpleListenerInfo {
-    URLPatterns url_patterns;
+    SimpleListenerInfo();
+    ~SimpleListenerInfo();
+
+    URLPatternMatcher url_patterns;
     SimpleListener listener;
+
+    // Set instead of |listener| in batched mode.
+    BatchListener batch_listener;
+    BatchOptions batch_options;
+    std::vector<scoped_refptr<RequestDetails>> batch;
+    base::OneShotTimer batch_timer;
   };
 
   struct ResponseListenerInfo {
-    URLPatterns url_patterns;
+    URLPatternMatcher url_patterns;
     ResponseListener listener;
   };
 
@@ -62,12 +86,22 @@ class AtomNetworkDelegate : public brightray::NetworkDelegate {
   void SetSimpleListenerInIO(SimpleEvent type,
                              const URLPatterns& patterns,
                              const SimpleListener& callback);
+  void SetBatchListenerInIO(SimpleEvent type,
+                            const URLPatterns& patterns,
+                            const BatchOptions& options,
+                            const BatchListener& callback);
   void SetResponseListenerInIO(ResponseEvent type,
                                const URLPatterns& patterns,
                                const ResponseListener& callback);
 
+  // Replaces the declarative rules, passing nullptr removes them.
+  void SetRulesInIO(std::unique_ptr<RequestRules> rules);
+
   void SetDevToolsNetworkEmulationClientId(const std::string& client_id);
 
+  // Counters of the details passed to listeners, can be used on any thread.
+  RequestEventStats* stats() const { return stats_.get(); }
+
  protected:
   // net::NetworkDelegate:
   int OnBeforeURLRequest(net::URLRequest* request,
@@ -93,6 +127,9 @@ class AtomNetworkDelegate : public brightray::NetworkDelegate {
  private:
   void OnErrorOccurred(net::URLRequest* request, bool started);
 
+  // Delivers the events accumulated for the batch listener of |type|.
+  void FlushBatch(SimpleEvent type);
+
   template<typename...Args>
   void HandleSimpleEvent(SimpleEvent type,
                          net::URLRequest* request,
@@ -116,6 +153,12 @@ class AtomNetworkDelegate : public brightray::NetworkDelegate {
   std::map<ResponseEvent, ResponseListenerInfo> response_listeners_;
   std::map<uint64_t, net::CompletionCallback> callbacks_;
 
+  // Evaluated before the listeners, which only see the requests the rules
+  // did not block or redirect.
+  std::unique_ptr<RequestRules> rules_;
+
+  scoped_refptr<RequestEventStats> stats_;
+
   base::Lock lock_;
 
   // Client id for devtools network emulation.
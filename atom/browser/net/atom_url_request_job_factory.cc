@@ -5,6 +5,8 @@
 
 #include "atom/browser/net/atom_url_request_job_factory.h"
 
+#include <utility>
+
 #include "base/memory/ptr_util.h"
 #include "base/stl_util.h"
 #include "content/public/browser/browser_thread.h"
@@ -17,7 +19,8 @@ namespace atom {
 
 typedef net::URLRequestJobFactory::ProtocolHandler ProtocolHandler;
 
-AtomURLRequestJobFactory::AtomURLRequestJobFactory() {}
+AtomURLRequestJobFactory::AtomURLRequestJobFactory()
+    : response_cache_(new ProtocolResponseCache) {}
 
 AtomURLRequestJobFactory::~AtomURLRequestJobFactory() {
   Clear();
@@ -33,6 +36,8 @@ bool AtomURLRequestJobFactory::SetProtocolHandler(
 
     delete it->second;
     protocol_handler_map_.erase(it);
+    native_routes_.erase(scheme);
+    response_cache_->Invalidate(scheme + ":");
     return true;
   }
 
@@ -51,6 +56,7 @@ bool AtomURLRequestJobFactory::InterceptProtocol(
   ProtocolHandler* original_protocol_handler = protocol_handler_map_[scheme];
   protocol_handler_map_[scheme] = protocol_handler.release();
   original_protocols_.set(scheme, base::WrapUnique(original_protocol_handler));
+  response_cache_->Invalidate(scheme + ":");
   return true;
 }
 
@@ -59,6 +65,21 @@ bool AtomURLRequestJobFactory::UninterceptProtocol(const std::string& scheme) {
     return false;
   protocol_handler_map_[scheme] =
       original_protocols_.take_and_erase(scheme).release();
+  response_cache_->Invalidate(scheme + ":");
+  return true;
+}
+
+bool AtomURLRequestJobFactory::SetNativeRoutes(
+    const std::string& scheme,
+    std::unique_ptr<NativeProtocolRoutes> routes) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+
+  if (!HasProtocolHandler(scheme))
+    return false;
+  if (!routes || routes->empty())
+    native_routes_.erase(scheme);
+  else
+    native_routes_[scheme] = std::move(routes);
   return true;
 }
 
@@ -79,6 +100,7 @@ bool AtomURLRequestJobFactory::HasProtocolHandler(
 
 void AtomURLRequestJobFactory::Clear() {
   STLDeleteValues(&protocol_handler_map_);
+  native_routes_.clear();
 }
 
 net::URLRequestJob* AtomURLRequestJobFactory::MaybeCreateJobWithProtocolHandler(
@@ -90,6 +112,19 @@ net::URLRequestJob* AtomURLRequestJobFactory::MaybeCreateJobWithProtocolHandler(
   auto it = protocol_handler_map_.find(scheme);
   if (it == protocol_handler_map_.end())
     return nullptr;
+
+  // Requests matching the routes never reach the JavaScript handler.
+  auto routes = native_routes_.find(scheme);
+  if (routes != native_routes_.end()) {
+    net::URLRequestJob* job =
+        routes->second->MaybeCreateJob(request, network_delegate);
+    if (job)
+      return job;
+  }
+  net::URLRequestJob* job =
+      response_cache_->MaybeCreateJob(request, network_delegate);
+  if (job)
+    return job;
   return it->second->MaybeCreateJob(request, network_delegate);
 }
 
@@ -11,6 +11,8 @@
 #include <string>
 #include <vector>
 
+#include "atom/browser/net/native_protocol_routes.h"
+#include "atom/browser/net/protocol_response_cache.h"
 #include "base/containers/scoped_ptr_hash_map.h"
 #include "net/url_request/url_request_job_factory.h"
 
@@ -33,6 +35,17 @@ class AtomURLRequestJobFactory : public net::URLRequestJobFactory {
       std::unique_ptr<ProtocolHandler> protocol_handler);
   bool UninterceptProtocol(const std::string& scheme);
 
+  // Sets the routes of |scheme| that are served before asking its protocol
+  // handler, passing nullptr removes them. Returns false when there is no
+  // protocol handler registered for |scheme|.
+  bool SetNativeRoutes(const std::string& scheme,
+                       std::unique_ptr<NativeProtocolRoutes> routes);
+
+  // The cache of the responses sent by JavaScript handlers.
+  ProtocolResponseCache* response_cache() const {
+    return response_cache_.get();
+  }
+
   // Returns the protocol handler registered with scheme.
   ProtocolHandler* GetProtocolHandler(const std::string& scheme) const;
 
@@ -69,6 +82,11 @@ class AtomURLRequestJobFactory : public net::URLRequestJobFactory {
   // Can only be accessed in IO thread.
   OriginalProtocolsMap original_protocols_;
 
+  // Routes of schemes, can only be accessed in IO thread.
+  std::map<std::string, std::unique_ptr<NativeProtocolRoutes>> native_routes_;
+
+  scoped_refptr<ProtocolResponseCache> response_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(AtomURLRequestJobFactory);
 };
 
@@ -16,7 +16,8 @@ namespace internal {
 namespace {
 
 // The callback which is passed to |handler|.
-void HandlerCallback(const BeforeStartCallback& before_start,
+void HandlerCallback(bool convert_objects,
+                     const BeforeStartCallback& before_start,
                      const ResponseCallback& callback,
                      mate::Arguments* args) {
   // If there is no argument passed then we failed.
@@ -31,6 +32,15 @@ void HandlerCallback(const BeforeStartCallback& before_start,
   // Give the job a chance to parse V8 value.
   before_start.Run(args->isolate(), value);
 
+  // The job keeps the object by itself.
+  if (!convert_objects && value->IsObject()) {
+    std::unique_ptr<base::Value> options(new base::DictionaryValue);
+    content::BrowserThread::PostTask(
+        content::BrowserThread::IO, FROM_HERE,
+        base::Bind(callback, true, base::Passed(&options)));
+    return;
+  }
+
   // Pass whatever user passed to the actaul request job.
   V8ValueConverter converter;
   v8::Local<v8::Context> context = args->isolate()->GetCurrentContext();
@@ -45,6 +55,7 @@ void HandlerCallback(const BeforeStartCallback& before_start,
 void AskForOptions(v8::Isolate* isolate,
                    const JavaScriptHandler& handler,
                    std::unique_ptr<base::DictionaryValue> request_details,
+                   bool convert_objects,
                    const BeforeStartCallback& before_start,
                    const ResponseCallback& callback) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
@@ -55,7 +66,8 @@ void AskForOptions(v8::Isolate* isolate,
   handler.Run(
       *(request_details.get()),
       mate::ConvertToV8(isolate,
-                        base::Bind(&HandlerCallback, before_start, callback)));
+                        base::Bind(&HandlerCallback, convert_objects,
+                                   before_start, callback)));
 }
 
 bool IsErrorOptions(base::Value* value, int* error) {
@@ -70,6 +82,15 @@ bool IsErrorOptions(base::Value* value, int* error) {
   return false;
 }
 
+std::unique_ptr<base::DictionaryValue> GetRequestHeaders(
+    const net::HttpRequestHeaders& headers) {
+  std::unique_ptr<base::DictionaryValue> dict(new base::DictionaryValue);
+  net::HttpRequestHeaders::Iterator it(headers);
+  while (it.GetNext())
+    dict->SetStringWithoutPathExpansion(it.name(), it.value());
+  return dict;
+}
+
 }  // namespace internal
 
 }  // namespace atom
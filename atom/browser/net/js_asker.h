@@ -5,6 +5,7 @@
 #ifndef ATOM_BROWSER_NET_JS_ASKER_H_
 #define ATOM_BROWSER_NET_JS_ASKER_H_
 
+#include "atom/browser/net/protocol_response_cache.h"
 #include "atom/common/native_mate_converters/net_converter.h"
 #include "base/callback.h"
 #include "base/memory/ref_counted.h"
@@ -12,6 +13,7 @@
 #include "base/values.h"
 #include "content/public/browser/browser_thread.h"
 #include "net/base/net_errors.h"
+#include "net/http/http_request_headers.h"
 #include "net/http/http_response_headers.h"
 #include "net/url_request/url_request_context_getter.h"
 #include "net/url_request/url_request_job.h"
@@ -29,16 +31,23 @@ using BeforeStartCallback =
 using ResponseCallback =
     base::Callback<void(bool, std::unique_ptr<base::Value> options)>;
 
-// Ask handler for options in UI thread.
+// Ask handler for options in UI thread. Objects passed by the handler are
+// only converted when |convert_objects| is true, otherwise the job gets an
+// empty dictionary and reads them in BeforeStartInUI.
 void AskForOptions(v8::Isolate* isolate,
                    const JavaScriptHandler& handler,
                    std::unique_ptr<base::DictionaryValue> request_details,
+                   bool convert_objects,
                    const BeforeStartCallback& before_start,
                    const ResponseCallback& callback);
 
 // Test whether the |options| means an error.
 bool IsErrorOptions(base::Value* value, int* error);
 
+// Converts the request headers passed to the handler.
+std::unique_ptr<base::DictionaryValue> GetRequestHeaders(
+    const net::HttpRequestHeaders& headers);
+
 }  // namespace internal
 
 template<typename RequestJob>
@@ -51,32 +60,66 @@ class JsAsker : public RequestJob {
   void SetHandlerInfo(
       v8::Isolate* isolate,
       net::URLRequestContextGetter* request_context_getter,
-      const JavaScriptHandler& handler) {
+      const JavaScriptHandler& handler,
+      ProtocolResponseCache* response_cache) {
     isolate_ = isolate;
     request_context_getter_ = request_context_getter;
     handler_ = handler;
+    response_cache_ = response_cache;
   }
 
   // Subclass should do initailze work here.
   virtual void BeforeStartInUI(v8::Isolate*, v8::Local<v8::Value>) {}
   virtual void StartAsync(std::unique_ptr<base::Value> options) = 0;
 
+  // Whether objects passed by the handler are converted to the options of
+  // StartAsync, jobs that keep JavaScript objects can skip the conversion.
+  virtual bool ShouldConvertOptions() const { return true; }
+
+  // Whether the "headers" of the options are sent with the response.
+  virtual bool UsesResponseHeaders() const { return true; }
+
   net::URLRequestContextGetter* request_context_getter() const {
     return request_context_getter_;
   }
 
+  // Whether the response can be stored in the response cache, which needs a
+  // Cache-Control header from the handler.
+  bool ShouldCacheResponse() const {
+    return response_cache_ && response_cache_->enabled() &&
+           !cache_headers_.cache_control.empty();
+  }
+
+  // Stores the response of the job in the response cache.
+  void CacheResponse(ProtocolResponseCache::Response response) {
+    if (!ShouldCacheResponse())
+      return;
+    response.headers = cache_headers_.headers;
+    response.cache_control = cache_headers_.cache_control;
+    response.etag = cache_headers_.etag;
+    response_cache_->Put(RequestJob::request(), response);
+  }
+
+  // Adds the headers set by the handler.
+  void AddCacheHeaders(net::HttpResponseHeaders* headers) const {
+    ProtocolResponseCache::AddHeaders(cache_headers_, headers);
+  }
+
  private:
   // RequestJob:
   void Start() override {
     std::unique_ptr<base::DictionaryValue> request_details(
         new base::DictionaryValue);
     FillRequestDetails(request_details.get(), RequestJob::request());
+    request_details->Set("headers", internal::GetRequestHeaders(
+        RequestJob::request()->extra_request_headers()));
     content::BrowserThread::PostTask(
         content::BrowserThread::UI, FROM_HERE,
         base::Bind(&internal::AskForOptions,
                    isolate_,
                    handler_,
                    base::Passed(&request_details),
+                   ShouldConvertOptions(),
                    base::Bind(&JsAsker::BeforeStartInUI,
                               weak_factory_.GetWeakPtr()),
                    base::Bind(&JsAsker::OnResponse,
@@ -91,16 +134,26 @@ class JsAsker : public RequestJob {
   void OnResponse(bool success, std::unique_ptr<base::Value> value) {
     int error = net::ERR_NOT_IMPLEMENTED;
     if (success && value && !internal::IsErrorOptions(value.get(), &error)) {
-      StartAsync(std::move(value));
-    } else {
-      RequestJob::NotifyStartError(
-          net::URLRequestStatus(net::URLRequestStatus::FAILED, error));
+      if (!UsesResponseHeaders() ||
+          !value->IsType(base::Value::TYPE_DICTIONARY) ||
+          ProtocolResponseCache::ReadHeaders(
+              *static_cast<base::DictionaryValue*>(value.get()),
+              &cache_headers_)) {
+        StartAsync(std::move(value));
+        return;
+      }
+      error = net::ERR_INVALID_RESPONSE;
     }
+    RequestJob::NotifyStartError(
+        net::URLRequestStatus(net::URLRequestStatus::FAILED, error));
   }
 
   v8::Isolate* isolate_;
   net::URLRequestContextGetter* request_context_getter_;
   JavaScriptHandler handler_;
+  scoped_refptr<ProtocolResponseCache> response_cache_;
+  // The headers set by the handler.
+  ProtocolResponseCache::Response cache_headers_;
 
   base::WeakPtrFactory<JsAsker> weak_factory_;
 
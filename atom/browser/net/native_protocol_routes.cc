@@ -0,0 +1,194 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/native_protocol_routes.h"
+
+#include <algorithm>
+
+#include "atom/browser/net/asar/url_request_asar_job.h"
+#include "atom/browser/net/url_request_memory_job.h"
+#include "base/strings/string_util.h"
+#include "base/threading/sequenced_worker_pool.h"
+#include "base/values.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/base/escape.h"
+#include "net/http/http_status_code.h"
+#include "net/url_request/url_request.h"
+#include "url/gurl.h"
+
+namespace atom {
+
+namespace {
+
+// Routes ignore the query and the fragment of URLs.
+std::string GetRouteURL(const GURL& url) {
+  GURL::Replacements replacements;
+  replacements.ClearQuery();
+  replacements.ClearRef();
+  return url.ReplaceComponents(replacements).spec();
+}
+
+bool ParseRouteURL(const std::string& scheme,
+                   const std::string& spec,
+                   std::string* url,
+                   std::string* error) {
+  GURL gurl(spec);
+  if (!gurl.is_valid() || !gurl.SchemeIs(scheme)) {
+    *error = "'" + spec + "' is not a URL of the '" + scheme + "' scheme";
+    return false;
+  }
+  *url = GetRouteURL(gurl);
+  return true;
+}
+
+}  // namespace
+
+NativeProtocolRoutes::File::File() {
+}
+
+NativeProtocolRoutes::File::File(const File& other) = default;
+
+NativeProtocolRoutes::File::~File() {
+}
+
+NativeProtocolRoutes::NativeProtocolRoutes() {
+}
+
+NativeProtocolRoutes::~NativeProtocolRoutes() {
+}
+
+// static
+std::unique_ptr<NativeProtocolRoutes> NativeProtocolRoutes::Create(
+    const std::string& scheme,
+    const base::DictionaryValue& routes,
+    std::string* error) {
+  std::unique_ptr<NativeProtocolRoutes> result(new NativeProtocolRoutes);
+
+  const base::DictionaryValue* files = nullptr;
+  if (routes.HasKey("files") && !routes.GetDictionary("files", &files)) {
+    *error = "'files' must be an Object";
+    return nullptr;
+  }
+  if (files) {
+    for (base::DictionaryValue::Iterator it(*files); !it.IsAtEnd();
+         it.Advance()) {
+      std::string url;
+      if (!ParseRouteURL(scheme, it.key(), &url, error))
+        return nullptr;
+
+      const base::DictionaryValue* dict = nullptr;
+      const base::BinaryValue* binary = nullptr;
+      std::string string;
+      File file;
+      if (!it.value().GetAsDictionary(&dict)) {
+        *error = "File '" + it.key() + "' must be an Object";
+        return nullptr;
+      } else if (dict->GetBinary("data", &binary)) {
+        file.data = new base::RefCountedBytes(
+            reinterpret_cast<const unsigned char*>(binary->GetBuffer()),
+            binary->GetSize());
+      } else if (dict->GetString("data", &string)) {
+        file.data = base::RefCountedString::TakeString(&string);
+      } else {
+        *error = "Data of file '" + it.key() + "' must be a Buffer or String";
+        return nullptr;
+      }
+      dict->GetString("mimeType", &file.mime_type);
+      result->files_[url] = file;
+    }
+  }
+
+  const base::DictionaryValue* directories = nullptr;
+  if (routes.HasKey("directories") &&
+      !routes.GetDictionary("directories", &directories)) {
+    *error = "'directories' must be an Object";
+    return nullptr;
+  }
+  if (directories) {
+    for (base::DictionaryValue::Iterator it(*directories); !it.IsAtEnd();
+         it.Advance()) {
+      std::string prefix;
+      if (!ParseRouteURL(scheme, it.key(), &prefix, error))
+        return nullptr;
+      // Prefixes only match whole path segments, "dir" does not serve
+      // "dir-other/".
+      if (prefix.back() != '/')
+        prefix.push_back('/');
+
+      std::string path;
+      if (!it.value().GetAsString(&path) ||
+          !base::FilePath::FromUTF8Unsafe(path).IsAbsolute()) {
+        *error = "Directory of '" + it.key() + "' must be an absolute path";
+        return nullptr;
+      }
+      result->directories_.push_back(
+          std::make_pair(prefix, base::FilePath::FromUTF8Unsafe(path)));
+    }
+
+    // The longest matching prefix wins, so test them from the longest.
+    std::sort(result->directories_.begin(), result->directories_.end(),
+              [](const std::pair<std::string, base::FilePath>& a,
+                 const std::pair<std::string, base::FilePath>& b) {
+                return a.first.size() > b.first.size();
+              });
+  }
+
+  return result;
+}
+
+net::URLRequestJob* NativeProtocolRoutes::MaybeCreateJob(
+    net::URLRequest* request,
+    net::NetworkDelegate* network_delegate) const {
+  std::string url = GetRouteURL(request->url());
+
+  auto it = files_.find(url);
+  if (it != files_.end()) {
+    return new URLRequestMemoryJob(request, network_delegate, net::HTTP_OK,
+                                   it->second.mime_type, std::string(),
+                                   it->second.data,
+                                   URLRequestMemoryJob::Headers());
+  }
+
+  base::FilePath path;
+  if (!GetFilePath(url, &path))
+    return nullptr;
+  auto* job = new asar::URLRequestAsarJob(request, network_delegate);
+  job->Initialize(
+      content::BrowserThread::GetBlockingPool()->
+          GetTaskRunnerWithShutdownBehavior(
+              base::SequencedWorkerPool::SKIP_ON_SHUTDOWN),
+      path);
+  return job;
+}
+
+bool NativeProtocolRoutes::GetFilePath(const std::string& url,
+                                       base::FilePath* path) const {
+  for (const auto& directory : directories_) {
+    // The prefix without its trailing slash is the directory itself.
+    const std::string& prefix = directory.first;
+    std::string relative;
+    if (base::StartsWith(url, prefix, base::CompareCase::SENSITIVE))
+      relative = url.substr(prefix.size());
+    else if (url.size() + 1 != prefix.size() ||
+             !base::StartsWith(prefix, url, base::CompareCase::SENSITIVE))
+      continue;
+
+    // Escaped separators are kept, so a name can not be split into paths.
+    relative = net::UnescapeURLComponent(
+        relative,
+        net::UnescapeRule::SPACES |
+        net::UnescapeRule::URL_SPECIAL_CHARS_EXCEPT_PATH_SEPARATORS);
+    if (relative.empty() || relative.back() == '/')
+      relative.append("index.html");
+
+    base::FilePath relative_path = base::FilePath::FromUTF8Unsafe(relative);
+    if (relative_path.IsAbsolute() || relative_path.ReferencesParent())
+      return false;
+    *path = directory.second.Append(relative_path);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace atom
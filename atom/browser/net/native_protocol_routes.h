@@ -0,0 +1,78 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_NATIVE_PROTOCOL_ROUTES_H_
+#define ATOM_BROWSER_NET_NATIVE_PROTOCOL_ROUTES_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
+
+namespace base {
+class DictionaryValue;
+}
+
+namespace net {
+class NetworkDelegate;
+class URLRequest;
+class URLRequestJob;
+}
+
+namespace atom {
+
+// Responses of a custom protocol that are resolved on the IO thread, so the
+// requests they match never wait for the JavaScript handler of the protocol.
+//
+// Files kept in memory are looked up by their exact URL, and directories,
+// which can also be asar archives, are matched by the longest URL prefix.
+class NativeProtocolRoutes {
+ public:
+  ~NativeProtocolRoutes();
+
+  // Parses the routes passed to protocol.setNativeRoutes for |scheme|,
+  // returns nullptr and sets |error| when any route is invalid.
+  static std::unique_ptr<NativeProtocolRoutes> Create(
+      const std::string& scheme,
+      const base::DictionaryValue& routes,
+      std::string* error);
+
+  // Returns the job serving |request|, or nullptr when no route matches it.
+  net::URLRequestJob* MaybeCreateJob(
+      net::URLRequest* request,
+      net::NetworkDelegate* network_delegate) const;
+
+  bool empty() const { return files_.empty() && directories_.empty(); }
+
+ private:
+  struct File {
+    File();
+    File(const File& other);
+    ~File();
+
+    std::string mime_type;
+    scoped_refptr<base::RefCountedMemory> data;
+  };
+
+  NativeProtocolRoutes();
+
+  // Returns the path of the file |url| is mapped to by the directories.
+  bool GetFilePath(const std::string& url, base::FilePath* path) const;
+
+  std::unordered_map<std::string, File> files_;
+  // Sorted by the length of the prefix, longest first.
+  std::vector<std::pair<std::string, base::FilePath>> directories_;
+
+  DISALLOW_COPY_AND_ASSIGN(NativeProtocolRoutes);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_NATIVE_PROTOCOL_ROUTES_H_
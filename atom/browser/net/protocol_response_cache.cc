@@ -0,0 +1,293 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/protocol_response_cache.h"
+
+#include <utility>
+
+#include "atom/browser/net/asar/url_request_asar_job.h"
+#include "atom/browser/net/url_request_memory_job.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/threading/sequenced_worker_pool.h"
+#include "base/values.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_response_info.h"
+#include "net/http/http_status_code.h"
+#include "net/http/http_util.h"
+#include "net/url_request/url_request.h"
+#include "url/gurl.h"
+
+namespace atom {
+
+namespace {
+
+const char kIfNoneMatch[] = "If-None-Match";
+
+// Sends a file whose path is cached.
+class URLRequestCachedFileJob : public asar::URLRequestAsarJob {
+ public:
+  URLRequestCachedFileJob(net::URLRequest* request,
+                          net::NetworkDelegate* network_delegate,
+                          const ProtocolResponseCache::Response& response)
+      : asar::URLRequestAsarJob(request, network_delegate),
+        response_(response) {
+    Initialize(content::BrowserThread::GetBlockingPool()->
+                   GetTaskRunnerWithShutdownBehavior(
+                       base::SequencedWorkerPool::SKIP_ON_SHUTDOWN),
+               response.file_path);
+  }
+
+  // URLRequestJob:
+  void GetResponseInfo(net::HttpResponseInfo* info) override {
+    asar::URLRequestAsarJob::GetResponseInfo(info);
+    ProtocolResponseCache::AddHeaders(response_, info->headers.get());
+  }
+
+ private:
+  ProtocolResponseCache::Response response_;
+
+  DISALLOW_COPY_AND_ASSIGN(URLRequestCachedFileJob);
+};
+
+// The fragment is never sent to the handler, so it is not part of the key.
+std::string GetCacheKey(const GURL& url) {
+  GURL::Replacements replacements;
+  replacements.ClearRef();
+  return url.ReplaceComponents(replacements).spec();
+}
+
+// Returns the "max-age" of |cache_control|, responses that must not be
+// reused without asking the handler have none.
+bool GetMaxAge(const std::string& cache_control, base::TimeDelta* max_age) {
+  bool found = false;
+  for (const auto& directive : base::SplitString(
+           cache_control, ",", base::TRIM_WHITESPACE,
+           base::SPLIT_WANT_NONEMPTY)) {
+    std::string name = base::ToLowerASCII(directive);
+    if (name == "no-store" || name == "no-cache")
+      return false;
+
+    int64_t seconds;
+    if (base::StartsWith(name, "max-age=", base::CompareCase::SENSITIVE) &&
+        base::StringToInt64(name.substr(8), &seconds) && seconds > 0) {
+      *max_age = base::TimeDelta::FromSeconds(seconds);
+      found = true;
+    }
+  }
+  return found;
+}
+
+// An entity tag is a quoted string, optionally marked as weak with "W/".
+bool IsValidETag(const std::string& etag) {
+  size_t start = base::StartsWith(etag, "W/", base::CompareCase::SENSITIVE) ?
+      2 : 0;
+  return etag.size() >= start + 2 && etag[start] == '"' &&
+         etag.back() == '"' &&
+         etag.find('"', start + 1) == etag.size() - 1;
+}
+
+// Weak comparison ignores the "W/" prefix of both tags.
+base::StringPiece GetOpaqueTag(base::StringPiece etag) {
+  if (etag.starts_with("W/"))
+    etag.remove_prefix(2);
+  return etag;
+}
+
+// Whether a request with |if_none_match| already has the response tagged
+// with |etag|.
+bool MatchesETag(const std::string& if_none_match, const std::string& etag) {
+  net::HttpUtil::ValuesIterator values(if_none_match.begin(),
+                                       if_none_match.end(), ',');
+  while (values.GetNext()) {
+    base::StringPiece value(values.value_begin(), values.value_end());
+    if (value == "*" || GetOpaqueTag(value) == GetOpaqueTag(etag))
+      return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+ProtocolResponseCache::Response::Response() {
+}
+
+ProtocolResponseCache::Response::Response(const Response& other) = default;
+
+ProtocolResponseCache::Response::~Response() {
+}
+
+ProtocolResponseCache::Entry::Entry() : size(0) {
+}
+
+ProtocolResponseCache::Entry::~Entry() {
+}
+
+ProtocolResponseCache::ProtocolResponseCache()
+    : max_size_(0),
+      size_(0),
+      hits_(0),
+      misses_(0),
+      evictions_(0) {
+}
+
+ProtocolResponseCache::~ProtocolResponseCache() {
+}
+
+// static
+bool ProtocolResponseCache::ReadHeaders(const base::DictionaryValue& options,
+                                        Response* response) {
+  const base::Value* value = nullptr;
+  const base::DictionaryValue* headers = nullptr;
+  if (!options.Get("headers", &value) ||
+      value->IsType(base::Value::TYPE_NULL))
+    return true;
+  if (!value->GetAsDictionary(&headers))
+    return false;
+
+  for (base::DictionaryValue::Iterator it(*headers); !it.IsAtEnd();
+       it.Advance()) {
+    const std::string& name = it.key();
+    std::string value;
+    if (!it.value().GetAsString(&value) ||
+        !net::HttpUtil::IsValidHeaderName(name) ||
+        !net::HttpUtil::IsValidHeaderValue(value) ||
+        base::LowerCaseEqualsASCII(name, "content-type") ||
+        base::LowerCaseEqualsASCII(name, "content-length"))
+      return false;
+
+    if (base::LowerCaseEqualsASCII(name, "cache-control")) {
+      response->cache_control = value;
+    } else if (base::LowerCaseEqualsASCII(name, "etag")) {
+      if (!IsValidETag(value))
+        return false;
+      response->etag = value;
+    }
+    response->headers.push_back(std::make_pair(name, value));
+  }
+  return true;
+}
+
+// static
+void ProtocolResponseCache::AddHeaders(const Response& response,
+                                       net::HttpResponseHeaders* headers) {
+  for (const auto& header : response.headers)
+    headers->AddHeader(header.first + ": " + header.second);
+}
+
+void ProtocolResponseCache::SetMaxSize(size_t max_size) {
+  max_size_ = max_size;
+  while (size_ > max_size_) {
+    Remove(entries_.find(lru_.back()));
+    ++evictions_;
+  }
+}
+
+net::URLRequestJob* ProtocolResponseCache::MaybeCreateJob(
+    net::URLRequest* request,
+    net::NetworkDelegate* network_delegate) {
+  if (!enabled() || request->method() != "GET")
+    return nullptr;
+
+  auto it = entries_.find(GetCacheKey(request->url()));
+  if (it != entries_.end() && it->second.expires <= base::TimeTicks::Now()) {
+    Remove(it);
+    it = entries_.end();
+  }
+  if (it == entries_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+
+  ++hits_;
+  lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+
+  const Response& response = it->second.response;
+  std::string if_none_match;
+  if (!response.etag.empty() &&
+      request->extra_request_headers().GetHeader(kIfNoneMatch,
+                                                 &if_none_match) &&
+      MatchesETag(if_none_match, response.etag)) {
+    return new URLRequestMemoryJob(request, network_delegate,
+                                   net::HTTP_NOT_MODIFIED, std::string(),
+                                   std::string(), nullptr, response.headers);
+  }
+
+  if (!response.data)
+    return new URLRequestCachedFileJob(request, network_delegate, response);
+  return new URLRequestMemoryJob(request, network_delegate, net::HTTP_OK,
+                                 response.mime_type, response.charset,
+                                 response.data, response.headers);
+}
+
+void ProtocolResponseCache::Put(const net::URLRequest* request,
+                                const Response& response) {
+  base::TimeDelta max_age;
+  if (!enabled() || request->method() != "GET" ||
+      !GetMaxAge(response.cache_control, &max_age))
+    return;
+
+  std::string key = GetCacheKey(request->url());
+  size_t size = key.size() + response.mime_type.size() +
+                response.charset.size();
+  for (const auto& header : response.headers)
+    size += header.first.size() + header.second.size();
+  if (response.data)
+    size += response.data->size();
+  else
+    size += response.file_path.value().size();
+  if (size > max_size_)
+    return;
+
+  auto it = entries_.find(key);
+  if (it != entries_.end())
+    Remove(it);
+
+  Entry& entry = entries_[key];
+  entry.response = response;
+  entry.expires = base::TimeTicks::Now() + max_age;
+  entry.size = size;
+  lru_.push_front(key);
+  entry.lru_position = lru_.begin();
+  size_ += size;
+
+  while (size_ > max_size_) {
+    Remove(entries_.find(lru_.back()));
+    ++evictions_;
+  }
+}
+
+void ProtocolResponseCache::Invalidate(const std::string& prefix) {
+  auto it = entries_.lower_bound(prefix);
+  while (it != entries_.end() &&
+         base::StartsWith(it->first, prefix, base::CompareCase::SENSITIVE))
+    Remove(it++);
+}
+
+std::unique_ptr<base::DictionaryValue> ProtocolResponseCache::GetStats()
+    const {
+  std::unique_ptr<base::DictionaryValue> stats(new base::DictionaryValue);
+  uint64_t requests = hits_ + misses_;
+  stats->SetDouble("hits", hits_);
+  stats->SetDouble("misses", misses_);
+  stats->SetDouble("hitRate",
+                   requests ? static_cast<double>(hits_) / requests : 0);
+  stats->SetDouble("evictions", evictions_);
+  stats->SetDouble("entries", entries_.size());
+  stats->SetDouble("size", size_);
+  stats->SetDouble("maxSize", max_size_);
+  return stats;
+}
+
+void ProtocolResponseCache::Remove(std::map<std::string, Entry>::iterator it) {
+  size_ -= it->second.size;
+  lru_.erase(it->second.lru_position);
+  entries_.erase(it);
+}
+
+}  // namespace atom
@@ -0,0 +1,126 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_PROTOCOL_RESPONSE_CACHE_H_
+#define ATOM_BROWSER_NET_PROTOCOL_RESPONSE_CACHE_H_
+
+#include <stdint.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/time/time.h"
+
+namespace base {
+class DictionaryValue;
+}
+
+namespace net {
+class HttpResponseHeaders;
+class NetworkDelegate;
+class URLRequest;
+class URLRequestJob;
+}
+
+namespace atom {
+
+// Keeps the responses of JavaScript protocol handlers in memory, so repeated
+// requests of the same URLs are answered on the IO thread.
+//
+// Only responses to GET requests that the handler sent with a "max-age"
+// Cache-Control header are stored, and they are served until they expire or
+// are invalidated. The least recently used responses are evicted when the
+// cache is full. It can only be used on the IO thread.
+class ProtocolResponseCache
+    : public base::RefCountedThreadSafe<ProtocolResponseCache> {
+ public:
+  struct Response {
+    Response();
+    Response(const Response& other);
+    ~Response();
+
+    std::string mime_type;
+    std::string charset;
+    // The body, or the path of the file that is sent as body.
+    scoped_refptr<base::RefCountedMemory> data;
+    base::FilePath file_path;
+    // The headers set by the handler, and the values of its Cache-Control
+    // and ETag headers.
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string cache_control;
+    std::string etag;
+  };
+
+  ProtocolResponseCache();
+
+  // Reads the "headers" of |options| passed by the handler. Returns false
+  // when one of them is invalid, or is one of Content-Type and Content-Length
+  // that the job sets by itself.
+  static bool ReadHeaders(const base::DictionaryValue& options,
+                          Response* response);
+
+  // Adds the headers of |response| set by the handler to |headers|.
+  static void AddHeaders(const Response& response,
+                         net::HttpResponseHeaders* headers);
+
+  // The cache is disabled when |max_size| is 0, which is the default.
+  void SetMaxSize(size_t max_size);
+  bool enabled() const { return max_size_ > 0; }
+
+  // Returns a job that sends the cached response of |request|, or nullptr
+  // when there is none.
+  net::URLRequestJob* MaybeCreateJob(net::URLRequest* request,
+                                     net::NetworkDelegate* network_delegate);
+
+  // Stores |response| of |request| if its Cache-Control allows it.
+  void Put(const net::URLRequest* request, const Response& response);
+
+  // Removes the responses of URLs that start with |prefix|.
+  void Invalidate(const std::string& prefix);
+
+  std::unique_ptr<base::DictionaryValue> GetStats() const;
+
+ private:
+  friend class base::RefCountedThreadSafe<ProtocolResponseCache>;
+
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    Response response;
+    base::TimeTicks expires;
+    size_t size;
+    std::list<std::string>::iterator lru_position;
+  };
+
+  ~ProtocolResponseCache();
+
+  void Remove(std::map<std::string, Entry>::iterator it);
+
+  size_t max_size_;
+  size_t size_;
+
+  // Keyed by URL, so the URLs with the same prefix are next to each other.
+  std::map<std::string, Entry> entries_;
+  // The URLs of |entries_|, the most recently used first.
+  std::list<std::string> lru_;
+
+  uint64_t hits_;
+  uint64_t misses_;
+  uint64_t evictions_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProtocolResponseCache);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_PROTOCOL_RESPONSE_CACHE_H_
@@ -0,0 +1,127 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/request_details.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_headers.h"
+
+namespace atom {
+
+RequestEventCounters::RequestEventCounters()
+    : dispatched(0),
+      lazy_fields(0),
+      materialized_fields(0) {
+}
+
+RequestEventStats::RequestEventStats() {
+}
+
+RequestEventStats::~RequestEventStats() {
+}
+
+void RequestEventStats::RecordDispatch(const char* event,
+                                       size_t lazy_fields,
+                                       base::TimeDelta latency) {
+  base::AutoLock auto_lock(lock_);
+  RequestEventCounters& counters = counters_[event];
+  counters.dispatched++;
+  counters.lazy_fields += lazy_fields;
+  counters.total_latency += latency;
+  counters.max_latency = std::max(counters.max_latency, latency);
+}
+
+void RequestEventStats::RecordMaterialize(const char* event) {
+  base::AutoLock auto_lock(lock_);
+  counters_[event].materialized_fields++;
+}
+
+std::map<std::string, RequestEventCounters>
+RequestEventStats::GetCounters() const {
+  base::AutoLock auto_lock(lock_);
+  return counters_;
+}
+
+RequestDetails::RequestDetails(const char* event,
+                               scoped_refptr<RequestEventStats> stats)
+    : event_(event),
+      stats_(stats),
+      creation_time_(base::TimeTicks::Now()) {
+}
+
+RequestDetails::~RequestDetails() {
+}
+
+void RequestDetails::SetRequestHeaders(
+    const net::HttpRequestHeaders& headers) {
+  request_headers_.reset(new net::HttpRequestHeaders);
+  request_headers_->CopyFrom(headers);
+}
+
+void RequestDetails::SetResponseHeaders(
+    const net::HttpResponseHeaders* headers) {
+  if (!headers)
+    return;
+
+  // The headers of a request can still change after this, so keep a copy.
+  response_headers_ = new net::HttpResponseHeaders(headers->raw_headers());
+  fields_.SetString("statusLine", headers->GetStatusLine());
+  fields_.SetInteger("statusCode", headers->response_code());
+}
+
+void RequestDetails::SetUploadData(
+    std::unique_ptr<base::Value> upload_data) {
+  upload_data_ = std::move(upload_data);
+}
+
+std::unique_ptr<base::DictionaryValue>
+RequestDetails::GetRequestHeaders() const {
+  stats_->RecordMaterialize(event_);
+
+  std::unique_ptr<base::DictionaryValue> dict(new base::DictionaryValue);
+  net::HttpRequestHeaders::Iterator it(*request_headers_);
+  while (it.GetNext())
+    dict->SetString(it.name(), it.value());
+  return dict;
+}
+
+std::unique_ptr<base::DictionaryValue>
+RequestDetails::GetResponseHeaders() const {
+  stats_->RecordMaterialize(event_);
+
+  std::unique_ptr<base::DictionaryValue> dict(new base::DictionaryValue);
+  size_t iter = 0;
+  std::string key;
+  std::string value;
+  while (response_headers_->EnumerateHeaderLines(&iter, &key, &value)) {
+    if (dict->HasKey(key)) {
+      base::ListValue* values = nullptr;
+      if (dict->GetList(key, &values))
+        values->AppendString(value);
+    } else {
+      std::unique_ptr<base::ListValue> values(new base::ListValue);
+      values->AppendString(value);
+      dict->Set(key, std::move(values));
+    }
+  }
+  return dict;
+}
+
+const base::Value* RequestDetails::GetUploadData() const {
+  stats_->RecordMaterialize(event_);
+  return upload_data_.get();
+}
+
+void RequestDetails::RecordDispatch() const {
+  size_t lazy_fields = (request_headers_ ? 1 : 0) +
+                       (response_headers_ ? 1 : 0) +
+                       (upload_data_ ? 1 : 0);
+  stats_->RecordDispatch(event_, lazy_fields,
+                         base::TimeTicks::Now() - creation_time_);
+}
+
+}  // namespace atom
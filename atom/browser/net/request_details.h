@@ -0,0 +1,111 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_REQUEST_DETAILS_H_
+#define ATOM_BROWSER_NET_REQUEST_DETAILS_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+#include "base/values.h"
+
+namespace net {
+class HttpRequestHeaders;
+class HttpResponseHeaders;
+}
+
+namespace atom {
+
+// Counters of the details objects created for one webRequest event.
+struct RequestEventCounters {
+  RequestEventCounters();
+
+  // Details objects passed to listeners.
+  uint64_t dispatched;
+  // Fields that were kept in native form to be converted on access, and the
+  // ones that JS actually read.
+  uint64_t lazy_fields;
+  uint64_t materialized_fields;
+  // Time from creating the details on the IO thread to running the listener.
+  base::TimeDelta total_latency;
+  base::TimeDelta max_latency;
+};
+
+// Collects the counters of all events of a network delegate, can be used on
+// any thread.
+class RequestEventStats
+    : public base::RefCountedThreadSafe<RequestEventStats> {
+ public:
+  RequestEventStats();
+
+  void RecordDispatch(const char* event,
+                      size_t lazy_fields,
+                      base::TimeDelta latency);
+  void RecordMaterialize(const char* event);
+
+  std::map<std::string, RequestEventCounters> GetCounters() const;
+
+ private:
+  friend class base::RefCountedThreadSafe<RequestEventStats>;
+  ~RequestEventStats();
+
+  mutable base::Lock lock_;
+  std::map<std::string, RequestEventCounters> counters_;
+
+  DISALLOW_COPY_AND_ASSIGN(RequestEventStats);
+};
+
+// The details of a request passed to a webRequest listener.
+//
+// Scalar fields are filled on the IO thread. Headers and upload data are kept
+// in their native form, and only converted to values when the listener reads
+// them.
+class RequestDetails : public base::RefCountedThreadSafe<RequestDetails> {
+ public:
+  RequestDetails(const char* event, scoped_refptr<RequestEventStats> stats);
+
+  const base::DictionaryValue& fields() const { return fields_; }
+  base::DictionaryValue* mutable_fields() { return &fields_; }
+
+  void SetRequestHeaders(const net::HttpRequestHeaders& headers);
+  void SetResponseHeaders(const net::HttpResponseHeaders* headers);
+  void SetUploadData(std::unique_ptr<base::Value> upload_data);
+
+  bool has_request_headers() const { return !!request_headers_; }
+  bool has_response_headers() const { return !!response_headers_; }
+  bool has_upload_data() const { return !!upload_data_; }
+
+  // Converters of the lazy fields, which are counted as materialized.
+  std::unique_ptr<base::DictionaryValue> GetRequestHeaders() const;
+  std::unique_ptr<base::DictionaryValue> GetResponseHeaders() const;
+  const base::Value* GetUploadData() const;
+
+  // Called on the UI thread right before the listener runs.
+  void RecordDispatch() const;
+
+ private:
+  friend class base::RefCountedThreadSafe<RequestDetails>;
+  ~RequestDetails();
+
+  const char* event_;
+  scoped_refptr<RequestEventStats> stats_;
+  base::TimeTicks creation_time_;
+
+  base::DictionaryValue fields_;
+  std::unique_ptr<net::HttpRequestHeaders> request_headers_;
+  scoped_refptr<net::HttpResponseHeaders> response_headers_;
+  std::unique_ptr<base::Value> upload_data_;
+
+  DISALLOW_COPY_AND_ASSIGN(RequestDetails);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_REQUEST_DETAILS_H_
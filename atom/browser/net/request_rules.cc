@@ -0,0 +1,256 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/request_rules.h"
+
+#include "atom/browser/net/atom_network_delegate.h"
+#include "base/values.h"
+#include "content/public/browser/resource_request_info.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_util.h"
+#include "net/url_request/url_request.h"
+
+namespace atom {
+
+namespace {
+
+bool ReadStringList(const base::DictionaryValue& dict,
+                    const std::string& key,
+                    std::vector<std::string>* out,
+                    std::string* error) {
+  const base::ListValue* list = nullptr;
+  if (!dict.HasKey(key))
+    return true;
+  if (!dict.GetList(key, &list)) {
+    *error = "'" + key + "' must be an Array";
+    return false;
+  }
+  for (size_t i = 0; i < list->GetSize(); ++i) {
+    std::string value;
+    if (!list->GetString(i, &value)) {
+      *error = "'" + key + "' must only contain strings";
+      return false;
+    }
+    out->push_back(value);
+  }
+  return true;
+}
+
+// Reads { set: { name: value }, remove: [name] } from |dict[key]|.
+bool ReadHeaderChanges(
+    const base::DictionaryValue& dict,
+    const std::string& key,
+    std::vector<std::pair<std::string, std::string>>* set_headers,
+    std::vector<std::string>* remove_headers,
+    std::string* error) {
+  const base::DictionaryValue* changes = nullptr;
+  if (!dict.HasKey(key))
+    return true;
+  if (!dict.GetDictionary(key, &changes)) {
+    *error = "'" + key + "' must be an Object";
+    return false;
+  }
+
+  const base::DictionaryValue* set = nullptr;
+  if (changes->GetDictionary("set", &set)) {
+    for (base::DictionaryValue::Iterator it(*set); !it.IsAtEnd();
+         it.Advance()) {
+      std::string value;
+      if (!it.value().GetAsString(&value)) {
+        *error = "Value of header '" + it.key() + "' must be a string";
+        return false;
+      }
+      if (!net::HttpUtil::IsValidHeaderName(it.key())) {
+        *error = "Invalid header name '" + it.key() + "'";
+        return false;
+      }
+      // Line breaks in the value would add other headers.
+      if (!net::HttpUtil::IsValidHeaderValue(value)) {
+        *error = "Invalid value of header '" + it.key() + "'";
+        return false;
+      }
+      set_headers->push_back(std::make_pair(it.key(), value));
+    }
+  }
+
+  if (!ReadStringList(*changes, "remove", remove_headers, error))
+    return false;
+  for (const auto& name : *remove_headers) {
+    if (!net::HttpUtil::IsValidHeaderName(name)) {
+      *error = "Invalid header name '" + name + "'";
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+RequestRules::Rule::Rule() : action(ACTION_NONE) {
+}
+
+RequestRules::Rule::~Rule() {
+}
+
+RequestRules::RequestRules() {
+}
+
+RequestRules::~RequestRules() {
+}
+
+// static
+std::unique_ptr<RequestRules> RequestRules::Create(
+    const base::ListValue& rules, std::string* error) {
+  std::unique_ptr<RequestRules> result(new RequestRules);
+  for (size_t i = 0; i < rules.GetSize(); ++i) {
+    const base::DictionaryValue* dict = nullptr;
+    if (!rules.GetDictionary(i, &dict)) {
+      *error = "Rule must be an Object";
+      return nullptr;
+    }
+
+    std::unique_ptr<Rule> rule = ParseRule(*dict, error);
+    if (!rule)
+      return nullptr;
+
+    size_t index = result->rules_.size();
+    if (rule->action != ACTION_NONE)
+      result->action_rules_.push_back(index);
+    if (!rule->set_request_headers.empty() ||
+        !rule->remove_request_headers.empty())
+      result->request_header_rules_.push_back(index);
+    if (!rule->set_response_headers.empty() ||
+        !rule->remove_response_headers.empty())
+      result->response_header_rules_.push_back(index);
+    result->rules_.push_back(std::move(rule));
+  }
+  return result;
+}
+
+RequestRules::Action RequestRules::GetAction(const net::URLRequest* request,
+                                             GURL* redirect_url) const {
+  for (size_t index : action_rules_) {
+    const Rule& rule = *rules_[index];
+    if (!Matches(rule, request))
+      continue;
+    // Do not redirect a request to itself, which would never end.
+    if (rule.action == ACTION_REDIRECT && rule.redirect_url == request->url())
+      continue;
+
+    if (rule.action == ACTION_REDIRECT)
+      *redirect_url = rule.redirect_url;
+    return rule.action;
+  }
+  return ACTION_NONE;
+}
+
+void RequestRules::ModifyRequestHeaders(
+    const net::URLRequest* request,
+    net::HttpRequestHeaders* headers) const {
+  for (size_t index : request_header_rules_) {
+    const Rule& rule = *rules_[index];
+    if (!Matches(rule, request))
+      continue;
+
+    for (const auto& name : rule.remove_request_headers)
+      headers->RemoveHeader(name);
+    for (const auto& header : rule.set_request_headers)
+      headers->SetHeader(header.first, header.second);
+  }
+}
+
+bool RequestRules::ModifyResponseHeaders(
+    const net::URLRequest* request,
+    const net::HttpResponseHeaders* original,
+    scoped_refptr<net::HttpResponseHeaders>* override) const {
+  bool modified = false;
+  for (size_t index : response_header_rules_) {
+    const Rule& rule = *rules_[index];
+    if (!Matches(rule, request))
+      continue;
+
+    if (!modified) {
+      if (!override->get())
+        *override = new net::HttpResponseHeaders(original->raw_headers());
+      modified = true;
+    }
+    for (const auto& name : rule.remove_response_headers)
+      (*override)->RemoveHeader(name);
+    for (const auto& header : rule.set_response_headers) {
+      (*override)->RemoveHeader(header.first);
+      (*override)->AddHeader(header.first + ": " + header.second);
+    }
+  }
+  return modified;
+}
+
+// static
+std::unique_ptr<RequestRules::Rule> RequestRules::ParseRule(
+    const base::DictionaryValue& dict, std::string* error) {
+  std::unique_ptr<Rule> rule(new Rule);
+
+  std::vector<std::string> urls;
+  if (!ReadStringList(dict, "urls", &urls, error))
+    return nullptr;
+  URLPatterns patterns;
+  for (const auto& url : urls) {
+    URLPattern pattern;
+    if (pattern.Parse(url) != URLPattern::PARSE_SUCCESS) {
+      *error = "Invalid URL pattern '" + url + "'";
+      return nullptr;
+    }
+    patterns.insert(pattern);
+  }
+  rule->url_patterns.SetPatterns(patterns);
+
+  std::vector<std::string> resource_types;
+  if (!ReadStringList(dict, "resourceTypes", &resource_types, error))
+    return nullptr;
+  rule->resource_types.insert(resource_types.begin(), resource_types.end());
+
+  std::string action;
+  if (!dict.GetString("action", &action)) {
+    *error = "Rule must have an 'action'";
+    return nullptr;
+  }
+  if (action == "block") {
+    rule->action = ACTION_BLOCK;
+  } else if (action == "redirect") {
+    std::string url;
+    dict.GetString("redirectURL", &url);
+    rule->redirect_url = GURL(url);
+    if (!rule->redirect_url.is_valid()) {
+      *error = "Redirect rule must have a valid 'redirectURL'";
+      return nullptr;
+    }
+    rule->action = ACTION_REDIRECT;
+  } else if (action == "modifyHeaders") {
+    if (!ReadHeaderChanges(dict, "requestHeaders", &rule->set_request_headers,
+                           &rule->remove_request_headers, error) ||
+        !ReadHeaderChanges(dict, "responseHeaders",
+                           &rule->set_response_headers,
+                           &rule->remove_response_headers, error))
+      return nullptr;
+  } else {
+    *error = "Unknown rule action '" + action + "'";
+    return nullptr;
+  }
+  return rule;
+}
+
+// static
+bool RequestRules::Matches(const Rule& rule, const net::URLRequest* request) {
+  if (!rule.resource_types.empty()) {
+    auto info = content::ResourceRequestInfo::ForRequest(request);
+    const char* type = info ? ResourceTypeToString(info->GetResourceType())
+                            : "other";
+    if (!rule.resource_types.count(type))
+      return false;
+  }
+  return rule.url_patterns.empty() ||
+         rule.url_patterns.MatchesURL(request->url());
+}
+
+}  // namespace atom
@@ -0,0 +1,100 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_REQUEST_RULES_H_
+#define ATOM_BROWSER_NET_REQUEST_RULES_H_
+
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "atom/browser/net/url_pattern_matcher.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "url/gurl.h"
+
+namespace base {
+class DictionaryValue;
+class ListValue;
+}
+
+namespace net {
+class HttpRequestHeaders;
+class HttpResponseHeaders;
+class URLRequest;
+}
+
+namespace atom {
+
+// Declarative rules that block, redirect or modify the headers of requests,
+// evaluated by the network delegate on the IO thread without calling into JS.
+class RequestRules {
+ public:
+  enum Action {
+    ACTION_NONE,
+    ACTION_BLOCK,
+    ACTION_REDIRECT,
+  };
+
+  ~RequestRules();
+
+  // Parses the rules passed to webRequest.setRules, returns nullptr and sets
+  // |error| when any rule is invalid.
+  static std::unique_ptr<RequestRules> Create(const base::ListValue& rules,
+                                              std::string* error);
+
+  // Returns the action of the first block or redirect rule matching
+  // |request|, |redirect_url| is set for ACTION_REDIRECT.
+  Action GetAction(const net::URLRequest* request, GURL* redirect_url) const;
+
+  // Applies all matching request header rules to |headers|.
+  void ModifyRequestHeaders(const net::URLRequest* request,
+                            net::HttpRequestHeaders* headers) const;
+
+  // Applies all matching response header rules to a copy of |original|,
+  // which is stored in |override|. Returns false when no rule matches.
+  bool ModifyResponseHeaders(
+      const net::URLRequest* request,
+      const net::HttpResponseHeaders* original,
+      scoped_refptr<net::HttpResponseHeaders>* override) const;
+
+ private:
+  using HeaderList = std::vector<std::pair<std::string, std::string>>;
+
+  struct Rule {
+    Rule();
+    ~Rule();
+
+    URLPatternMatcher url_patterns;
+    std::set<std::string> resource_types;
+    Action action;
+    GURL redirect_url;
+    HeaderList set_request_headers;
+    std::vector<std::string> remove_request_headers;
+    HeaderList set_response_headers;
+    std::vector<std::string> remove_response_headers;
+  };
+
+  RequestRules();
+
+  static std::unique_ptr<Rule> ParseRule(const base::DictionaryValue& dict,
+                                         std::string* error);
+  static bool Matches(const Rule& rule, const net::URLRequest* request);
+
+  std::vector<std::unique_ptr<Rule>> rules_;
+
+  // Indexes into |rules_| by the stage the rules apply at, so a stage only
+  // tests the rules that can change it.
+  std::vector<size_t> action_rules_;
+  std::vector<size_t> request_header_rules_;
+  std::vector<size_t> response_header_rules_;
+
+  DISALLOW_COPY_AND_ASSIGN(RequestRules);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_REQUEST_RULES_H_
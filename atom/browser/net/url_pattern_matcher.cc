@@ -0,0 +1,181 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/url_pattern_matcher.h"
+
+#include <string>
+
+#include "url/gurl.h"
+
+namespace atom {
+
+namespace {
+
+const char kAnyScheme[] = "*";
+
+// Hosts are compared without the trailing dot of a fully qualified name, a
+// looser key only adds candidates that get rejected on verification.
+base::StringPiece TrimHost(base::StringPiece host) {
+  if (host.ends_with("."))
+    host.remove_suffix(1);
+  return host;
+}
+
+// Removes the last label from |host| and returns it.
+base::StringPiece PopLabel(base::StringPiece* host) {
+  size_t dot = host->rfind('.');
+  if (dot == base::StringPiece::npos) {
+    base::StringPiece label = *host;
+    *host = base::StringPiece();
+    return label;
+  }
+  base::StringPiece label = host->substr(dot + 1);
+  *host = host->substr(0, dot);
+  return label;
+}
+
+// Returns the part of the pattern's path that every matching path starts
+// with.
+base::StringPiece GetLiteralPathPrefix(const URLPattern& pattern) {
+  if (pattern.match_all_urls())
+    return base::StringPiece();
+
+  base::StringPiece path(pattern.path());
+  base::StringPiece prefix = path.substr(0, path.find_first_of("*?"));
+  // "/foo/*" also matches "/foo".
+  if (prefix.ends_with("/") && path.substr(prefix.size()) == "*")
+    prefix.remove_suffix(1);
+  return prefix;
+}
+
+}  // namespace
+
+URLPatternMatcher::PathNode::PathNode() {
+}
+
+URLPatternMatcher::PathNode::~PathNode() {
+}
+
+URLPatternMatcher::HostNode::HostNode() {
+}
+
+URLPatternMatcher::HostNode::~HostNode() {
+}
+
+URLPatternMatcher::URLPatternMatcher() {
+}
+
+URLPatternMatcher::URLPatternMatcher(const URLPatterns& patterns) {
+  SetPatterns(patterns);
+}
+
+URLPatternMatcher::~URLPatternMatcher() {
+}
+
+void URLPatternMatcher::SetPatterns(const URLPatterns& patterns) {
+  schemes_.clear();
+  // The tries keep pieces of the patterns' hosts, so |patterns_| must not be
+  // resized after this.
+  patterns_.assign(patterns.begin(), patterns.end());
+  for (size_t i = 0; i < patterns_.size(); ++i)
+    AddPattern(i);
+}
+
+bool URLPatternMatcher::MatchesURL(const GURL& url) const {
+  if (patterns_.empty())
+    return false;
+
+  // Follow URLPattern::MatchesURL, which matches filesystem URLs by their
+  // inner URL.
+  const GURL* test_url = &url;
+  std::string path = url.PathForRequest();
+  if (url.inner_url()) {
+    if (!url.SchemeIsFileSystem())
+      return false;
+    test_url = url.inner_url();
+    path = test_url->path() + path;
+  }
+
+  base::StringPiece host = TrimHost(test_url->host_piece());
+  for (const char* scheme : { test_url->scheme().c_str(), kAnyScheme }) {
+    auto iter = schemes_.find(scheme);
+    if (iter != schemes_.end() &&
+        MatchesHost(iter->second.get(), host, path, url))
+      return true;
+  }
+  return false;
+}
+
+void URLPatternMatcher::AddPattern(size_t index) {
+  const URLPattern& pattern = patterns_[index];
+  const std::string& scheme =
+      pattern.match_all_urls() ? kAnyScheme : pattern.scheme();
+  std::unique_ptr<HostNode>& root = schemes_[scheme];
+  if (!root)
+    root.reset(new HostNode);
+
+  // <all_urls> matches any host, like "*://*/*".
+  base::StringPiece host;
+  if (!pattern.match_all_urls())
+    host = TrimHost(pattern.host());
+
+  HostNode* node = root.get();
+  while (!host.empty()) {
+    std::unique_ptr<HostNode>& child = node->children[PopLabel(&host)];
+    if (!child)
+      child.reset(new HostNode);
+    node = child.get();
+  }
+
+  PathNode* path_node = pattern.match_subdomains() || pattern.match_all_urls()
+                            ? &node->subdomains
+                            : &node->exact;
+  for (char c : GetLiteralPathPrefix(pattern)) {
+    std::unique_ptr<PathNode>& child = path_node->children[c];
+    if (!child)
+      child.reset(new PathNode);
+    path_node = child.get();
+  }
+  path_node->patterns.push_back(index);
+}
+
+bool URLPatternMatcher::MatchesHost(const HostNode* root,
+                                    base::StringPiece host,
+                                    const std::string& path,
+                                    const GURL& url) const {
+  const HostNode* node = root;
+  while (true) {
+    if (MatchesPath(&node->subdomains, path, url))
+      return true;
+    if (host.empty())
+      return MatchesPath(&node->exact, path, url);
+
+    auto iter = node->children.find(PopLabel(&host));
+    if (iter == node->children.end())
+      return false;
+    node = iter->second.get();
+  }
+}
+
+bool URLPatternMatcher::MatchesPath(const PathNode* root,
+                                    const std::string& path,
+                                    const GURL& url) const {
+  const PathNode* node = root;
+  size_t i = 0;
+  while (true) {
+    for (size_t index : node->patterns) {
+      if (patterns_[index].MatchesURL(url))
+        return true;
+    }
+    if (i == path.size())
+      return false;
+
+    auto iter = node->children.find(path[i++]);
+    if (iter == node->children.end())
+      return false;
+    node = iter->second.get();
+  }
+}
+
+}  // namespace atom
@@ -0,0 +1,87 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_URL_PATTERN_MATCHER_H_
+#define ATOM_BROWSER_NET_URL_PATTERN_MATCHER_H_
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "extensions/common/url_pattern.h"
+
+class GURL;
+
+namespace atom {
+
+using URLPatterns = std::set<URLPattern>;
+
+// Indexes a set of URLPatterns so a URL only gets tested against the patterns
+// that could possibly match it.
+//
+// Patterns are bucketed by scheme, then stored in a trie of reversed host
+// labels, and under each host in a trie of the literal prefix of their paths.
+// Looking up a URL walks its host labels and path characters once, and the
+// few candidates found are verified with URLPattern::MatchesURL, so the
+// result is always the same as testing every pattern.
+class URLPatternMatcher {
+ public:
+  URLPatternMatcher();
+  explicit URLPatternMatcher(const URLPatterns& patterns);
+  ~URLPatternMatcher();
+
+  // Replaces the indexed patterns with |patterns|.
+  void SetPatterns(const URLPatterns& patterns);
+
+  // Whether |url| matches any of the patterns.
+  bool MatchesURL(const GURL& url) const;
+
+  bool empty() const { return patterns_.empty(); }
+  size_t size() const { return patterns_.size(); }
+
+ private:
+  struct PathNode {
+    PathNode();
+    ~PathNode();
+
+    std::map<char, std::unique_ptr<PathNode>> children;
+    // Patterns whose literal path prefix ends at this node.
+    std::vector<size_t> patterns;
+  };
+
+  struct HostNode {
+    HostNode();
+    ~HostNode();
+
+    // Keyed by labels that point into the hosts of |patterns_|.
+    std::map<base::StringPiece, std::unique_ptr<HostNode>> children;
+    // Patterns for exactly this host.
+    PathNode exact;
+    // Patterns for this host and all of its subdomains.
+    PathNode subdomains;
+  };
+
+  void AddPattern(size_t index);
+  bool MatchesHost(const HostNode* root,
+                   base::StringPiece host,
+                   const std::string& path,
+                   const GURL& url) const;
+  bool MatchesPath(const PathNode* root,
+                   const std::string& path,
+                   const GURL& url) const;
+
+  std::vector<URLPattern> patterns_;
+  // Keyed by scheme, patterns matching any scheme are under "*".
+  std::map<std::string, std::unique_ptr<HostNode>> schemes_;
+
+  DISALLOW_COPY_AND_ASSIGN(URLPatternMatcher);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_URL_PATTERN_MATCHER_H_
@@ -29,6 +29,10 @@ void URLRequestAsyncAsarJob::StartAsync(std::unique_ptr<base::Value> options) {
     NotifyStartError(net::URLRequestStatus(
           net::URLRequestStatus::FAILED, net::ERR_NOT_IMPLEMENTED));
   } else {
+    ProtocolResponseCache::Response response;
+    response.file_path = base::FilePath(file_path);
+    CacheResponse(response);
+
     asar::URLRequestAsarJob::Initialize(
         content::BrowserThread::GetBlockingPool()->
             GetTaskRunnerWithShutdownBehavior(
@@ -43,6 +47,7 @@ void URLRequestAsyncAsarJob::GetResponseInfo(net::HttpResponseInfo* info) {
   auto* headers = new net::HttpResponseHeaders(status);
 
   headers->AddHeader(kCORSHeader);
+  AddCacheHeaders(headers);
   info->headers = headers;
 }
 
@@ -63,6 +63,13 @@ void URLRequestBufferJob::StartAsync(std::unique_ptr<base::Value> options) {
       reinterpret_cast<const unsigned char*>(binary->GetBuffer()),
       binary->GetSize());
   status_code_ = net::HTTP_OK;
+
+  ProtocolResponseCache::Response response;
+  response.mime_type = mime_type_;
+  response.charset = charset_;
+  response.data = data_;
+  CacheResponse(response);
+
   net::URLRequestSimpleJob::Start();
 }
 
@@ -83,6 +90,7 @@ void URLRequestBufferJob::GetResponseInfo(net::HttpResponseInfo* info) {
     headers->AddHeader(content_type_header);
   }
 
+  AddCacheHeaders(headers);
   info->headers = headers;
 }
 
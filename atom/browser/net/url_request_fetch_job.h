@@ -29,6 +29,8 @@ class URLRequestFetchJob : public JsAsker<net::URLRequestJob>,
   // JsAsker:
   void BeforeStartInUI(v8::Isolate*, v8::Local<v8::Value>) override;
   void StartAsync(std::unique_ptr<base::Value> options) override;
+  // The headers come from the fetched response.
+  bool UsesResponseHeaders() const override { return false; }
 
   // net::URLRequestJob:
   void Kill() override;
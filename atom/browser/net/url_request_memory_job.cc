@@ -0,0 +1,71 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/url_request_memory_job.h"
+
+#include "atom/common/atom_constants.h"
+#include "base/strings/string_number_conversions.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_response_info.h"
+#include "net/http/http_status_code.h"
+
+namespace atom {
+
+URLRequestMemoryJob::URLRequestMemoryJob(
+    net::URLRequest* request,
+    net::NetworkDelegate* network_delegate,
+    int status_code,
+    const std::string& mime_type,
+    const std::string& charset,
+    scoped_refptr<base::RefCountedMemory> data,
+    const Headers& headers)
+    : net::URLRequestSimpleJob(request, network_delegate),
+      status_code_(status_code),
+      mime_type_(mime_type),
+      charset_(charset),
+      data_(data ? data : new base::RefCountedString),
+      headers_(headers) {
+}
+
+URLRequestMemoryJob::~URLRequestMemoryJob() {
+}
+
+void URLRequestMemoryJob::GetResponseInfo(net::HttpResponseInfo* info) {
+  std::string status("HTTP/1.1 ");
+  status.append(base::IntToString(status_code_));
+  status.append(" ");
+  status.append(net::GetHttpReasonPhrase(
+      static_cast<net::HttpStatusCode>(status_code_)));
+  status.append("\0\0", 2);
+  auto* headers = new net::HttpResponseHeaders(status);
+
+  headers->AddHeader(kCORSHeader);
+
+  if (!mime_type_.empty()) {
+    std::string content_type_header(net::HttpRequestHeaders::kContentType);
+    content_type_header.append(": ");
+    content_type_header.append(mime_type_);
+    headers->AddHeader(content_type_header);
+  }
+
+  for (const auto& header : headers_)
+    headers->AddHeader(header.first + ": " + header.second);
+
+  info->headers = headers;
+}
+
+int URLRequestMemoryJob::GetRefCountedData(
+    std::string* mime_type,
+    std::string* charset,
+    scoped_refptr<base::RefCountedMemory>* data,
+    const net::CompletionCallback& callback) const {
+  *mime_type = mime_type_;
+  *charset = charset_;
+  *data = data_;
+  return net::OK;
+}
+
+}  // namespace atom
@@ -0,0 +1,55 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_URL_REQUEST_MEMORY_JOB_H_
+#define ATOM_BROWSER_NET_URL_REQUEST_MEMORY_JOB_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/memory/ref_counted_memory.h"
+#include "net/url_request/url_request_simple_job.h"
+
+namespace atom {
+
+// Sends a response kept in memory, which does not need the JavaScript
+// handler of the protocol.
+class URLRequestMemoryJob : public net::URLRequestSimpleJob {
+ public:
+  using Headers = std::vector<std::pair<std::string, std::string>>;
+
+  URLRequestMemoryJob(net::URLRequest* request,
+                      net::NetworkDelegate* network_delegate,
+                      int status_code,
+                      const std::string& mime_type,
+                      const std::string& charset,
+                      scoped_refptr<base::RefCountedMemory> data,
+                      const Headers& headers);
+
+  // URLRequestJob:
+  void GetResponseInfo(net::HttpResponseInfo* info) override;
+
+  // URLRequestSimpleJob:
+  int GetRefCountedData(
+      std::string* mime_type,
+      std::string* charset,
+      scoped_refptr<base::RefCountedMemory>* data,
+      const net::CompletionCallback& callback) const override;
+
+ private:
+  ~URLRequestMemoryJob() override;
+
+  int status_code_;
+  std::string mime_type_;
+  std::string charset_;
+  scoped_refptr<base::RefCountedMemory> data_;
+  Headers headers_;
+
+  DISALLOW_COPY_AND_ASSIGN(URLRequestMemoryJob);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_URL_REQUEST_MEMORY_JOB_H_
@@ -0,0 +1,524 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/url_request_stream_job.h"
+
+#include <algorithm>
+#include <string>
+
+#include "atom/common/atom_constants.h"
+#include "atom/common/native_mate_converters/callback.h"
+#include "atom/common/node_includes.h"
+#include "base/format_macros.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
+#include "native_mate/dictionary.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_byte_range.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_status_code.h"
+#include "net/http/http_util.h"
+
+using content::BrowserThread;
+
+namespace atom {
+
+namespace {
+
+// The stream is paused when more data than this is waiting to be read, and
+// resumed when less than half of it is left.
+const size_t kMaxBufferedBytes = 256 * 1024;
+
+}  // namespace
+
+// Reads the stream on the UI thread and passes its data to the job.
+class URLRequestStreamJob::StreamReader
+    : public base::RefCountedThreadSafe<StreamReader,
+                                        BrowserThread::DeleteOnUIThread> {
+ public:
+  explicit StreamReader(base::WeakPtr<URLRequestStreamJob> job)
+      : isolate_(nullptr), job_(job) {}
+
+  // Starts reading |stream|, returns false if it is not a readable stream.
+  bool Attach(v8::Isolate* isolate, v8::Local<v8::Object> stream) {
+    DCHECK_CURRENTLY_ON(BrowserThread::UI);
+    for (const char* method : {"on", "pause", "resume", "removeListener"}) {
+      v8::Local<v8::Value> value;
+      if (!stream->Get(isolate->GetCurrentContext(),
+                       mate::StringToV8(isolate, method)).ToLocal(&value) ||
+          !value->IsFunction())
+        return false;
+    }
+
+    isolate_ = isolate;
+    context_.Reset(isolate, isolate->GetCurrentContext());
+    stream_.Reset(isolate, stream);
+    on_data_.Reset(isolate, mate::ConvertToV8(
+        isolate, base::Bind(&StreamReader::OnData, this)));
+    on_end_.Reset(isolate, mate::ConvertToV8(
+        isolate, base::Bind(&StreamReader::OnEnd, this)));
+    on_error_.Reset(isolate, mate::ConvertToV8(
+        isolate, base::Bind(&StreamReader::OnError, this)));
+    on_close_.Reset(isolate, mate::ConvertToV8(
+        isolate, base::Bind(&StreamReader::OnClose, this)));
+    CallMethod("on", "error", on_error_);
+    CallMethod("on", "end", on_end_);
+    CallMethod("on", "close", on_close_);
+    // Adding the "data" listener starts the flowing of the stream.
+    CallMethod("on", "data", on_data_);
+    return true;
+  }
+
+  void Pause() {
+    CallMethod("pause");
+  }
+
+  void Resume() {
+    CallMethod("resume");
+  }
+
+  // Stops reading the stream, it is destroyed when |destroy| is true and it
+  // supports that, which closes the underlying resource early.
+  void Close(bool destroy) {
+    DCHECK_CURRENTLY_ON(BrowserThread::UI);
+    if (stream_.IsEmpty())
+      return;
+
+    CallMethod("removeListener", "data", on_data_);
+    CallMethod("removeListener", "end", on_end_);
+    CallMethod("removeListener", "close", on_close_);
+    // The "error" listener is kept, since an error emitted without listeners
+    // would be thrown in the main process.
+    if (destroy)
+      CallMethod("destroy");
+
+    // The listeners keep a reference to this, so the handles must be reset to
+    // let the stream be garbage collected.
+    stream_.Reset();
+    on_data_.Reset();
+    on_end_.Reset();
+    on_error_.Reset();
+    on_close_.Reset();
+    context_.Reset();
+  }
+
+ private:
+  friend struct BrowserThread::DeleteOnThread<BrowserThread::UI>;
+  friend class base::DeleteHelper<StreamReader>;
+
+  ~StreamReader() {}
+
+  void OnData(mate::Arguments* args) {
+    v8::Local<v8::Value> chunk;
+    if (!args->GetNext(&chunk))
+      return;
+
+    scoped_refptr<net::IOBufferWithSize> buffer;
+    if (node::Buffer::HasInstance(chunk)) {
+      size_t size = node::Buffer::Length(chunk);
+      if (size == 0)
+        return;
+      buffer = new net::IOBufferWithSize(size);
+      memcpy(buffer->data(), node::Buffer::Data(chunk), size);
+    } else if (chunk->IsString()) {
+      std::string data;
+      if (!mate::ConvertFromV8(args->isolate(), chunk, &data) || data.empty())
+        return;
+      buffer = new net::IOBufferWithSize(data.size());
+      memcpy(buffer->data(), data.data(), data.size());
+    } else {
+      return;
+    }
+
+    BrowserThread::PostTask(
+        BrowserThread::IO, FROM_HERE,
+        base::Bind(&URLRequestStreamJob::OnData, job_, buffer));
+  }
+
+  void OnEnd() {
+    if (stream_.IsEmpty())
+      return;
+    BrowserThread::PostTask(
+        BrowserThread::IO, FROM_HERE,
+        base::Bind(&URLRequestStreamJob::OnEnd, job_));
+    Close(false);
+  }
+
+  void OnError() {
+    if (stream_.IsEmpty())
+      return;
+    BrowserThread::PostTask(
+        BrowserThread::IO, FROM_HERE,
+        base::Bind(&URLRequestStreamJob::OnError, job_, net::ERR_FAILED));
+    Close(true);
+  }
+
+  // The stream was destroyed before it ended, so the response is truncated.
+  void OnClose() {
+    if (stream_.IsEmpty())
+      return;
+    BrowserThread::PostTask(
+        BrowserThread::IO, FROM_HERE,
+        base::Bind(&URLRequestStreamJob::OnError, job_,
+                   net::ERR_CONNECTION_CLOSED));
+    Close(false);
+  }
+
+  // Calls |method| of the stream if it has one.
+  void CallMethod(const char* method,
+                  const char* event = nullptr,
+                  const v8::Global<v8::Value>& listener =
+                      v8::Global<v8::Value>()) {
+    if (stream_.IsEmpty())
+      return;
+
+    v8::Locker locker(isolate_);
+    v8::HandleScope handle_scope(isolate_);
+    v8::Local<v8::Context> context =
+        v8::Local<v8::Context>::New(isolate_, context_);
+    v8::Context::Scope context_scope(context);
+    v8::MicrotasksScope script_scope(isolate_,
+                                     v8::MicrotasksScope::kRunMicrotasks);
+
+    v8::Local<v8::Object> stream = v8::Local<v8::Object>::New(isolate_,
+                                                              stream_);
+    v8::Local<v8::Value> function;
+    if (!stream->Get(context, mate::StringToV8(isolate_, method))
+             .ToLocal(&function) || !function->IsFunction())
+      return;
+
+    v8::Local<v8::Value> args[2];
+    int argc = 0;
+    if (event) {
+      args[argc++] = mate::StringToV8(isolate_, event);
+      args[argc++] = v8::Local<v8::Value>::New(isolate_, listener);
+    }
+    node::MakeCallback(isolate_, stream, method, argc, args);
+  }
+
+  v8::Isolate* isolate_;
+  v8::Global<v8::Context> context_;
+  v8::Global<v8::Object> stream_;
+  v8::Global<v8::Value> on_data_;
+  v8::Global<v8::Value> on_end_;
+  v8::Global<v8::Value> on_error_;
+  v8::Global<v8::Value> on_close_;
+
+  base::WeakPtr<URLRequestStreamJob> job_;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamReader);
+};
+
+URLRequestStreamJob::URLRequestStreamJob(
+    net::URLRequest* request, net::NetworkDelegate* network_delegate)
+    : JsAsker<net::URLRequestJob>(request, network_delegate),
+      error_(net::OK),
+      status_code_(net::HTTP_OK),
+      content_length_(-1),
+      bytes_to_skip_(0),
+      bytes_remaining_(-1),
+      chunk_offset_(0),
+      buffered_bytes_(0),
+      paused_(false),
+      ended_(false),
+      stream_error_(net::OK),
+      pending_buffer_size_(0),
+      weak_factory_(this) {
+  reader_ = new StreamReader(weak_factory_.GetWeakPtr());
+}
+
+URLRequestStreamJob::~URLRequestStreamJob() {
+  BrowserThread::PostTask(
+      BrowserThread::UI, FROM_HERE,
+      base::Bind(&StreamReader::Close, reader_, true));
+}
+
+void URLRequestStreamJob::OnData(scoped_refptr<net::IOBufferWithSize> buffer) {
+  if (ended_ || stream_error_ != net::OK || bytes_remaining_ == 0)
+    return;
+
+  // Drop the data before the requested range.
+  size_t offset = 0;
+  if (bytes_to_skip_ > 0) {
+    if (bytes_to_skip_ >= buffer->size()) {
+      bytes_to_skip_ -= buffer->size();
+      return;
+    }
+    offset = static_cast<size_t>(bytes_to_skip_);
+    bytes_to_skip_ = 0;
+  }
+
+  if (chunks_.empty())
+    chunk_offset_ = offset;
+  chunks_.push_back(buffer);
+  buffered_bytes_ += buffer->size() - offset;
+
+  // There is a ReadRawData waiting for the data.
+  if (pending_buffer_) {
+    int bytes_read = CopyData(pending_buffer_.get(), pending_buffer_size_);
+    pending_buffer_ = nullptr;
+    pending_buffer_size_ = 0;
+    ReadRawDataComplete(bytes_read);
+  } else {
+    UpdateFlowControl();
+  }
+}
+
+void URLRequestStreamJob::OnEnd() {
+  ended_ = true;
+  if (pending_buffer_) {
+    pending_buffer_ = nullptr;
+    pending_buffer_size_ = 0;
+    ReadRawDataComplete(0);
+  }
+}
+
+void URLRequestStreamJob::OnError(int error) {
+  stream_error_ = error;
+  chunks_.clear();
+  buffered_bytes_ = 0;
+  if (pending_buffer_) {
+    pending_buffer_ = nullptr;
+    pending_buffer_size_ = 0;
+    ReadRawDataComplete(error);
+  }
+}
+
+void URLRequestStreamJob::BeforeStartInUI(
+    v8::Isolate* isolate, v8::Local<v8::Value> value) {
+  error_ = net::ERR_NOT_IMPLEMENTED;
+  if (!value->IsObject())
+    return;
+
+  mate::Dictionary dict(isolate, value.As<v8::Object>());
+  int error;
+  if (dict.Get("error", &error)) {
+    error_ = error;
+    return;
+  }
+
+  // The response is either the stream itself or an object with the stream
+  // in its "data" property.
+  v8::Local<v8::Object> stream = value.As<v8::Object>();
+  v8::Local<v8::Object> data;
+  if (dict.Get("data", &data)) {
+    stream = data;
+    dict.Get("statusCode", &status_code_);
+    dict.Get("mimeType", &mime_type_);
+
+    mate::Dictionary headers;
+    if (dict.Get("headers", &headers)) {
+      v8::Local<v8::Array> names = headers.GetHandle()->GetOwnPropertyNames();
+      for (uint32_t i = 0; i < names->Length(); ++i) {
+        std::string name, header_value;
+        if (!mate::ConvertFromV8(isolate, names->Get(i), &name))
+          continue;
+        v8::Local<v8::Value> raw_value;
+        if (!headers.Get(name, &raw_value) ||
+            !mate::ConvertFromV8(isolate, raw_value->ToString(), &header_value))
+          continue;
+        // The headers would otherwise be able to inject other headers.
+        if (!net::HttpUtil::IsValidHeaderName(name) ||
+            !net::HttpUtil::IsValidHeaderValue(header_value)) {
+          error_ = net::ERR_INVALID_RESPONSE;
+          return;
+        }
+        if (base::LowerCaseEqualsASCII(name, "content-length")) {
+          if (!base::StringToInt64(header_value, &content_length_) ||
+              content_length_ < 0) {
+            error_ = net::ERR_INVALID_RESPONSE;
+            return;
+          }
+          continue;
+        }
+        headers_.push_back(std::make_pair(name, header_value));
+      }
+    }
+  }
+
+  if (reader_->Attach(isolate, stream))
+    error_ = net::OK;
+}
+
+void URLRequestStreamJob::StartAsync(std::unique_ptr<base::Value> options) {
+  if (error_ != net::OK) {
+    NotifyStartError(net::URLRequestStatus(
+          net::URLRequestStatus::FAILED, error_));
+    return;
+  }
+
+  ApplyRange();
+
+  std::string status("HTTP/1.1 ");
+  status.append(base::IntToString(status_code_));
+  status.append(" ");
+  status.append(net::GetHttpReasonPhrase(
+      static_cast<net::HttpStatusCode>(status_code_)));
+  status.append("\0\0", 2);
+  response_headers_ = new net::HttpResponseHeaders(status);
+
+  response_headers_->AddHeader(kCORSHeader);
+  bool has_content_type = false;
+  for (const auto& header : headers_) {
+    if (base::LowerCaseEqualsASCII(header.first, "content-type"))
+      has_content_type = true;
+    response_headers_->AddHeader(header.first + ": " + header.second);
+  }
+  if (!has_content_type && !mime_type_.empty()) {
+    response_headers_->AddHeader(base::StringPrintf(
+        "%s: %s", net::HttpRequestHeaders::kContentType, mime_type_.c_str()));
+  }
+  if (bytes_remaining_ >= 0) {
+    response_headers_->AddHeader(base::StringPrintf(
+        "%s: %" PRId64, net::HttpRequestHeaders::kContentLength,
+        bytes_remaining_));
+  }
+
+  if (bytes_remaining_ == 0)
+    BrowserThread::PostTask(
+        BrowserThread::UI, FROM_HERE,
+        base::Bind(&StreamReader::Close, reader_, true));
+
+  NotifyHeadersComplete();
+}
+
+void URLRequestStreamJob::Kill() {
+  weak_factory_.InvalidateWeakPtrs();
+  BrowserThread::PostTask(
+      BrowserThread::UI, FROM_HERE,
+      base::Bind(&StreamReader::Close, reader_, true));
+  JsAsker<net::URLRequestJob>::Kill();
+}
+
+int URLRequestStreamJob::ReadRawData(net::IOBuffer* buf, int buf_size) {
+  if (bytes_remaining_ == 0)
+    return 0;
+
+  int bytes_read = CopyData(buf, buf_size);
+  if (bytes_read > 0)
+    return bytes_read;
+  if (stream_error_ != net::OK)
+    return stream_error_;
+  if (ended_)
+    return 0;
+
+  // Wait until the stream sends more data.
+  pending_buffer_ = buf;
+  pending_buffer_size_ = buf_size;
+  return net::ERR_IO_PENDING;
+}
+
+bool URLRequestStreamJob::GetMimeType(std::string* mime_type) const {
+  if (!response_headers_)
+    return false;
+
+  return response_headers_->GetMimeType(mime_type);
+}
+
+void URLRequestStreamJob::GetResponseInfo(net::HttpResponseInfo* info) {
+  info->headers = response_headers_;
+}
+
+int URLRequestStreamJob::GetResponseCode() const {
+  if (!response_headers_)
+    return -1;
+
+  return response_headers_->response_code();
+}
+
+void URLRequestStreamJob::ApplyRange() {
+  if (content_length_ < 0)
+    return;
+
+  bytes_remaining_ = content_length_;
+
+  // Only a single range of a full response is served, otherwise the whole
+  // body is sent. Other statuses do not have a body that can be ranged.
+  if (status_code_ != net::HTTP_OK)
+    return;
+  std::string range_header;
+  std::vector<net::HttpByteRange> ranges;
+  if (!request()->extra_request_headers().GetHeader(
+          net::HttpRequestHeaders::kRange, &range_header) ||
+      !net::HttpUtil::ParseRangeHeader(range_header, &ranges) ||
+      ranges.size() != 1) {
+    headers_.push_back(std::make_pair("Accept-Ranges", "bytes"));
+    return;
+  }
+
+  net::HttpByteRange range = ranges[0];
+  if (!range.ComputeBounds(content_length_)) {
+    status_code_ = net::HTTP_REQUESTED_RANGE_NOT_SATISFIABLE;
+    bytes_remaining_ = 0;
+    headers_.push_back(std::make_pair(
+        "Content-Range",
+        base::StringPrintf("bytes */%" PRId64, content_length_)));
+    return;
+  }
+
+  status_code_ = net::HTTP_PARTIAL_CONTENT;
+  headers_.push_back(std::make_pair("Accept-Ranges", "bytes"));
+  bytes_to_skip_ = range.first_byte_position();
+  bytes_remaining_ =
+      range.last_byte_position() - range.first_byte_position() + 1;
+  headers_.push_back(std::make_pair(
+      "Content-Range",
+      base::StringPrintf("bytes %" PRId64 "-%" PRId64 "/%" PRId64,
+                         range.first_byte_position(),
+                         range.last_byte_position(),
+                         content_length_)));
+}
+
+int URLRequestStreamJob::CopyData(net::IOBuffer* buf, int buf_size) {
+  int bytes_read = 0;
+  while (!chunks_.empty() && bytes_read < buf_size && bytes_remaining_ != 0) {
+    net::IOBufferWithSize* chunk = chunks_.front().get();
+    size_t size = std::min(chunk->size() - chunk_offset_,
+                           static_cast<size_t>(buf_size - bytes_read));
+    if (bytes_remaining_ > 0)
+      size = std::min(size, static_cast<size_t>(bytes_remaining_));
+    memcpy(buf->data() + bytes_read, chunk->data() + chunk_offset_, size);
+
+    bytes_read += size;
+    chunk_offset_ += size;
+    buffered_bytes_ -= size;
+    if (bytes_remaining_ > 0)
+      bytes_remaining_ -= size;
+    if (chunk_offset_ == static_cast<size_t>(chunk->size())) {
+      chunks_.pop_front();
+      chunk_offset_ = 0;
+    }
+  }
+
+  // The rest of the stream is not needed after the requested range.
+  if (bytes_remaining_ == 0 && !ended_) {
+    ended_ = true;
+    chunks_.clear();
+    buffered_bytes_ = 0;
+    BrowserThread::PostTask(
+        BrowserThread::UI, FROM_HERE,
+        base::Bind(&StreamReader::Close, reader_, true));
+    return bytes_read;
+  }
+
+  UpdateFlowControl();
+  return bytes_read;
+}
+
+void URLRequestStreamJob::UpdateFlowControl() {
+  if (!paused_ && buffered_bytes_ >= kMaxBufferedBytes) {
+    paused_ = true;
+    BrowserThread::PostTask(
+        BrowserThread::UI, FROM_HERE,
+        base::Bind(&StreamReader::Pause, reader_));
+  } else if (paused_ && buffered_bytes_ <= kMaxBufferedBytes / 2) {
+    paused_ = false;
+    BrowserThread::PostTask(
+        BrowserThread::UI, FROM_HERE,
+        base::Bind(&StreamReader::Resume, reader_));
+  }
+}
+
+}  // namespace atom
@@ -0,0 +1,97 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_URL_REQUEST_STREAM_JOB_H_
+#define ATOM_BROWSER_NET_URL_REQUEST_STREAM_JOB_H_
+
+#include <stdint.h>
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "atom/browser/net/js_asker.h"
+#include "base/memory/weak_ptr.h"
+#include "net/base/io_buffer.h"
+
+namespace atom {
+
+// Sends the data of a Node.js readable stream as the response.
+//
+// The stream is read on the UI thread and its chunks are handed to the job
+// as they come, the stream is paused while too much data is waiting to be
+// read by the request. Range requests are served from the stream when the
+// length of the body is known.
+class URLRequestStreamJob : public JsAsker<net::URLRequestJob> {
+ public:
+  URLRequestStreamJob(net::URLRequest*, net::NetworkDelegate*);
+  ~URLRequestStreamJob() override;
+
+  // Called by the stream on the UI thread.
+  void OnData(scoped_refptr<net::IOBufferWithSize> buffer);
+  void OnEnd();
+  void OnError(int error);
+
+ protected:
+  // JsAsker:
+  void BeforeStartInUI(v8::Isolate*, v8::Local<v8::Value>) override;
+  void StartAsync(std::unique_ptr<base::Value> options) override;
+  bool ShouldConvertOptions() const override { return false; }
+
+  // net::URLRequestJob:
+  void Kill() override;
+  int ReadRawData(net::IOBuffer* buf, int buf_size) override;
+  bool GetMimeType(std::string* mime_type) const override;
+  void GetResponseInfo(net::HttpResponseInfo* info) override;
+  int GetResponseCode() const override;
+
+ private:
+  class StreamReader;
+
+  // Applies the Range header of the request to the response.
+  void ApplyRange();
+
+  // Copies the received data to |buf|, returns the number of bytes.
+  int CopyData(net::IOBuffer* buf, int buf_size);
+
+  // Pauses or resumes the stream by the amount of data waiting to be read.
+  void UpdateFlowControl();
+
+  scoped_refptr<StreamReader> reader_;
+
+  // The response set by the handler.
+  int error_;
+  int status_code_;
+  std::string mime_type_;
+  std::vector<std::pair<std::string, std::string>> headers_;
+  // The length of the whole body, -1 when unknown.
+  int64_t content_length_;
+
+  // The bytes of the body to skip, and to send with -1 for all of them.
+  int64_t bytes_to_skip_;
+  int64_t bytes_remaining_;
+
+  // Chunks received from the stream and not read yet.
+  std::deque<scoped_refptr<net::IOBufferWithSize>> chunks_;
+  size_t chunk_offset_;
+  size_t buffered_bytes_;
+  bool paused_;
+  bool ended_;
+  int stream_error_;
+
+  // Saved arguments passed to ReadRawData.
+  scoped_refptr<net::IOBuffer> pending_buffer_;
+  int pending_buffer_size_;
+
+  scoped_refptr<net::HttpResponseHeaders> response_headers_;
+
+  base::WeakPtrFactory<URLRequestStreamJob> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(URLRequestStreamJob);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_URL_REQUEST_STREAM_JOB_H_
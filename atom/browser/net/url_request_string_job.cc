@@ -26,6 +26,16 @@ void URLRequestStringJob::StartAsync(std::unique_ptr<base::Value> options) {
   } else if (options->IsType(base::Value::TYPE_STRING)) {
     options->GetAsString(&data_);
   }
+
+  if (ShouldCacheResponse()) {
+    ProtocolResponseCache::Response response;
+    response.mime_type = mime_type_;
+    response.charset = charset_;
+    std::string data(data_);
+    response.data = base::RefCountedString::TakeString(&data);
+    CacheResponse(response);
+  }
+
   net::URLRequestSimpleJob::Start();
 }
 
@@ -42,6 +52,7 @@ void URLRequestStringJob::GetResponseInfo(net::HttpResponseInfo* info) {
     headers->AddHeader(content_type_header);
   }
 
+  AddCacheHeaders(headers);
   info->headers = headers;
 }
 
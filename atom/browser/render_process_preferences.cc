@@ -18,9 +18,11 @@ RenderProcessPreferences::RenderProcessPreferences(const Predicate& predicate)
   registrar_.Add(this,
                  content::NOTIFICATION_RENDERER_PROCESS_CREATED,
                  content::NotificationService::AllBrowserContextsAndSources());
+  SpareRendererPool::AddObserver(this);
 }
 
 RenderProcessPreferences::~RenderProcessPreferences() {
+  SpareRendererPool::RemoveObserver(this);
 }
 
 int RenderProcessPreferences::AddEntry(const base::DictionaryValue& entry) {
@@ -40,9 +42,17 @@ void RenderProcessPreferences::Observe(
     const content::NotificationSource& source,
     const content::NotificationDetails& details) {
   DCHECK_EQ(type, content::NOTIFICATION_RENDERER_PROCESS_CREATED);
-  content::RenderProcessHost* process =
-      content::Source<content::RenderProcessHost>(source).ptr();
+  SendPreferences(content::Source<content::RenderProcessHost>(source).ptr());
+}
+
+void RenderProcessPreferences::OnSpareRendererClaimed(
+    content::RenderProcessHost* process) {
+  // Spares are created before they belong to any WebContents.
+  SendPreferences(process);
+}
 
+void RenderProcessPreferences::SendPreferences(
+    content::RenderProcessHost* process) {
   if (!predicate_.Run(process))
     return;
 
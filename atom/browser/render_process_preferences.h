@@ -8,6 +8,7 @@
 #include <memory>
 #include <unordered_map>
 
+#include "atom/browser/spare_renderer_pool.h"
 #include "base/callback.h"
 #include "base/values.h"
 #include "content/public/browser/notification_observer.h"
@@ -20,7 +21,8 @@ class RenderProcessHost;
 namespace atom {
 
 // Sets user preferences for render processes.
-class RenderProcessPreferences : public content::NotificationObserver {
+class RenderProcessPreferences : public content::NotificationObserver,
+                                 public SpareRendererPool::Observer {
  public:
   using Predicate = base::Callback<bool(content::RenderProcessHost*)>;
 
@@ -38,6 +40,12 @@ class RenderProcessPreferences : public content::NotificationObserver {
                const content::NotificationSource& source,
                const content::NotificationDetails& details) override;
 
+  // SpareRendererPool::Observer:
+  void OnSpareRendererClaimed(content::RenderProcessHost* process) override;
+
+  // Sends the preferences to |process| if it matches the |predicate_|.
+  void SendPreferences(content::RenderProcessHost* process);
+
   void UpdateCache();
 
   // Manages our notification registrations.
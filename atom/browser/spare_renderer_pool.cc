@@ -0,0 +1,309 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/spare_renderer_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "atom/browser/browser.h"
+#include "atom/browser/web_contents_preferences.h"
+#include "atom/common/api/api_messages.h"
+#include "atom/common/options_switches.h"
+#include "base/bind.h"
+#include "base/process/process_handle.h"
+#include "base/strings/string_split.h"
+#include "base/values.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/notification_service.h"
+#include "content/public/browser/notification_types.h"
+#include "content/public/browser/render_process_host.h"
+#include "content/public/browser/site_instance.h"
+#include "content/public/common/child_process_host.h"
+#include "url/gurl.h"
+
+namespace atom {
+
+namespace {
+
+// The spare that is being launched, its command line is built while
+// RenderProcessHost::Init runs.
+int g_launching_process_id = content::ChildProcessHost::kInvalidUniqueID;
+const base::CommandLine::StringVector* g_launching_switches = nullptr;
+
+// The switches that identify a WebContents instead of configuring its
+// renderer, a spare gets them when it is taken.
+const char* const kWebContentsSwitches[] = {
+  switches::kGuestInstanceID,
+  switches::kOpenerID,
+  "hidden-page",
+};
+
+bool IsWebContentsSwitch(const std::string& name) {
+  for (const char* web_contents_switch : kWebContentsSwitches) {
+    if (name == web_contents_switch)
+      return true;
+  }
+  return false;
+}
+
+// Splits the switches of |web_contents| into the ones a spare is launched
+// with and the ones that are sent to it when it is taken.
+void GetSwitches(content::WebContents* web_contents,
+                 base::CommandLine::StringVector* launch_switches,
+                 base::StringPairs* web_contents_switches) {
+  base::CommandLine command_line(base::CommandLine::NO_PROGRAM);
+  WebContentsPreferences::AppendExtraCommandLineSwitches(web_contents,
+                                                         &command_line);
+
+  base::CommandLine launch_command_line(base::CommandLine::NO_PROGRAM);
+  for (const auto& it : command_line.GetSwitches()) {
+    if (IsWebContentsSwitch(it.first))
+      web_contents_switches->push_back(std::make_pair(
+          it.first, command_line.GetSwitchValueASCII(it.first)));
+    else
+      launch_command_line.AppendSwitchNative(it.first, it.second);
+  }
+  *launch_switches = launch_command_line.argv();
+}
+
+}  // namespace
+
+// static
+base::LazyInstance<base::ObserverList<SpareRendererPool::Observer>>::Leaky
+    SpareRendererPool::observers_ = LAZY_INSTANCE_INITIALIZER;
+
+SpareRendererPool::Spare::Spare() : host(nullptr) {
+}
+
+SpareRendererPool::Spare::Spare(const Spare& other) = default;
+
+SpareRendererPool::Spare::~Spare() {
+}
+
+SpareRendererPool::SpareRendererPool(content::BrowserContext* browser_context)
+    : browser_context_(browser_context),
+      size_(0),
+      hits_(0),
+      misses_(0),
+      launches_(0),
+      discards_(0),
+      weak_factory_(this) {
+  Browser::Get()->AddObserver(this);
+}
+
+SpareRendererPool::~SpareRendererPool() {
+  Browser::Get()->RemoveObserver(this);
+  Clear();
+}
+
+// static
+void SpareRendererPool::AddObserver(Observer* observer) {
+  observers_.Get().AddObserver(observer);
+}
+
+// static
+void SpareRendererPool::RemoveObserver(Observer* observer) {
+  observers_.Get().RemoveObserver(observer);
+}
+
+// static
+bool SpareRendererPool::AppendExtraCommandLineSwitches(
+    int process_id, base::CommandLine* command_line) {
+  if (!g_launching_switches || process_id != g_launching_process_id)
+    return false;
+  command_line->AppendArguments(base::CommandLine(*g_launching_switches),
+                                false);
+  return true;
+}
+
+void SpareRendererPool::SetSize(size_t size) {
+  size_ = size;
+  while (spares_.size() > size_)
+    Discard(spares_.begin());
+}
+
+scoped_refptr<content::SiteInstance> SpareRendererPool::Claim(
+    content::WebContents* web_contents) {
+  if (!enabled())
+    return nullptr;
+
+  Switches switches;
+  base::StringPairs web_contents_switches;
+  GetSwitches(web_contents, &switches, &web_contents_switches);
+  scoped_refptr<content::SiteInstance> site_instance;
+  for (auto it = spares_.begin(); it != spares_.end(); ++it) {
+    if (it->switches == switches) {
+      site_instance = it->site_instance;
+      // The navigation does not wait for the part of the launch that is done,
+      // a spare that is still starting saved the time it has been starting.
+      base::TimeTicks now = base::TimeTicks::Now();
+      base::TimeTicks ready_time =
+          it->ready_time.is_null() ? now : std::min(it->ready_time, now);
+      saved_time_ += ready_time - it->launch_time;
+      // Sent before the navigation creates its views in the process.
+      if (!web_contents_switches.empty())
+        it->host->Send(new AtomMsg_AppendSwitches(web_contents_switches));
+      StopObserving(it->host);
+      spares_.erase(it);
+      break;
+    }
+  }
+
+  if (site_instance) {
+    ++hits_;
+    // Observers look for the WebContents of the process, which is only known
+    // once the navigation has taken it.
+    content::BrowserThread::PostTask(
+        content::BrowserThread::UI, FROM_HERE,
+        base::Bind(&SpareRendererPool::NotifyClaimed,
+                   site_instance->GetProcess()->GetID()));
+  } else {
+    ++misses_;
+  }
+
+  // Launch the next spare after the navigation has started, so it does not
+  // wait for it.
+  content::BrowserThread::PostTask(
+      content::BrowserThread::UI, FROM_HERE,
+      base::Bind(&SpareRendererPool::Refill, weak_factory_.GetWeakPtr(),
+                 switches));
+  return site_instance;
+}
+
+std::unique_ptr<base::DictionaryValue> SpareRendererPool::GetStats() const {
+  std::unique_ptr<base::DictionaryValue> stats(new base::DictionaryValue);
+  uint64_t claims = hits_ + misses_;
+  stats->SetDouble("hits", hits_);
+  stats->SetDouble("misses", misses_);
+  stats->SetDouble("hitRate",
+                   claims ? static_cast<double>(hits_) / claims : 0);
+  stats->SetDouble("spares", spares_.size());
+  stats->SetDouble("launches", launches_);
+  stats->SetDouble("discards", discards_);
+  stats->SetDouble("savedTime", saved_time_.InMillisecondsF());
+  std::unique_ptr<base::ListValue> process_ids(new base::ListValue);
+  for (const auto& spare : spares_) {
+    base::ProcessHandle handle = spare.host->GetHandle();
+    if (handle != base::kNullProcessHandle)
+      process_ids->AppendInteger(base::GetProcId(handle));
+  }
+  stats->Set("processIds", std::move(process_ids));
+  return stats;
+}
+
+void SpareRendererPool::Refill(const Switches& switches) {
+  // A spare would share an existing process when the process limit is hit.
+  if (content::RenderProcessHost::run_renderer_in_process() ||
+      content::RenderProcessHost::ShouldTryToUseExistingProcessHost(
+          browser_context_, GURL()))
+    return;
+
+  auto it = spares_.begin();
+  while (it != spares_.end()) {
+    if (it->switches != switches)
+      Discard(it++);
+    else
+      ++it;
+  }
+
+  while (spares_.size() < size_)
+    Launch(switches);
+}
+
+void SpareRendererPool::Launch(const Switches& switches) {
+  // The process does not get a site until the navigation taking it commits.
+  scoped_refptr<content::SiteInstance> site_instance =
+      content::SiteInstance::Create(browser_context_);
+  content::RenderProcessHost* host = site_instance->GetProcess();
+
+  g_launching_process_id = host->GetID();
+  g_launching_switches = &switches;
+  bool launched = host->Init();
+  g_launching_process_id = content::ChildProcessHost::kInvalidUniqueID;
+  g_launching_switches = nullptr;
+  if (!launched)
+    return;
+
+  Spare spare;
+  spare.site_instance = site_instance;
+  spare.host = host;
+  spare.switches = switches;
+  spare.launch_time = base::TimeTicks::Now();
+  spares_.push_back(spare);
+  host->AddObserver(this);
+  registrar_.Add(this, content::NOTIFICATION_RENDERER_PROCESS_CREATED,
+                 content::Source<content::RenderProcessHost>(host));
+  ++launches_;
+}
+
+void SpareRendererPool::StopObserving(content::RenderProcessHost* host) {
+  host->RemoveObserver(this);
+  registrar_.Remove(this, content::NOTIFICATION_RENDERER_PROCESS_CREATED,
+                    content::Source<content::RenderProcessHost>(host));
+}
+
+void SpareRendererPool::Remove(std::list<Spare>::iterator it) {
+  StopObserving(it->host);
+  spares_.erase(it);
+  ++discards_;
+}
+
+void SpareRendererPool::Discard(std::list<Spare>::iterator it) {
+  // The process never had a route, so nothing else shuts it down.
+  content::RenderProcessHost* host = it->host;
+  Remove(it);
+  host->Cleanup();
+}
+
+void SpareRendererPool::Clear() {
+  while (!spares_.empty())
+    Discard(spares_.begin());
+}
+
+// static
+void SpareRendererPool::NotifyClaimed(int process_id) {
+  content::RenderProcessHost* host =
+      content::RenderProcessHost::FromID(process_id);
+  if (host)
+    FOR_EACH_OBSERVER(Observer, observers_.Get(),
+                      OnSpareRendererClaimed(host));
+}
+
+void SpareRendererPool::RenderProcessExited(content::RenderProcessHost* host,
+                                            base::TerminationStatus status,
+                                            int exit_code) {
+  for (auto it = spares_.begin(); it != spares_.end(); ++it) {
+    if (it->host == host) {
+      Remove(it);
+      return;
+    }
+  }
+}
+
+void SpareRendererPool::RenderProcessHostDestroyed(
+    content::RenderProcessHost* host) {
+  RenderProcessExited(host, base::TERMINATION_STATUS_NORMAL_TERMINATION, 0);
+}
+
+void SpareRendererPool::Observe(int type,
+                                const content::NotificationSource& source,
+                                const content::NotificationDetails& details) {
+  DCHECK_EQ(type, content::NOTIFICATION_RENDERER_PROCESS_CREATED);
+  content::RenderProcessHost* host =
+      content::Source<content::RenderProcessHost>(source).ptr();
+  for (auto& spare : spares_) {
+    if (spare.host == host) {
+      spare.ready_time = base::TimeTicks::Now();
+      return;
+    }
+  }
+}
+
+void SpareRendererPool::OnQuit() {
+  size_ = 0;
+  Clear();
+}
+
+}  // namespace atom
@@ -0,0 +1,154 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_SPARE_RENDERER_POOL_H_
+#define ATOM_BROWSER_SPARE_RENDERER_POOL_H_
+
+#include <stdint.h>
+
+#include <list>
+#include <memory>
+
+#include "atom/browser/browser_observer.h"
+#include "base/command_line.h"
+#include "base/lazy_instance.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/observer_list.h"
+#include "base/time/time.h"
+#include "content/public/browser/notification_observer.h"
+#include "content/public/browser/notification_registrar.h"
+#include "content/public/browser/render_process_host_observer.h"
+
+namespace base {
+class DictionaryValue;
+}
+
+namespace content {
+class BrowserContext;
+class SiteInstance;
+class WebContents;
+}
+
+namespace atom {
+
+// Keeps renderer processes that are launched ahead of the navigations which
+// need a new one, so a navigation can take a process that has already started
+// instead of waiting for it to launch and initialize V8 and node.
+//
+// The command line of a renderer carries the preferences of the WebContents
+// it is launched for, so a spare is only given to the navigations of
+// WebContents with the same switches, and the pool is refilled with the
+// switches of the WebContents that asked for one. The switches that identify
+// a WebContents, like the guest instance id, are left out and sent to the
+// spare when it is taken. It can only be used on the UI thread.
+class SpareRendererPool : public content::RenderProcessHostObserver,
+                          public content::NotificationObserver,
+                          public BrowserObserver {
+ public:
+  class Observer {
+   public:
+    // Called when |host|, which was launched before any WebContents used it,
+    // is taken by a navigation.
+    virtual void OnSpareRendererClaimed(content::RenderProcessHost* host) = 0;
+
+   protected:
+    virtual ~Observer() {}
+  };
+
+  explicit SpareRendererPool(content::BrowserContext* browser_context);
+  ~SpareRendererPool() override;
+
+  static void AddObserver(Observer* observer);
+  static void RemoveObserver(Observer* observer);
+
+  // Appends the switches of the spare that is being launched as |process_id|,
+  // returns false when the process is not a spare.
+  static bool AppendExtraCommandLineSwitches(int process_id,
+                                             base::CommandLine* command_line);
+
+  // The pool is disabled when |size| is 0, which is the default.
+  void SetSize(size_t size);
+  bool enabled() const { return size_ > 0; }
+
+  // Returns a SiteInstance whose process can be used by a navigation of
+  // |web_contents|, or nullptr when there is none.
+  scoped_refptr<content::SiteInstance> Claim(
+      content::WebContents* web_contents);
+
+  std::unique_ptr<base::DictionaryValue> GetStats() const;
+
+ private:
+  using Switches = base::CommandLine::StringVector;
+
+  struct Spare {
+    Spare();
+    Spare(const Spare& other);
+    ~Spare();
+
+    scoped_refptr<content::SiteInstance> site_instance;
+    content::RenderProcessHost* host;
+    Switches switches;
+    base::TimeTicks launch_time;
+    // Null until the process has launched.
+    base::TimeTicks ready_time;
+  };
+
+  // Replaces the spares of other switches with ones launched with |switches|
+  // until there are |size_| of them.
+  void Refill(const Switches& switches);
+  void Launch(const Switches& switches);
+
+  void StopObserving(content::RenderProcessHost* host);
+
+  // Forgets a spare whose process is gone.
+  void Remove(std::list<Spare>::iterator it);
+
+  // Discards a spare and shuts its process down.
+  void Discard(std::list<Spare>::iterator it);
+  void Clear();
+
+  static void NotifyClaimed(int process_id);
+
+  // content::RenderProcessHostObserver:
+  void RenderProcessExited(content::RenderProcessHost* host,
+                           base::TerminationStatus status,
+                           int exit_code) override;
+  void RenderProcessHostDestroyed(content::RenderProcessHost* host) override;
+
+  // content::NotificationObserver:
+  void Observe(int type,
+               const content::NotificationSource& source,
+               const content::NotificationDetails& details) override;
+
+  // BrowserObserver:
+  void OnQuit() override;
+
+  content::BrowserContext* browser_context_;
+  size_t size_;
+
+  // The oldest spares first.
+  std::list<Spare> spares_;
+
+  uint64_t hits_;
+  uint64_t misses_;
+  uint64_t launches_;
+  uint64_t discards_;
+  // The launch time of the claimed spares that their navigations did not
+  // wait for.
+  base::TimeDelta saved_time_;
+
+  content::NotificationRegistrar registrar_;
+
+  static base::LazyInstance<base::ObserverList<Observer>>::Leaky observers_;
+
+  base::WeakPtrFactory<SpareRendererPool> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(SpareRendererPool);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_SPARE_RENDERER_POOL_H_
@@ -14,6 +14,7 @@
 #include "base/strings/string_number_conversions.h"
 #include "content/public/browser/render_process_host.h"
 #include "content/public/browser/render_view_host.h"
+#include "content/public/common/child_process_host.h"
 #include "content/public/common/content_switches.h"
 #include "content/public/common/web_preferences.h"
 #include "native_mate/dictionary.h"
@@ -27,13 +28,29 @@ DEFINE_WEB_CONTENTS_USER_DATA_KEY(atom::WebContentsPreferences);
 
 namespace atom {
 
+namespace {
+
+int GetProcessID(content::RenderViewHost* host) {
+  return host ? host->GetProcess()->GetID()
+              : content::ChildProcessHost::kInvalidUniqueID;
+}
+
+}  // namespace
+
 // static
-std::vector<WebContentsPreferences*> WebContentsPreferences::instances_;
+std::unordered_map<int, std::vector<WebContentsPreferences*>>
+    WebContentsPreferences::process_index_;
+
+// static
+uint64_t WebContentsPreferences::next_sequence_number_ = 0;
 
 WebContentsPreferences::WebContentsPreferences(
     content::WebContents* web_contents,
     const mate::Dictionary& web_preferences)
-    : web_contents_(web_contents) {
+    : content::WebContentsObserver(web_contents),
+      sequence_number_(next_sequence_number_++),
+      process_id_(content::ChildProcessHost::kInvalidUniqueID),
+      web_contents_(web_contents) {
   v8::Isolate* isolate = web_preferences.isolate();
   mate::Dictionary copied(isolate, web_preferences.GetHandle()->Clone());
   // Following fields should not be stored.
@@ -44,13 +61,11 @@ WebContentsPreferences::WebContentsPreferences(
   mate::ConvertFromV8(isolate, copied.GetHandle(), &web_preferences_);
   web_contents->SetUserData(UserDataKey(), this);
 
-  instances_.push_back(this);
+  SetProcessID(GetProcessID(web_contents->GetRenderViewHost()));
 }
 
 WebContentsPreferences::~WebContentsPreferences() {
-  instances_.erase(
-      std::remove(instances_.begin(), instances_.end(), this),
-      instances_.end());
+  SetProcessID(content::ChildProcessHost::kInvalidUniqueID);
 }
 
 void WebContentsPreferences::Merge(const base::DictionaryValue& extend) {
@@ -60,11 +75,9 @@ void WebContentsPreferences::Merge(const base::DictionaryValue& extend) {
 // static
 content::WebContents* WebContentsPreferences::GetWebContentsFromProcessID(
     int process_id) {
-  for (WebContentsPreferences* preferences : instances_) {
-    content::WebContents* web_contents = preferences->web_contents_;
-    if (web_contents->GetRenderProcessHost()->GetID() == process_id)
-      return web_contents;
-  }
+  auto it = process_index_.find(process_id);
+  if (it != process_index_.end())
+    return it->second.front()->web_contents_;
   // Also try to get the webview from RenderViewHost::FromID because
   // not all web contents have preferences created (devtools).
   content::WebContents* web_contents = nullptr;
@@ -253,4 +266,37 @@ void WebContentsPreferences::OverrideWebkitPrefs(
     prefs->default_encoding = encoding;
 }
 
+void WebContentsPreferences::RenderViewHostChanged(
+    content::RenderViewHost* old_host,
+    content::RenderViewHost* new_host) {
+  SetProcessID(GetProcessID(new_host));
+}
+
+void WebContentsPreferences::SetProcessID(int process_id) {
+  if (process_id == process_id_)
+    return;
+
+  auto it = process_index_.find(process_id_);
+  if (it != process_index_.end()) {
+    auto& instances = it->second;
+    instances.erase(std::find(instances.begin(), instances.end(), this));
+    if (instances.empty())
+      process_index_.erase(it);
+  }
+
+  process_id_ = process_id;
+  if (process_id_ == content::ChildProcessHost::kInvalidUniqueID)
+    return;
+
+  // When several WebContents share a process, the oldest one is returned.
+  auto& instances = process_index_[process_id_];
+  instances.insert(
+      std::upper_bound(instances.begin(), instances.end(), this,
+                       [](const WebContentsPreferences* a,
+                          const WebContentsPreferences* b) {
+                         return a->sequence_number_ < b->sequence_number_;
+                       }),
+      this);
+}
+
 }  // namespace atom
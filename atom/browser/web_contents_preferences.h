@@ -5,12 +5,16 @@
 #ifndef ATOM_BROWSER_WEB_CONTENTS_PREFERENCES_H_
 #define ATOM_BROWSER_WEB_CONTENTS_PREFERENCES_H_
 
+#include <stdint.h>
+
+#include <unordered_map>
 #include <vector>
 
 #include "atom/browser/api/atom_api_extension.h"
 #include "atom/common/options_switches.h"
 #include "base/command_line.h"
 #include "base/values.h"
+#include "content/public/browser/web_contents_observer.h"
 #include "content/public/browser/web_contents_user_data.h"
 #include "content/public/common/content_switches.h"
 
@@ -34,7 +38,8 @@ namespace atom {
 
 // Stores and applies the preferences of WebContents.
 class WebContentsPreferences
-    : public content::WebContentsUserData<WebContentsPreferences> {
+    : public content::WebContentsObserver,
+      public content::WebContentsUserData<WebContentsPreferences> {
  public:
   // Get WebContents according to process ID.
   // FIXME(zcbenz): This method does not belong here.
@@ -80,7 +85,21 @@ class WebContentsPreferences
  private:
   friend class content::WebContentsUserData<WebContentsPreferences>;
 
-  static std::vector<WebContentsPreferences*> instances_;
+  // content::WebContentsObserver:
+  void RenderViewHostChanged(content::RenderViewHost* old_host,
+                             content::RenderViewHost* new_host) override;
+
+  // Moves this to the entry of |process_id| in |process_index_|.
+  void SetProcessID(int process_id);
+
+  // The instances keyed by the ID of their current render process, each list
+  // in the order the instances were created.
+  static std::unordered_map<int, std::vector<WebContentsPreferences*>>
+      process_index_;
+  static uint64_t next_sequence_number_;
+
+  uint64_t sequence_number_;
+  int process_id_;
 
   content::WebContents* web_contents_;
   base::DictionaryValue web_preferences_;
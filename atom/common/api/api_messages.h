@@ -5,7 +5,9 @@
 // Multiply-included file, no traditional include guard.
 
 #include "atom/common/draggable_region.h"
+#include "atom/common/native_mate_converters/v8_value_serializer.h"
 #include "base/strings/string16.h"
+#include "base/strings/string_split.h"
 #include "base/values.h"
 #include "content/public/common/common_param_traits.h"
 #include "ipc/ipc_message_macros.h"
@@ -21,6 +23,12 @@ IPC_STRUCT_TRAITS_BEGIN(atom::DraggableRegion)
   IPC_STRUCT_TRAITS_MEMBER(bounds)
 IPC_STRUCT_TRAITS_END()
 
+IPC_STRUCT_TRAITS_BEGIN(atom::SerializedV8Value)
+  IPC_STRUCT_TRAITS_MEMBER(data)
+  IPC_STRUCT_TRAITS_MEMBER(shared_buffers)
+  IPC_STRUCT_TRAITS_MEMBER(shared_buffers_size)
+IPC_STRUCT_TRAITS_END()
+
 IPC_MESSAGE_ROUTED2(AtomViewHostMsg_Message,
                     base::string16 /* channel */,
                     base::ListValue /* arguments */)
@@ -35,6 +43,39 @@ IPC_MESSAGE_ROUTED3(AtomViewMsg_Message,
                     base::string16 /* channel */,
                     base::ListValue /* arguments */)
 
+// Same as AtomViewHostMsg_Message and AtomViewMsg_Message, but the arguments
+// are serialized with SerializeV8Value instead of being converted to values.
+IPC_MESSAGE_ROUTED2(AtomViewHostMsg_StructuredMessage,
+                    base::string16 /* channel */,
+                    atom::SerializedV8Value /* arguments */)
+
+IPC_MESSAGE_ROUTED3(AtomViewMsg_StructuredMessage,
+                    bool /* send_to_all */,
+                    base::string16 /* channel */,
+                    atom::SerializedV8Value /* arguments */)
+
+// Same as AtomViewMsg_StructuredMessage, but the arguments were serialized once
+// for several WebContents, and its shared memory regions are read-only views
+// of regions shared with the other receivers.
+IPC_MESSAGE_ROUTED2(AtomViewMsg_BroadcastMessage,
+                    base::string16 /* channel */,
+                    atom::SerializedV8Value /* arguments */)
+
+// Asks the handler of |channel| in the browser for a reply.
+IPC_MESSAGE_ROUTED3(AtomViewHostMsg_Invoke,
+                    int /* request_id */,
+                    base::string16 /* channel */,
+                    atom::SerializedV8Value /* arguments */)
+
+// Sent when the renderer no longer waits for the reply of a request.
+IPC_MESSAGE_ROUTED1(AtomViewHostMsg_InvokeCancel,
+                    int /* request_id */)
+
+IPC_MESSAGE_ROUTED3(AtomViewMsg_InvokeReply,
+                    int /* request_id */,
+                    bool /* success */,
+                    atom::SerializedV8Value /* result or error message */)
+
 // Sent by the renderer when the draggable regions are updated.
 IPC_MESSAGE_ROUTED1(AtomViewHostMsg_UpdateDraggableRegions,
                     std::vector<atom::DraggableRegion> /* regions */)
@@ -42,6 +83,10 @@ IPC_MESSAGE_ROUTED1(AtomViewHostMsg_UpdateDraggableRegions,
 // Update renderer process preferences.
 IPC_MESSAGE_CONTROL1(AtomMsg_UpdatePreferences, base::ListValue)
 
+// Sent to a spare renderer when it is taken, with the switches that only
+// belong to the WebContents taking it.
+IPC_MESSAGE_CONTROL1(AtomMsg_AppendSwitches, base::StringPairs /* switches */)
+
 // Update renderer content settings
 IPC_MESSAGE_CONTROL1(AtomMsg_UpdateContentSettings, base::DictionaryValue)
 
@@ -8,6 +8,7 @@
 
 #include "atom_natives.h"  // NOLINT: This file is generated with coffee2c.
 #include "atom/common/asar/archive.h"
+#include "atom/common/asar/asar_util.h"
 #include "atom/common/native_mate_converters/callback.h"
 #include "atom/common/native_mate_converters/file_path_converter.h"
 #include "atom/common/node_includes.h"
@@ -18,14 +19,41 @@
 
 namespace {
 
+// A V8 string backed by the mapped archive.
+class ExternalArchiveString
+    : public v8::String::ExternalOneByteStringResource {
+ public:
+  ExternalArchiveString(scoped_refptr<base::RefCountedMemory> mapping,
+                        const base::StringPiece& contents)
+      : mapping_(mapping), contents_(contents) {}
+
+  const char* data() const override { return contents_.data(); }
+  size_t length() const override { return contents_.size(); }
+
+ private:
+  scoped_refptr<base::RefCountedMemory> mapping_;
+  base::StringPiece contents_;
+
+  DISALLOW_COPY_AND_ASSIGN(ExternalArchiveString);
+};
+
+bool IsASCII(const base::StringPiece& contents) {
+  for (char c : contents) {
+    if (static_cast<unsigned char>(c) >= 0x80)
+      return false;
+  }
+  return true;
+}
+
 class Archive : public mate::Wrappable<Archive> {
  public:
   static v8::Local<v8::Value> Create(v8::Isolate* isolate,
                                       const base::FilePath& path) {
-    std::unique_ptr<asar::Archive> archive(new asar::Archive(path));
-    if (!archive->Init())
+    std::shared_ptr<asar::Archive> archive =
+        asar::GetOrCreateAsarArchive(path);
+    if (!archive)
       return v8::False(isolate);
-    return (new Archive(isolate, std::move(archive)))->GetWrapper();
+    return (new Archive(isolate, archive))->GetWrapper();
   }
 
   static void BuildPrototype(
@@ -37,13 +65,15 @@ class Archive : public mate::Wrappable<Archive> {
         .SetMethod("readdir", &Archive::Readdir)
         .SetMethod("realpath", &Archive::Realpath)
         .SetMethod("copyFileOut", &Archive::CopyFileOut)
+        .SetMethod("readFile", &Archive::ReadFile)
+        .SetMethod("readFileString", &Archive::ReadFileString)
         .SetMethod("getFd", &Archive::GetFD)
         .SetMethod("destroy", &Archive::Destroy);
   }
 
  protected:
-  Archive(v8::Isolate* isolate, std::unique_ptr<asar::Archive> archive)
-      : archive_(std::move(archive)) {
+  Archive(v8::Isolate* isolate, std::shared_ptr<asar::Archive> archive)
+      : archive_(archive) {
     Init(isolate);
   }
 
@@ -61,6 +91,9 @@ class Archive : public mate::Wrappable<Archive> {
     mate::Dictionary dict(isolate, v8::Object::New(isolate));
     dict.Set("size", info.size);
     dict.Set("unpacked", info.unpacked);
+    dict.Set("compressed", info.compressed);
+    if (info.compressed)
+      dict.Set("compressedSize", info.compressed_size);
     dict.Set("offset", info.offset);
     return dict.GetHandle();
   }
@@ -107,6 +140,49 @@ class Archive : public mate::Wrappable<Archive> {
     return mate::ConvertToV8(isolate, new_path);
   }
 
+  // Reads a packed file into a new Buffer, decompressing it when needed.
+  v8::Local<v8::Value> ReadFile(v8::Isolate* isolate,
+                                const base::FilePath& path) {
+    asar::Archive::FileInfo info;
+    if (!archive_ || !archive_->GetFileInfo(path, &info) || info.unpacked)
+      return v8::False(isolate);
+    v8::Local<v8::Object> buffer;
+    if (!node::Buffer::New(isolate, info.size).ToLocal(&buffer) ||
+        !archive_->ReadFile(info, node::Buffer::Data(buffer)))
+      return v8::False(isolate);
+    return buffer;
+  }
+
+  // Returns the file as UTF-8 string, uncompressed ASCII files are exposed as
+  // external strings pointing into the mapped archive without copying.
+  v8::Local<v8::Value> ReadFileString(v8::Isolate* isolate,
+                                      const base::FilePath& path) {
+    asar::Archive::FileInfo info;
+    if (!archive_ || !archive_->GetFileInfo(path, &info) || info.unpacked)
+      return v8::False(isolate);
+
+    v8::Local<v8::String> result;
+    base::StringPiece contents;
+    std::string buffer;
+    if (info.compressed || !archive_->GetContents(info, &contents)) {
+      if (!archive_->ReadFile(info, &buffer))
+        return v8::False(isolate);
+      contents = buffer;
+    } else if (IsASCII(contents)) {
+      auto* resource = new ExternalArchiveString(archive_->mapping(),
+                                                 contents);
+      if (v8::String::NewExternalOneByte(isolate, resource).ToLocal(&result))
+        return result;
+      delete resource;
+    }
+    if (v8::String::NewFromUtf8(isolate, contents.data(),
+                                v8::NewStringType::kNormal,
+                                static_cast<int>(contents.size()))
+            .ToLocal(&result))
+      return result;
+    return v8::False(isolate);
+  }
+
   // Return the file descriptor.
   int GetFD() const {
     if (!archive_)
@@ -120,11 +196,22 @@ class Archive : public mate::Wrappable<Archive> {
   }
 
  private:
-  std::unique_ptr<asar::Archive> archive_;
+  std::shared_ptr<asar::Archive> archive_;
 
   DISALLOW_COPY_AND_ASSIGN(Archive);
 };
 
+v8::Local<v8::Value> GetArchiveCacheStats(v8::Isolate* isolate) {
+  asar::ArchiveCacheStats stats = asar::GetArchiveCacheStats();
+  mate::Dictionary dict(isolate, v8::Object::New(isolate));
+  dict.Set("hits", static_cast<double>(stats.hits));
+  dict.Set("misses", static_cast<double>(stats.misses));
+  dict.Set("evictions", static_cast<double>(stats.evictions));
+  dict.Set("archiveCount", static_cast<double>(stats.archive_count));
+  dict.Set("headerMemory", static_cast<double>(stats.header_memory));
+  return dict.GetHandle();
+}
+
 void InitAsarSupport(v8::Isolate* isolate,
                      v8::Local<v8::Value> process,
                      v8::Local<v8::Value> require) {
@@ -155,6 +242,7 @@ void Initialize(v8::Local<v8::Object> exports, v8::Local<v8::Value> unused,
                 v8::Local<v8::Context> context, void* priv) {
   mate::Dictionary dict(context->GetIsolate(), exports);
   dict.SetMethod("createArchive", &Archive::Create);
+  dict.SetMethod("getArchiveCacheStats", &GetArchiveCacheStats);
   dict.SetMethod("initAsarSupport", &InitAsarSupport);
 }
 
@@ -0,0 +1,106 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/common/api/atom_api_remote_object_registry.h"
+
+#include "native_mate/dictionary.h"
+#include "native_mate/object_template_builder.h"
+
+namespace atom {
+
+namespace api {
+
+RemoteObjectRegistry::RemoteObjectRegistry(v8::Isolate* isolate) {
+  Init(isolate);
+}
+
+RemoteObjectRegistry::~RemoteObjectRegistry() {
+}
+
+int32_t RemoteObjectRegistry::Add(v8::Isolate* isolate,
+                                  int web_contents_id,
+                                  const std::string& context_id,
+                                  v8::Local<v8::Object> object) {
+  return registry_.Add(isolate, web_contents_id, context_id, object);
+}
+
+v8::Local<v8::Value> RemoteObjectRegistry::Get(v8::Isolate* isolate,
+                                               int32_t id) {
+  v8::Local<v8::Object> object;
+  if (registry_.Get(isolate, id).ToLocal(&object))
+    return object;
+  return v8::Undefined(isolate);
+}
+
+void RemoteObjectRegistry::Remove(int web_contents_id,
+                                  const std::string& context_id,
+                                  const std::vector<int32_t>& ids) {
+  registry_.Remove(web_contents_id, context_id, ids);
+}
+
+void RemoteObjectRegistry::ClearContext(int web_contents_id,
+                                        const std::string& context_id) {
+  registry_.ClearContext(web_contents_id, context_id);
+}
+
+void RemoteObjectRegistry::ClearWebContents(int web_contents_id) {
+  registry_.ClearWebContents(web_contents_id);
+}
+
+v8::Local<v8::Value> RemoteObjectRegistry::GetStats(v8::Isolate* isolate,
+                                                    int web_contents_id) {
+  atom::RemoteObjectRegistry::Stats stats =
+      registry_.GetStats(isolate, web_contents_id);
+
+  std::vector<mate::Dictionary> contexts;
+  for (const auto& context : stats.contexts) {
+    mate::Dictionary dict = mate::Dictionary::CreateEmpty(isolate);
+    dict.Set("contextId", context.context_id);
+    dict.Set("generation", context.generation);
+    dict.Set("count", static_cast<double>(context.count));
+    contexts.push_back(dict);
+  }
+
+  std::vector<mate::Dictionary> constructors;
+  for (const auto& constructor : stats.constructors) {
+    mate::Dictionary dict = mate::Dictionary::CreateEmpty(isolate);
+    dict.Set("name", constructor.first);
+    dict.Set("count", static_cast<double>(constructor.second));
+    constructors.push_back(dict);
+  }
+
+  mate::Dictionary dict = mate::Dictionary::CreateEmpty(isolate);
+  dict.Set("count", static_cast<double>(stats.count));
+  dict.Set("bytes", static_cast<double>(stats.bytes));
+  dict.Set("contexts", contexts);
+  dict.Set("constructors", constructors);
+  return dict.GetHandle();
+}
+
+double RemoteObjectRegistry::GetSize() const {
+  return registry_.size();
+}
+
+// static
+mate::Handle<RemoteObjectRegistry> RemoteObjectRegistry::Create(
+    v8::Isolate* isolate) {
+  return mate::CreateHandle(isolate, new RemoteObjectRegistry(isolate));
+}
+
+// static
+void RemoteObjectRegistry::BuildPrototype(
+    v8::Isolate* isolate, v8::Local<v8::ObjectTemplate> prototype) {
+  mate::ObjectTemplateBuilder(isolate, prototype)
+      .SetMethod("add", &RemoteObjectRegistry::Add)
+      .SetMethod("get", &RemoteObjectRegistry::Get)
+      .SetMethod("remove", &RemoteObjectRegistry::Remove)
+      .SetMethod("clearContext", &RemoteObjectRegistry::ClearContext)
+      .SetMethod("clearWebContents", &RemoteObjectRegistry::ClearWebContents)
+      .SetMethod("getStats", &RemoteObjectRegistry::GetStats)
+      .SetProperty("size", &RemoteObjectRegistry::GetSize);
+}
+
+}  // namespace api
+
+}  // namespace atom
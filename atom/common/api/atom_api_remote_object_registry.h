@@ -0,0 +1,54 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_COMMON_API_ATOM_API_REMOTE_OBJECT_REGISTRY_H_
+#define ATOM_COMMON_API_ATOM_API_REMOTE_OBJECT_REGISTRY_H_
+
+#include <string>
+#include <vector>
+
+#include "atom/common/remote_object_registry.h"
+#include "native_mate/handle.h"
+#include "native_mate/wrappable.h"
+
+namespace atom {
+
+namespace api {
+
+class RemoteObjectRegistry : public mate::Wrappable<RemoteObjectRegistry> {
+ public:
+  static mate::Handle<RemoteObjectRegistry> Create(v8::Isolate* isolate);
+
+  static void BuildPrototype(v8::Isolate* isolate,
+                             v8::Local<v8::ObjectTemplate> prototype);
+
+ protected:
+  explicit RemoteObjectRegistry(v8::Isolate* isolate);
+  ~RemoteObjectRegistry() override;
+
+ private:
+  // API for RemoteObjectRegistry.
+  int32_t Add(v8::Isolate* isolate,
+              int web_contents_id,
+              const std::string& context_id,
+              v8::Local<v8::Object> object);
+  v8::Local<v8::Value> Get(v8::Isolate* isolate, int32_t id);
+  void Remove(int web_contents_id,
+              const std::string& context_id,
+              const std::vector<int32_t>& ids);
+  void ClearContext(int web_contents_id, const std::string& context_id);
+  void ClearWebContents(int web_contents_id);
+  v8::Local<v8::Value> GetStats(v8::Isolate* isolate, int web_contents_id);
+  double GetSize() const;
+
+  atom::RemoteObjectRegistry registry_;
+
+  DISALLOW_COPY_AND_ASSIGN(RemoteObjectRegistry);
+};
+
+}  // namespace api
+
+}  // namespace atom
+
+#endif  // ATOM_COMMON_API_ATOM_API_REMOTE_OBJECT_REGISTRY_H_
@@ -6,9 +6,11 @@
 #include <utility>
 
 #include "atom/common/api/atom_api_key_weak_map.h"
+#include "atom/common/api/atom_api_remote_object_registry.h"
 #include "atom/common/api/remote_callback_freer.h"
 #include "atom/common/api/remote_object_freer.h"
 #include "atom/common/native_mate_converters/content_converter.h"
+#include "atom/common/native_mate_converters/v8_value_serializer.h"
 #include "atom/common/node_includes.h"
 #include "base/hash.h"
 #include "native_mate/dictionary.h"
@@ -88,10 +90,64 @@ int32_t GetObjectHash(v8::Local<v8::Object> object) {
   return object->GetIdentityHash();
 }
 
+// Whether |value| is an array that only holds null, booleans, numbers,
+// strings and arrays of them, which can be sent to renderers as JSON.
+bool IsPlainArray(v8::Local<v8::Context> context,
+                  v8::Local<v8::Value> value,
+                  int depth) {
+  if (!value->IsArray() || depth > 32)
+    return false;
+  v8::Local<v8::Array> array = value.As<v8::Array>();
+  for (uint32_t i = 0; i < array->Length(); ++i) {
+    v8::Local<v8::Value> element;
+    if (!array->Get(context, i).ToLocal(&element))
+      return false;
+    if (element->IsNull() || element->IsBoolean() || element->IsNumber() ||
+        element->IsString())
+      continue;
+    if (!IsPlainArray(context, element, depth + 1))
+      return false;
+  }
+  return true;
+}
+
+bool IsPlainValue(v8::Isolate* isolate, v8::Local<v8::Value> value) {
+  v8::TryCatch try_catch(isolate);
+  return IsPlainArray(isolate->GetCurrentContext(), value, 0);
+}
+
 void TakeHeapSnapshot(v8::Isolate* isolate) {
   isolate->GetHeapProfiler()->TakeHeapSnapshot();
 }
 
+void SetSharedMemoryThreshold(uint32_t threshold) {
+  atom::SetSharedMemoryThreshold(threshold);
+}
+
+uint32_t GetSharedMemoryThreshold() {
+  return atom::GetSharedMemoryThreshold();
+}
+
+v8::Local<v8::Value> ReleaseStatsToV8(v8::Isolate* isolate,
+                                      const atom::RemoteReleaseStats& stats) {
+  mate::Dictionary dict = mate::Dictionary::CreateEmpty(isolate);
+  dict.Set("batches", static_cast<double>(stats.batches));
+  dict.Set("released", static_cast<double>(stats.released));
+  dict.Set("largestBatch", static_cast<double>(stats.largest_batch));
+  return dict.GetHandle();
+}
+
+// Counters of the release messages sent by this process, for remote objects
+// in renderers and for callbacks in the browser.
+v8::Local<v8::Value> GetRemoteReleaseStats(v8::Isolate* isolate) {
+  mate::Dictionary dict = mate::Dictionary::CreateEmpty(isolate);
+  dict.Set("objects", ReleaseStatsToV8(
+      isolate, atom::RemoteObjectFreer::GetReleaseStats()));
+  dict.Set("callbacks", ReleaseStatsToV8(
+      isolate, atom::RemoteCallbackFreer::GetReleaseStats()));
+  return dict.GetHandle();
+}
+
 void Initialize(v8::Local<v8::Object> exports, v8::Local<v8::Value> unused,
                 v8::Local<v8::Context> context, void* priv) {
   mate::Dictionary dict(context->GetIsolate(), exports);
@@ -99,12 +155,18 @@ void Initialize(v8::Local<v8::Object> exports, v8::Local<v8::Value> unused,
   dict.SetMethod("setHiddenValue", &SetHiddenValue);
   dict.SetMethod("deleteHiddenValue", &DeleteHiddenValue);
   dict.SetMethod("getObjectHash", &GetObjectHash);
+  dict.SetMethod("isPlainValue", &IsPlainValue);
   dict.SetMethod("takeHeapSnapshot", &TakeHeapSnapshot);
+  dict.SetMethod("setSharedMemoryThreshold", &SetSharedMemoryThreshold);
+  dict.SetMethod("getSharedMemoryThreshold", &GetSharedMemoryThreshold);
   dict.SetMethod("setRemoteCallbackFreer", &atom::RemoteCallbackFreer::BindTo);
   dict.SetMethod("setRemoteObjectFreer", &atom::RemoteObjectFreer::BindTo);
+  dict.SetMethod("getRemoteReleaseStats", &GetRemoteReleaseStats);
   dict.SetMethod("createIDWeakMap", &atom::api::KeyWeakMap<int32_t>::Create);
   dict.SetMethod("createDoubleIDWeakMap",
                  &atom::api::KeyWeakMap<std::pair<int32_t, int32_t>>::Create);
+  dict.SetMethod("createRemoteObjectRegistry",
+                 &atom::api::RemoteObjectRegistry::Create);
 }
 
 }  // namespace
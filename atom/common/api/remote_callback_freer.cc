@@ -4,44 +4,184 @@
 
 #include "atom/common/api/remote_callback_freer.h"
 
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "atom/common/api/api_messages.h"
+#include "base/bind.h"
+#include "base/lazy_instance.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/timer/timer.h"
 #include "base/values.h"
+#include "content/public/browser/render_view_host.h"
+#include "content/public/browser/web_contents.h"
 
 namespace atom {
 
+namespace {
+
+// The released callbacks are sent after this delay, or once there are this
+// many of them for a WebContents.
+const int kReleaseDelayMs = 100;
+const size_t kMaxPendingReleases = 256;
+
+base::LazyInstance<RemoteReleaseStats>::Leaky g_release_stats =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Collects the callbacks of a WebContents garbage collected in a short
+// period, so each renderer is told about them with one message. The ids are
+// kept per view, since the callbacks of each renderer are numbered on their
+// own.
+class PendingReleases : public content::WebContentsObserver {
+ public:
+  static PendingReleases* FromWebContents(content::WebContents* web_contents,
+                                          bool create);
+
+  void Add(content::RenderViewHost* render_view_host, int object_id) {
+    ids_[render_view_host].push_back(object_id);
+    if (++count_ >= kMaxPendingReleases) {
+      Flush();
+    } else if (!timer_.IsRunning()) {
+      timer_.Start(FROM_HERE,
+                   base::TimeDelta::FromMilliseconds(kReleaseDelayMs),
+                   base::Bind(&PendingReleases::Flush,
+                              base::Unretained(this)));
+    }
+  }
+
+  // The callback got a new function before its release was sent, so the
+  // renderer must keep it.
+  void Cancel(content::RenderViewHost* render_view_host, int object_id) {
+    auto view = ids_.find(render_view_host);
+    if (view == ids_.end())
+      return;
+    std::vector<int>& ids = view->second;
+    auto it = std::find(ids.begin(), ids.end(), object_id);
+    if (it == ids.end())
+      return;
+    ids.erase(it);
+    --count_;
+  }
+
+  void Flush() {
+    timer_.Stop();
+    base::string16 channel =
+        base::ASCIIToUTF16("ELECTRON_RENDERER_RELEASE_CALLBACK");
+    for (const auto& view : ids_) {
+      if (view.second.empty())
+        continue;
+      base::ListValue args;
+      std::unique_ptr<base::ListValue> ids(new base::ListValue);
+      for (int id : view.second)
+        ids->AppendInteger(id);
+      args.Append(std::move(ids));
+      content::RenderViewHost* render_view_host = view.first;
+      render_view_host->Send(new AtomViewMsg_Message(
+          render_view_host->GetRoutingID(), false, channel, args));
+      g_release_stats.Get().RecordBatch(view.second.size());
+    }
+    ids_.clear();
+    count_ = 0;
+  }
+
+ protected:
+  // content::WebContentsObserver:
+  void RenderViewDeleted(content::RenderViewHost* render_view_host) override {
+    // The callbacks are gone with the view's renderer.
+    auto view = ids_.find(render_view_host);
+    if (view == ids_.end())
+      return;
+    count_ -= view->second.size();
+    ids_.erase(view);
+    if (ids_.empty())
+      timer_.Stop();
+  }
+
+  void WebContentsDestroyed() override;
+
+ private:
+  explicit PendingReleases(content::WebContents* web_contents)
+      : content::WebContentsObserver(web_contents), count_(0) {}
+  ~PendingReleases() override {}
+
+  // (RenderViewHost) => [object ids]
+  std::map<content::RenderViewHost*, std::vector<int>> ids_;
+  size_t count_;
+  base::OneShotTimer timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(PendingReleases);
+};
+
+// (WebContents) => PendingReleases
+base::LazyInstance<std::map<content::WebContents*, PendingReleases*>>::Leaky
+    g_pending_releases = LAZY_INSTANCE_INITIALIZER;
+
+// static
+PendingReleases* PendingReleases::FromWebContents(
+    content::WebContents* web_contents, bool create) {
+  auto& pending_releases = g_pending_releases.Get();
+  auto it = pending_releases.find(web_contents);
+  if (it != pending_releases.end())
+    return it->second;
+  if (!create)
+    return nullptr;
+  PendingReleases* self = new PendingReleases(web_contents);
+  pending_releases[web_contents] = self;
+  return self;
+}
+
+void PendingReleases::WebContentsDestroyed() {
+  g_pending_releases.Get().erase(web_contents());
+  delete this;
+}
+
+}  // namespace
+
 // static
 void RemoteCallbackFreer::BindTo(v8::Isolate* isolate,
                                  v8::Local<v8::Object> target,
                                  int object_id,
                                  content::WebContents* web_contents) {
+  PendingReleases* pending_releases =
+      PendingReleases::FromWebContents(web_contents, false);
+  if (pending_releases)
+    pending_releases->Cancel(web_contents->GetRenderViewHost(), object_id);
   new RemoteCallbackFreer(isolate, target, object_id, web_contents);
 }
 
+// static
+RemoteReleaseStats RemoteCallbackFreer::GetReleaseStats() {
+  return g_release_stats.Get();
+}
+
 RemoteCallbackFreer::RemoteCallbackFreer(v8::Isolate* isolate,
                                          v8::Local<v8::Object> target,
                                          int object_id,
                                          content::WebContents* web_contents)
     : ObjectLifeMonitor(isolate, target),
       content::WebContentsObserver(web_contents),
-      object_id_(object_id) {
+      object_id_(object_id),
+      render_view_host_(web_contents->GetRenderViewHost()) {
 }
 
 RemoteCallbackFreer::~RemoteCallbackFreer() {
 }
 
 void RemoteCallbackFreer::RunDestructor() {
-  base::string16 channel =
-      base::ASCIIToUTF16("ELECTRON_RENDERER_RELEASE_CALLBACK");
-  base::ListValue args;
-  args.AppendInteger(object_id_);
-  Send(new AtomViewMsg_Message(routing_id(), false, channel, args));
+  if (web_contents())
+    PendingReleases::FromWebContents(web_contents(), true)->Add(
+        render_view_host_, object_id_);
 
   Observe(nullptr);
 }
 
-void RemoteCallbackFreer::RenderViewDeleted(content::RenderViewHost*) {
-  delete this;
+void RemoteCallbackFreer::RenderViewDeleted(
+    content::RenderViewHost* render_view_host) {
+  if (render_view_host == render_view_host_)
+    delete this;
 }
 
 }  // namespace atom
@@ -5,6 +5,7 @@
 #ifndef ATOM_COMMON_API_REMOTE_CALLBACK_FREER_H_
 #define ATOM_COMMON_API_REMOTE_CALLBACK_FREER_H_
 #include "atom/common/api/object_life_monitor.h"
+#include "atom/common/api/remote_release_stats.h"
 #include "content/public/browser/web_contents_observer.h"
 
 namespace atom {
@@ -17,6 +18,8 @@ class RemoteCallbackFreer : public ObjectLifeMonitor,
                      int object_id,
                      content::WebContents* web_conents);
 
+  static RemoteReleaseStats GetReleaseStats();
+
  protected:
   RemoteCallbackFreer(v8::Isolate* isolate,
                       v8::Local<v8::Object> target,
@@ -27,10 +30,12 @@ class RemoteCallbackFreer : public ObjectLifeMonitor,
   void RunDestructor() override;
 
   // content::WebContentsObserver:
-  void RenderViewDeleted(content::RenderViewHost*) override;
+  void RenderViewDeleted(content::RenderViewHost* render_view_host) override;
 
  private:
   int object_id_;
+  // The view of the renderer that owns the callback.
+  content::RenderViewHost* render_view_host_;
 
   DISALLOW_COPY_AND_ASSIGN(RemoteCallbackFreer);
 };
@@ -4,9 +4,20 @@
 
 #include "atom/common/api/remote_object_freer.h"
 
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "atom/common/api/api_messages.h"
+#include "base/bind.h"
+#include "base/lazy_instance.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/timer/timer.h"
 #include "base/values.h"
+#include "content/public/renderer/render_thread.h"
 #include "content/public/renderer/render_view.h"
 #include "third_party/WebKit/public/web/WebLocalFrame.h"
 #include "third_party/WebKit/public/web/WebView.h"
@@ -18,6 +29,11 @@ namespace atom {
 
 namespace {
 
+// The released objects are sent after this delay, or once there are this many
+// of them.
+const int kReleaseDelayMs = 100;
+const size_t kMaxPendingReleases = 256;
+
 content::RenderView* GetCurrentRenderView() {
   WebLocalFrame* frame = WebLocalFrame::frameForCurrentContext();
   if (!frame)
@@ -30,17 +46,103 @@ content::RenderView* GetCurrentRenderView() {
   return content::RenderView::FromWebView(view);
 }
 
+// Collects the remote objects garbage collected in a short period, so the
+// browser is told about them with one message per context.
+class PendingReleases {
+ public:
+  PendingReleases() : count_(0) {}
+
+  void Add(int routing_id, const std::string& context_id, int object_id) {
+    Batch& batch = batches_[context_id];
+    batch.routing_id = routing_id;
+    batch.ids.push_back(object_id);
+    if (++count_ >= kMaxPendingReleases) {
+      Flush();
+    } else if (!timer_.IsRunning()) {
+      timer_.Start(FROM_HERE,
+                   base::TimeDelta::FromMilliseconds(kReleaseDelayMs),
+                   base::Bind(&PendingReleases::Flush,
+                              base::Unretained(this)));
+    }
+  }
+
+  // The object got a new remote object before its release was sent, so the
+  // browser must keep it.
+  void Cancel(const std::string& context_id, int object_id) {
+    auto batch = batches_.find(context_id);
+    if (batch == batches_.end())
+      return;
+    std::vector<int>& ids = batch->second.ids;
+    auto it = std::find(ids.begin(), ids.end(), object_id);
+    if (it == ids.end())
+      return;
+    ids.erase(it);
+    count_--;
+  }
+
+  void Flush() {
+    timer_.Stop();
+    base::string16 channel = base::ASCIIToUTF16("ipc-message");
+    for (const auto& batch : batches_) {
+      if (batch.second.ids.empty())
+        continue;
+      base::ListValue args;
+      args.AppendString("ELECTRON_BROWSER_DEREFERENCE");
+      args.AppendString(batch.first);
+      std::unique_ptr<base::ListValue> ids(new base::ListValue);
+      for (int id : batch.second.ids)
+        ids->AppendInteger(id);
+      args.Append(std::move(ids));
+      content::RenderThread::Get()->Send(new AtomViewHostMsg_Message(
+          batch.second.routing_id, channel, args));
+      stats_.RecordBatch(batch.second.ids.size());
+    }
+    batches_.clear();
+    count_ = 0;
+  }
+
+  const RemoteReleaseStats& stats() const { return stats_; }
+
+ private:
+  struct Batch {
+    int routing_id;
+    std::vector<int> ids;
+  };
+
+  // (context_id) => Batch
+  std::map<std::string, Batch> batches_;
+  size_t count_;
+  base::OneShotTimer timer_;
+  RemoteReleaseStats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(PendingReleases);
+};
+
+base::LazyInstance<PendingReleases>::Leaky g_pending_releases =
+    LAZY_INSTANCE_INITIALIZER;
+
 }  // namespace
 
 // static
-void RemoteObjectFreer::BindTo(
-    v8::Isolate* isolate, v8::Local<v8::Object> target, int object_id) {
-  new RemoteObjectFreer(isolate, target, object_id);
+void RemoteObjectFreer::BindTo(v8::Isolate* isolate,
+                               v8::Local<v8::Object> target,
+                               const std::string& context_id,
+                               int object_id) {
+  g_pending_releases.Get().Cancel(context_id, object_id);
+  new RemoteObjectFreer(isolate, target, context_id, object_id);
+}
+
+// static
+RemoteReleaseStats RemoteObjectFreer::GetReleaseStats() {
+  return g_pending_releases.Get().stats();
 }
 
-RemoteObjectFreer::RemoteObjectFreer(
-    v8::Isolate* isolate, v8::Local<v8::Object> target, int object_id)
+RemoteObjectFreer::RemoteObjectFreer(v8::Isolate* isolate,
+                                     v8::Local<v8::Object> target,
+                                     const std::string& context_id,
+                                     int object_id)
     : ObjectLifeMonitor(isolate, target),
+      context_id_(context_id),
       object_id_(object_id) {
 }
 
@@ -52,12 +154,8 @@ void RemoteObjectFreer::RunDestructor() {
   if (!render_view)
     return;
 
-  base::string16 channel = base::ASCIIToUTF16("ipc-message");
-  base::ListValue args;
-  args.AppendString("ELECTRON_BROWSER_DEREFERENCE");
-  args.AppendInteger(object_id_);
-  render_view->Send(
-      new AtomViewHostMsg_Message(render_view->GetRoutingID(), channel, args));
+  g_pending_releases.Get().Add(render_view->GetRoutingID(), context_id_,
+                               object_id_);
 }
 
 }  // namespace atom
@@ -0,0 +1,33 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_COMMON_API_REMOTE_RELEASE_STATS_H_
+#define ATOM_COMMON_API_REMOTE_RELEASE_STATS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+
+namespace atom {
+
+// Counters of the batched messages that release remote objects or callbacks
+// once they are garbage collected.
+struct RemoteReleaseStats {
+  RemoteReleaseStats() : batches(0), released(0), largest_batch(0) {}
+
+  void RecordBatch(size_t size) {
+    batches++;
+    released += size;
+    largest_batch = std::max<uint64_t>(largest_batch, size);
+  }
+
+  uint64_t batches;
+  uint64_t released;
+  uint64_t largest_batch;
+};
+
+}  // namespace atom
+
+#endif  // ATOM_COMMON_API_REMOTE_RELEASE_STATS_H_
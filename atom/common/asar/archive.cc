@@ -4,17 +4,25 @@
 
 #include "atom/common/asar/archive.h"
 
+#include <string.h>
+
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "atom/common/asar/archive_index.h"
+#include "atom/common/asar/asar_util.h"
+#include "atom/common/asar/prefetch_profile.h"
 #include "atom/common/asar/scoped_temporary_file.h"
 #include "base/files/file.h"
 #include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
 #include "base/logging.h"
 #include "base/pickle.h"
 #include "base/json/json_reader.h"
-#include "base/strings/string_number_conversions.h"
 #include "base/values.h"
+#include "crypto/sha2.h"
+#include "third_party/zlib/zlib.h"
 
 #if defined(OS_WIN)
 #include "atom/node/osfhandle.h"
@@ -24,94 +32,58 @@ namespace asar {
 
 namespace {
 
-#if defined(OS_WIN)
-const char kSeparators[] = "\\/";
-#else
-const char kSeparators[] = "/";
-#endif
-
-bool GetNodeFromPath(std::string path,
-                     const base::DictionaryValue* root,
-                     const base::DictionaryValue** out);
-
-// Gets the "files" from "dir".
-bool GetFilesNode(const base::DictionaryValue* root,
-                  const base::DictionaryValue* dir,
-                  const base::DictionaryValue** out) {
-  // Test for symbol linked directory.
-  std::string link;
-  if (dir->GetStringWithoutPathExpansion("link", &link)) {
-    const base::DictionaryValue* linked_node = nullptr;
-    if (!GetNodeFromPath(link, root, &linked_node))
-      return false;
-    dir = linked_node;
-  }
-
-  return dir->GetDictionaryWithoutPathExpansion("files", out);
-}
-
-// Gets sub-file "name" from "dir".
-bool GetChildNode(const base::DictionaryValue* root,
-                  const std::string& name,
-                  const base::DictionaryValue* dir,
-                  const base::DictionaryValue** out) {
-  if (name == "") {
-    *out = root;
-    return true;
-  }
+// Keeps the mapped archive alive while views of it are in use.
+class MappedArchive : public base::RefCountedMemory {
+ public:
+  explicit MappedArchive(std::unique_ptr<base::MemoryMappedFile> file)
+      : file_(std::move(file)) {}
 
-  const base::DictionaryValue* files = nullptr;
-  return GetFilesNode(root, dir, &files) &&
-         files->GetDictionaryWithoutPathExpansion(name, out);
-}
+  // base::RefCountedMemory:
+  const unsigned char* front() const override { return file_->data(); }
+  size_t size() const override { return file_->length(); }
 
-// Gets the node of "path" from "root".
-bool GetNodeFromPath(std::string path,
-                     const base::DictionaryValue* root,
-                     const base::DictionaryValue** out) {
-  if (path == "") {
-    *out = root;
-    return true;
-  }
-
-  const base::DictionaryValue* dir = root;
-  for (size_t delimiter_position = path.find_first_of(kSeparators);
-       delimiter_position != std::string::npos;
-       delimiter_position = path.find_first_of(kSeparators)) {
-    const base::DictionaryValue* child = nullptr;
-    if (!GetChildNode(root, path.substr(0, delimiter_position), dir, &child))
-      return false;
+ private:
+  ~MappedArchive() override {}
 
-    dir = child;
-    path.erase(0, delimiter_position + 1);
-  }
+  std::unique_ptr<base::MemoryMappedFile> file_;
 
-  return GetChildNode(root, path, dir, out);
-}
+  DISALLOW_COPY_AND_ASSIGN(MappedArchive);
+};
 
 bool FillFileInfoWithNode(Archive::FileInfo* info,
-                          uint32_t header_size,
-                          const base::DictionaryValue* node) {
-  int size;
-  if (!node->GetInteger("size", &size))
+                          const ArchiveIndex::Node* node) {
+  if (node->type != ArchiveIndex::NODE_FILE ||
+      (node->flags & ArchiveIndex::FLAG_INVALID))
     return false;
-  info->size = static_cast<uint32_t>(size);
 
-  if (node->GetBoolean("unpacked", &info->unpacked) && info->unpacked)
+  info->size = node->size;
+  info->unpacked = (node->flags & ArchiveIndex::FLAG_UNPACKED) != 0;
+  if (info->unpacked)
     return true;
 
-  std::string offset;
-  if (!node->GetString("offset", &offset))
-    return false;
-  if (!base::StringToUint64(offset, &info->offset))
-    return false;
-  info->offset += header_size;
-
-  node->GetBoolean("executable", &info->executable);
-
+  info->offset = node->offset;
+  info->executable = (node->flags & ArchiveIndex::FLAG_EXECUTABLE) != 0;
+  info->compressed = (node->flags & ArchiveIndex::FLAG_GZIP) != 0;
+  info->compressed_size = node->compressed_size;
   return true;
 }
 
+// Inflates the gzip stream in |input| into exactly |size| bytes of |output|.
+bool GunzipToBuffer(const base::StringPiece& input,
+                    char* output,
+                    uint32_t size) {
+  z_stream stream = {};
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+    return false;
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  stream.avail_in = static_cast<uInt>(input.size());
+  stream.next_out = reinterpret_cast<Bytef*>(output);
+  stream.avail_out = size;
+  int result = inflate(&stream, Z_FINISH);
+  inflateEnd(&stream);
+  return result == Z_STREAM_END && stream.avail_out == 0;
+}
+
 }  // namespace
 
 Archive::Archive(const base::FilePath& path)
@@ -178,6 +150,23 @@ bool Archive::Init() {
     return false;
   }
 
+  header_size_ = 8 + size;
+  RecordArchiveRead(path_, 0, header_size_);
+
+  // Map the index written by an earlier process when it is still fresh, so
+  // the JSON header only gets parsed once per archive.
+  ArchiveIndex::Key key = {};
+  base::FilePath index_path;
+  bool use_index_file = GetIndexFileKey(header, &key) &&
+                        GetArchiveCacheFilePath(path_, "index", &index_path);
+  if (use_index_file) {
+    index_ = ArchiveIndex::CreateFromFile(index_path, key);
+    if (index_) {
+      MapArchive();
+      return true;
+    }
+  }
+
   std::string error;
   base::JSONReader reader;
   std::unique_ptr<base::Value> value(reader.ReadToValue(header));
@@ -186,81 +175,113 @@ bool Archive::Init() {
     return false;
   }
 
-  header_size_ = 8 + size;
-  header_.reset(static_cast<base::DictionaryValue*>(value.release()));
+  index_ = ArchiveIndex::Create(
+      *static_cast<base::DictionaryValue*>(value.get()), header_size_);
+  if (!index_) {
+    LOG(ERROR) << "Failed to index header of " << path_.value();
+    return false;
+  }
+
+  // Failing to write the index is not fatal, the next process just parses
+  // the header again.
+  if (use_index_file)
+    index_->WriteToFile(index_path, key);
+
+  MapArchive();
   return true;
 }
 
-bool Archive::GetFileInfo(const base::FilePath& path, FileInfo* info) {
-  if (!header_)
+bool Archive::GetIndexFileKey(const std::string& header,
+                              ArchiveIndex::Key* key) {
+  base::File::Info info;
+  if (!file_.GetInfo(&info))
     return false;
+  key->archive_size = static_cast<uint64_t>(info.size);
+  key->archive_mtime = info.last_modified.ToInternalValue();
+  key->header_size = header_size_;
+  crypto::SHA256HashString(header, key->header_hash,
+                           sizeof(key->header_hash));
+  return true;
+}
 
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
-    return false;
+void Archive::MapArchive() {
+  std::unique_ptr<base::MemoryMappedFile> mapped_file(
+      new base::MemoryMappedFile);
+  if (!mapped_file->Initialize(file_.Duplicate())) {
+    LOG(WARNING) << "Failed to map " << path_.value();
+    return;
+  }
+  mapping_ = new MappedArchive(std::move(mapped_file));
+}
 
-  std::string link;
-  if (node->GetString("link", &link))
-    return GetFileInfo(base::FilePath::FromUTF8Unsafe(link), info);
+bool Archive::GetFileInfo(const base::FilePath& path, FileInfo* info) {
+  if (!index_)
+    return false;
 
-  return FillFileInfoWithNode(info, header_size_, node);
+  const ArchiveIndex::Node* node = index_->Lookup(path);
+  for (int depth = 0; node && node->type == ArchiveIndex::NODE_LINK;
+       ++depth) {
+    if (depth >= ArchiveIndex::kMaxLinkDepth)
+      return false;
+    node = index_->Lookup(index_->GetLink(node));
+  }
+  return node && FillFileInfoWithNode(info, node);
 }
 
 bool Archive::Stat(const base::FilePath& path, Stats* stats) {
-  if (!header_)
+  if (!index_)
     return false;
 
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
+  const ArchiveIndex::Node* node = index_->Lookup(path);
+  if (!node)
     return false;
 
-  if (node->HasKey("link")) {
+  if (node->type == ArchiveIndex::NODE_LINK) {
     stats->is_file = false;
     stats->is_link = true;
     return true;
   }
 
-  if (node->HasKey("files")) {
+  if (node->type == ArchiveIndex::NODE_DIRECTORY) {
     stats->is_file = false;
     stats->is_directory = true;
     return true;
   }
 
-  return FillFileInfoWithNode(stats, header_size_, node);
+  return FillFileInfoWithNode(stats, node);
 }
 
 bool Archive::Readdir(const base::FilePath& path,
                       std::vector<base::FilePath>* list) {
-  if (!header_)
+  if (!index_)
     return false;
 
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
+  const ArchiveIndex::Node* node = index_->Lookup(path);
+  if (node && node->type == ArchiveIndex::NODE_LINK)
+    node = index_->Lookup(index_->GetLink(node));
+  if (!node || node->type != ArchiveIndex::NODE_DIRECTORY)
     return false;
 
-  const base::DictionaryValue* files;
-  if (!GetFilesNode(header_.get(), node, &files))
-    return false;
-
-  base::DictionaryValue::Iterator iter(*files);
-  while (!iter.IsAtEnd()) {
-    list->push_back(base::FilePath::FromUTF8Unsafe(iter.key()));
-    iter.Advance();
+  size_t count = index_->GetChildCount(node);
+  list->reserve(list->size() + count);
+  for (size_t i = 0; i < count; ++i) {
+    list->push_back(base::FilePath::FromUTF8Unsafe(
+        index_->GetName(index_->GetChild(node, i)).as_string()));
   }
   return true;
 }
 
 bool Archive::Realpath(const base::FilePath& path, base::FilePath* realpath) {
-  if (!header_)
+  if (!index_)
     return false;
 
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
+  const ArchiveIndex::Node* node = index_->Lookup(path);
+  if (!node)
     return false;
 
-  std::string link;
-  if (node->GetString("link", &link)) {
-    *realpath = base::FilePath::FromUTF8Unsafe(link);
+  if (node->type == ArchiveIndex::NODE_LINK) {
+    *realpath =
+        base::FilePath::FromUTF8Unsafe(index_->GetLink(node).as_string());
     return true;
   }
 
@@ -268,7 +289,13 @@ bool Archive::Realpath(const base::FilePath& path, base::FilePath* realpath) {
   return true;
 }
 
+bool Archive::HasExternalFiles() {
+  base::AutoLock auto_lock(external_files_lock_);
+  return !external_files_.empty();
+}
+
 bool Archive::CopyFileOut(const base::FilePath& path, base::FilePath* out) {
+  base::AutoLock auto_lock(external_files_lock_);
   if (external_files_.contains(path)) {
     *out = external_files_.get(path)->path();
     return true;
@@ -285,8 +312,18 @@ bool Archive::CopyFileOut(const base::FilePath& path, base::FilePath* out) {
 
   std::unique_ptr<ScopedTemporaryFile> temp_file(new ScopedTemporaryFile);
   base::FilePath::StringType ext = path.Extension();
-  if (!temp_file->InitFromFile(&file_, ext, info.offset, info.size))
+  base::StringPiece contents;
+  std::string decompressed;
+  if (info.compressed) {
+    if (!ReadFile(info, &decompressed) ||
+        !temp_file->InitFromData(ext, decompressed))
+      return false;
+  } else if (GetContents(info, &contents)) {
+    if (!temp_file->InitFromData(ext, contents))
+      return false;
+  } else if (!temp_file->InitFromFile(&file_, ext, info.offset, info.size)) {
     return false;
+  }
 
 #if defined(OS_POSIX)
   if (info.executable) {
@@ -300,6 +337,60 @@ bool Archive::CopyFileOut(const base::FilePath& path, base::FilePath* out) {
   return true;
 }
 
+bool Archive::GetContents(const FileInfo& info,
+                          base::StringPiece* contents) const {
+  if (!mapping_ || info.unpacked)
+    return false;
+  if (info.offset > mapping_->size() ||
+      info.stored_size() > mapping_->size() - info.offset)
+    return false;
+  *contents = base::StringPiece(
+      reinterpret_cast<const char*>(mapping_->front()) + info.offset,
+      info.stored_size());
+  return true;
+}
+
+bool Archive::ReadFile(const FileInfo& info, char* buffer) {
+  if (info.unpacked)
+    return false;
+
+  RecordArchiveRead(path_, info.offset, info.stored_size());
+
+  base::StringPiece stored;
+  std::vector<char> compressed;
+  if (!GetContents(info, &stored)) {
+    // Read from the file when the archive is not mapped.
+    char* dest = buffer;
+    if (info.compressed) {
+      compressed.resize(info.compressed_size);
+      dest = compressed.data();
+    }
+    int size = static_cast<int>(info.stored_size());
+    if (file_.Read(info.offset, dest, size) != size)
+      return false;
+    stored = base::StringPiece(dest, size);
+    if (!info.compressed)
+      return true;
+  }
+
+  if (info.compressed)
+    return info.size == 0 || GunzipToBuffer(stored, buffer, info.size);
+
+  memcpy(buffer, stored.data(), info.size);
+  return true;
+}
+
+bool Archive::ReadFile(const FileInfo& info, std::string* contents) {
+  contents->resize(info.size);
+  if (info.size == 0)
+    return !info.unpacked;
+  return ReadFile(info, &(*contents)[0]);
+}
+
+size_t Archive::GetHeaderMemoryUsage() const {
+  return index_ ? index_->GetMemoryUsage() : 0;
+}
+
 int Archive::GetFD() const {
   return fd_;
 }
@@ -6,30 +6,39 @@
 #define ATOM_COMMON_ASAR_ARCHIVE_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "atom/common/asar/archive_index.h"
 #include "base/containers/scoped_ptr_hash_map.h"
 #include "base/files/file.h"
 #include "base/files/file_path.h"
-
-namespace base {
-class DictionaryValue;
-}
+#include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
 
 namespace asar {
 
 class ScopedTemporaryFile;
 
 // This class represents an asar package, and provides methods to read
-// information from it.
+// information from it. After Init() succeeds it can be used from any thread.
 class Archive {
  public:
   struct FileInfo {
-    FileInfo() : unpacked(false), executable(false), size(0), offset(0) {}
+    FileInfo() : unpacked(false), executable(false), compressed(false),
+                 size(0), compressed_size(0), offset(0) {}
     bool unpacked;
     bool executable;
+    // The content is stored as a gzip stream.
+    bool compressed;
     uint32_t size;
+    uint32_t compressed_size;
     uint64_t offset;
+
+    // Number of bytes the content takes in the archive.
+    uint32_t stored_size() const { return compressed ? compressed_size : size; }
   };
 
   struct Stats : public FileInfo {
@@ -61,20 +70,46 @@ class Archive {
   // For unpacked file, this method will return its real path.
   bool CopyFileOut(const base::FilePath& path, base::FilePath* out);
 
+  // Whether files have been copied out, they are deleted with the archive.
+  bool HasExternalFiles();
+
+  // Returns a view of a packed file's stored content in the mapped archive,
+  // fails if the archive could not be mapped. Compressed files are returned
+  // as they are stored.
+  bool GetContents(const FileInfo& info, base::StringPiece* contents) const;
+
+  // Reads the |info.size| bytes of a packed file's content into |buffer|,
+  // decompressing it when needed.
+  bool ReadFile(const FileInfo& info, char* buffer);
+  bool ReadFile(const FileInfo& info, std::string* contents);
+
+  // Heap memory used by the parsed header.
+  size_t GetHeaderMemoryUsage() const;
+
   // Returns the file's fd.
   int GetFD() const;
 
   base::FilePath path() const { return path_; }
-  base::DictionaryValue* header() const { return header_.get(); }
+
+  // The mapped archive, views returned by GetContents stay valid as long as a
+  // reference to it is held.
+  scoped_refptr<base::RefCountedMemory> mapping() const { return mapping_; }
 
  private:
+  // Identifies the archive's current content for the persisted index.
+  bool GetIndexFileKey(const std::string& header, ArchiveIndex::Key* key);
+  // Maps the whole archive read-only, reads fall back to the file if fails.
+  void MapArchive();
+
   base::FilePath path_;
   base::File file_;
   int fd_;
   uint32_t header_size_;
-  std::unique_ptr<base::DictionaryValue> header_;
+  std::unique_ptr<ArchiveIndex> index_;
+  scoped_refptr<base::RefCountedMemory> mapping_;
 
   // Cached external temporary files.
+  base::Lock external_files_lock_;
   base::ScopedPtrHashMap<base::FilePath, std::unique_ptr<ScopedTemporaryFile>>
       external_files_;
 
@@ -0,0 +1,495 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/common/asar/archive_index.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "atom/common/asar/asar_util.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/values.h"
+#include "crypto/sha2.h"
+
+namespace asar {
+
+namespace {
+
+#if defined(OS_WIN)
+const char kSeparators[] = "\\/";
+#else
+const char kSeparators[] = "/";
+#endif
+
+// "ASRI" in little endian.
+const uint32_t kIndexFileMagic = 0x49525341;
+// Bump when the layout of the index file changes.
+const uint32_t kIndexFileVersion = 3;
+
+// Layout of an index file: the header, followed by the nodes, the children
+// table, the hash table and the string table.
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  ArchiveIndex::Key key;
+  uint32_t node_count;
+  uint32_t children_count;
+  uint32_t bucket_count;
+  uint32_t strings_size;
+  uint32_t has_links;
+  uint32_t padding;
+};
+
+static_assert(sizeof(ArchiveIndex::Key::header_hash) == crypto::kSHA256Length,
+              "Key should hold a SHA-256 hash");
+static_assert(sizeof(ArchiveIndex::Node) == 40,
+              "Node should be a tightly packed plain record");
+static_assert(sizeof(FileHeader) % 8 == 0,
+              "Nodes following the header should be 8 bytes aligned");
+
+inline char NormalizeSeparator(char c) {
+#if defined(OS_WIN)
+  return c == '\\' ? '/' : c;
+#else
+  return c;
+#endif
+}
+
+// FNV-1a, with separators normalized so "a\\b" and "a/b" hash the same on
+// Windows.
+uint32_t HashPath(const base::StringPiece& path) {
+  uint32_t hash = 2166136261u;
+  for (char c : path) {
+    hash ^= static_cast<uint8_t>(NormalizeSeparator(c));
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+bool PathEquals(const base::StringPiece& a, const base::StringPiece& b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (NormalizeSeparator(a[i]) != NormalizeSeparator(b[i]))
+      return false;
+  }
+  return true;
+}
+
+// Returns true if |path| has an empty component, which refers to the root.
+bool HasEmptyComponent(const base::StringPiece& path) {
+  if (path.empty())
+    return false;
+  char prev = '/';
+  for (char c : path) {
+    c = NormalizeSeparator(c);
+    if (c == '/' && prev == '/')
+      return true;
+    prev = c;
+  }
+  return prev == '/';
+}
+
+}  // namespace
+
+ArchiveIndex::ArchiveIndex()
+    : nodes_(nullptr),
+      node_count_(0),
+      children_(nullptr),
+      children_count_(0),
+      strings_(nullptr),
+      strings_size_(0),
+      buckets_(nullptr),
+      bucket_count_(0),
+      has_links_(false) {
+}
+
+ArchiveIndex::~ArchiveIndex() {
+}
+
+// static
+std::unique_ptr<ArchiveIndex> ArchiveIndex::Create(
+    const base::DictionaryValue& header, uint64_t header_size) {
+  std::unique_ptr<ArchiveIndex> index(new ArchiveIndex);
+  index->AddNode(header, std::string(), 0, header_size);
+  if (index->node_storage_[0].type != NODE_DIRECTORY)
+    return nullptr;
+  index->UseStorage();
+  index->BuildHashTable();
+  return index;
+}
+
+// static
+std::unique_ptr<ArchiveIndex> ArchiveIndex::CreateFromFile(
+    const base::FilePath& index_path, const Key& key) {
+  base::File index_file(index_path,
+                        base::File::FLAG_OPEN | base::File::FLAG_READ);
+  if (!IsArchiveCacheFileTrusted(index_file))
+    return nullptr;
+  std::unique_ptr<base::MemoryMappedFile> file(new base::MemoryMappedFile);
+  if (!file->Initialize(std::move(index_file)))
+    return nullptr;
+
+  const uint8_t* data = file->data();
+  size_t length = file->length();
+  if (length < sizeof(FileHeader))
+    return nullptr;
+
+  FileHeader file_header;
+  memcpy(&file_header, data, sizeof(file_header));
+  if (file_header.magic != kIndexFileMagic ||
+      file_header.version != kIndexFileVersion ||
+      file_header.key.archive_size != key.archive_size ||
+      file_header.key.archive_mtime != key.archive_mtime ||
+      file_header.key.header_size != key.header_size ||
+      memcmp(file_header.key.header_hash, key.header_hash,
+             sizeof(key.header_hash)) != 0)
+    return nullptr;
+
+  // Sizes are checked one by one so the sum can not overflow.
+  uint64_t expected = sizeof(FileHeader);
+  expected += static_cast<uint64_t>(file_header.node_count) * sizeof(Node);
+  expected += static_cast<uint64_t>(file_header.children_count) *
+              sizeof(uint32_t);
+  expected += static_cast<uint64_t>(file_header.bucket_count) *
+              sizeof(uint32_t);
+  expected += file_header.strings_size;
+  if (expected != length)
+    return nullptr;
+
+  std::unique_ptr<ArchiveIndex> index(new ArchiveIndex);
+  const uint8_t* p = data + sizeof(FileHeader);
+  index->nodes_ = reinterpret_cast<const Node*>(p);
+  index->node_count_ = file_header.node_count;
+  p += index->node_count_ * sizeof(Node);
+  index->children_ = reinterpret_cast<const uint32_t*>(p);
+  index->children_count_ = file_header.children_count;
+  p += index->children_count_ * sizeof(uint32_t);
+  index->buckets_ = reinterpret_cast<const uint32_t*>(p);
+  index->bucket_count_ = file_header.bucket_count;
+  p += index->bucket_count_ * sizeof(uint32_t);
+  index->strings_ = reinterpret_cast<const char*>(p);
+  index->strings_size_ = file_header.strings_size;
+  index->has_links_ = file_header.has_links != 0;
+  if (!index->Validate(key))
+    return nullptr;
+
+  index->mapped_file_ = std::move(file);
+  return index;
+}
+
+bool ArchiveIndex::WriteToFile(const base::FilePath& index_path,
+                               const Key& key) const {
+  FileHeader file_header = {};
+  file_header.magic = kIndexFileMagic;
+  file_header.version = kIndexFileVersion;
+  file_header.key = key;
+  file_header.node_count = static_cast<uint32_t>(node_count_);
+  file_header.children_count = static_cast<uint32_t>(children_count_);
+  file_header.bucket_count = static_cast<uint32_t>(bucket_count_);
+  file_header.strings_size = static_cast<uint32_t>(strings_size_);
+  file_header.has_links = has_links_ ? 1 : 0;
+
+  std::string data;
+  data.reserve(sizeof(FileHeader) + node_count_ * sizeof(Node) +
+               (children_count_ + bucket_count_) * sizeof(uint32_t) +
+               strings_size_);
+  data.append(reinterpret_cast<const char*>(&file_header),
+              sizeof(file_header));
+  data.append(reinterpret_cast<const char*>(nodes_),
+              node_count_ * sizeof(Node));
+  data.append(reinterpret_cast<const char*>(children_),
+              children_count_ * sizeof(uint32_t));
+  data.append(reinterpret_cast<const char*>(buckets_),
+              bucket_count_ * sizeof(uint32_t));
+  data.append(strings_, strings_size_);
+
+  if (!base::CreateDirectory(index_path.DirName()))
+    return false;
+  return base::ImportantFileWriter::WriteFileAtomically(index_path, data);
+}
+
+const ArchiveIndex::Node* ArchiveIndex::Lookup(
+    const base::FilePath& path) const {
+#if defined(OS_POSIX)
+  return LookupInternal(path.value(), 0);
+#else
+  return LookupInternal(path.AsUTF8Unsafe(), 0);
+#endif
+}
+
+const ArchiveIndex::Node* ArchiveIndex::Lookup(
+    const base::StringPiece& path) const {
+  return LookupInternal(path, 0);
+}
+
+size_t ArchiveIndex::GetMemoryUsage() const {
+  return node_storage_.capacity() * sizeof(Node) +
+         (children_storage_.capacity() + buckets_storage_.capacity()) *
+             sizeof(uint32_t) +
+         strings_storage_.capacity();
+}
+
+base::StringPiece ArchiveIndex::GetPath(const Node* node) const {
+  return base::StringPiece(strings_ + node->path_offset, node->path_length);
+}
+
+base::StringPiece ArchiveIndex::GetName(const Node* node) const {
+  return base::StringPiece(
+      strings_ + node->path_offset + node->path_length -
+          node->name_length,
+      node->name_length);
+}
+
+base::StringPiece ArchiveIndex::GetLink(const Node* node) const {
+  if (node->type != NODE_LINK)
+    return base::StringPiece();
+  return base::StringPiece(strings_ + node->data_offset, node->data_length);
+}
+
+size_t ArchiveIndex::GetChildCount(const Node* node) const {
+  return node->type == NODE_DIRECTORY ? node->data_length : 0;
+}
+
+const ArchiveIndex::Node* ArchiveIndex::GetChild(const Node* node,
+                                                 size_t i) const {
+  DCHECK_LT(i, GetChildCount(node));
+  return &nodes_[children_[node->data_offset + i]];
+}
+
+uint32_t ArchiveIndex::AddNode(const base::DictionaryValue& dict,
+                               const std::string& path,
+                               size_t name_length,
+                               uint64_t header_size) {
+  uint32_t index = static_cast<uint32_t>(node_storage_.size());
+  Node node = {};
+  node.path_offset = static_cast<uint32_t>(strings_storage_.size());
+  node.path_length = static_cast<uint32_t>(path.size());
+  node.name_length = static_cast<uint32_t>(name_length);
+  strings_storage_.append(path);
+
+  std::string link;
+  const base::DictionaryValue* files = nullptr;
+  if (dict.HasKey("link")) {
+    node.type = NODE_LINK;
+    dict.GetStringWithoutPathExpansion("link", &link);
+    node.data_offset = static_cast<uint32_t>(strings_storage_.size());
+    node.data_length = static_cast<uint32_t>(link.size());
+    strings_storage_.append(link);
+    has_links_ = true;
+  } else if (dict.HasKey("files")) {
+    node.type = NODE_DIRECTORY;
+    dict.GetDictionaryWithoutPathExpansion("files", &files);
+  } else {
+    node.type = NODE_FILE;
+    int size = 0;
+    std::string offset;
+    std::string compression;
+    bool unpacked = false;
+    bool executable = false;
+    if (!dict.GetInteger("size", &size) || size < 0) {
+      node.flags |= FLAG_INVALID;
+      size = 0;
+    } else if (dict.GetBoolean("unpacked", &unpacked) && unpacked) {
+      node.flags |= FLAG_UNPACKED;
+    } else if (!dict.GetString("offset", &offset) ||
+               !base::StringToUint64(offset, &node.offset)) {
+      node.flags |= FLAG_INVALID;
+    } else {
+      node.offset += header_size;
+      if (dict.GetBoolean("executable", &executable) && executable)
+        node.flags |= FLAG_EXECUTABLE;
+      if (dict.GetString("compression", &compression)) {
+        int compressed_size = 0;
+        if (compression == "gzip" &&
+            dict.GetInteger("compressedSize", &compressed_size) &&
+            compressed_size >= 0) {
+          node.flags |= FLAG_GZIP;
+          node.compressed_size = static_cast<uint32_t>(compressed_size);
+        } else {
+          node.flags |= FLAG_INVALID;
+        }
+      }
+    }
+    node.size = static_cast<uint32_t>(size);
+  }
+  node_storage_.push_back(node);
+
+  if (!files)
+    return index;
+
+  // Reserve a continuous range of children before recursing, the iteration
+  // order of DictionaryValue keeps them sorted by name.
+  std::vector<std::pair<const std::string*, const base::DictionaryValue*>> list;
+  for (base::DictionaryValue::Iterator iter(*files); !iter.IsAtEnd();
+       iter.Advance()) {
+    const base::DictionaryValue* child = nullptr;
+    if (iter.value().GetAsDictionary(&child))
+      list.push_back(std::make_pair(&iter.key(), child));
+  }
+  uint32_t first_child = static_cast<uint32_t>(children_storage_.size());
+  children_storage_.resize(children_storage_.size() + list.size());
+  node_storage_[index].data_offset = first_child;
+  node_storage_[index].data_length = static_cast<uint32_t>(list.size());
+
+  for (size_t i = 0; i < list.size(); ++i) {
+    const std::string& name = *list[i].first;
+    std::string child_path = path.empty() ? name : path + '/' + name;
+    children_storage_[first_child + i] =
+        AddNode(*list[i].second, child_path, name.size(), header_size);
+  }
+  return index;
+}
+
+void ArchiveIndex::BuildHashTable() {
+  size_t bucket_count = 16;
+  while (bucket_count < node_count_ * 2)
+    bucket_count <<= 1;
+  buckets_storage_.assign(bucket_count, 0);
+
+  size_t mask = bucket_count - 1;
+  for (size_t i = 0; i < node_count_; ++i) {
+    size_t slot = HashPath(GetPath(&nodes_[i])) & mask;
+    while (buckets_storage_[slot] != 0)
+      slot = (slot + 1) & mask;
+    buckets_storage_[slot] = static_cast<uint32_t>(i + 1);
+  }
+  buckets_ = buckets_storage_.data();
+  bucket_count_ = bucket_count;
+}
+
+void ArchiveIndex::UseStorage() {
+  nodes_ = node_storage_.data();
+  node_count_ = node_storage_.size();
+  children_ = children_storage_.data();
+  children_count_ = children_storage_.size();
+  strings_ = strings_storage_.data();
+  strings_size_ = strings_storage_.size();
+}
+
+bool ArchiveIndex::Validate(const Key& key) const {
+  if (node_count_ == 0 || nodes_[0].type != NODE_DIRECTORY)
+    return false;
+  // The probe sequence relies on the table never being full.
+  if (bucket_count_ <= node_count_ ||
+      (bucket_count_ & (bucket_count_ - 1)) != 0)
+    return false;
+
+  for (size_t i = 0; i < node_count_; ++i) {
+    const Node& node = nodes_[i];
+    if (node.path_offset > strings_size_ ||
+        node.path_length > strings_size_ - node.path_offset ||
+        node.name_length > node.path_length)
+      return false;
+    if (node.type == NODE_DIRECTORY) {
+      if (node.data_offset > children_count_ ||
+          node.data_length > children_count_ - node.data_offset)
+        return false;
+    } else if (node.type == NODE_LINK) {
+      if (node.data_offset > strings_size_ ||
+          node.data_length > strings_size_ - node.data_offset)
+        return false;
+    } else if (node.type == NODE_FILE) {
+      // The content read from the archive must follow the header.
+      if (node.flags & (FLAG_INVALID | FLAG_UNPACKED))
+        continue;
+      uint64_t stored_size =
+          (node.flags & FLAG_GZIP) ? node.compressed_size : node.size;
+      if (node.offset < key.header_size ||
+          node.offset > key.archive_size ||
+          stored_size > key.archive_size - node.offset)
+        return false;
+    } else {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < children_count_; ++i) {
+    if (children_[i] >= node_count_)
+      return false;
+  }
+  for (size_t i = 0; i < bucket_count_; ++i) {
+    if (buckets_[i] > node_count_)
+      return false;
+  }
+  return true;
+}
+
+const ArchiveIndex::Node* ArchiveIndex::LookupInternal(
+    const base::StringPiece& path, int depth) const {
+  const Node* node = LookupInHashTable(path);
+  if (node)
+    return node;
+
+  // The full path table only knows the canonical paths, a miss can still be
+  // a path through a linked directory or one with empty components.
+  if (!has_links_ && !HasEmptyComponent(path))
+    return nullptr;
+  return LookupByWalking(path, depth);
+}
+
+const ArchiveIndex::Node* ArchiveIndex::LookupInHashTable(
+    const base::StringPiece& path) const {
+  size_t mask = bucket_count_ - 1;
+  for (size_t slot = HashPath(path) & mask; buckets_[slot] != 0;
+       slot = (slot + 1) & mask) {
+    const Node* node = &nodes_[buckets_[slot] - 1];
+    if (PathEquals(GetPath(node), path))
+      return node;
+  }
+  return nullptr;
+}
+
+const ArchiveIndex::Node* ArchiveIndex::LookupByWalking(
+    const base::StringPiece& path, int depth) const {
+  const Node* dir = root();
+  size_t start = 0;
+  while (true) {
+    size_t end = path.find_first_of(kSeparators, start);
+    base::StringPiece name = end == base::StringPiece::npos ?
+        path.substr(start) : path.substr(start, end - start);
+    const Node* child = GetChildNode(dir, name, depth);
+    if (!child || end == base::StringPiece::npos)
+      return child;
+    dir = child;
+    start = end + 1;
+  }
+}
+
+const ArchiveIndex::Node* ArchiveIndex::GetChildNode(
+    const Node* dir, const base::StringPiece& name, int depth) const {
+  if (name.empty())
+    return root();
+
+  // Test for symbol linked directory.
+  if (dir->type == NODE_LINK) {
+    if (depth >= kMaxLinkDepth)
+      return nullptr;
+    dir = LookupInternal(GetLink(dir), depth + 1);
+    if (!dir)
+      return nullptr;
+  }
+
+  if (dir->type != NODE_DIRECTORY)
+    return nullptr;
+
+  const uint32_t* begin = children_ + dir->data_offset;
+  const uint32_t* end = begin + dir->data_length;
+  const uint32_t* it = std::lower_bound(
+      begin, end, name, [this](uint32_t i, const base::StringPiece& key) {
+        return GetName(&nodes_[i]) < key;
+      });
+  if (it == end || GetName(&nodes_[*it]) != name)
+    return nullptr;
+  return &nodes_[*it];
+}
+
+}  // namespace asar
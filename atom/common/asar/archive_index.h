@@ -0,0 +1,168 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_COMMON_ASAR_ARCHIVE_INDEX_H_
+#define ATOM_COMMON_ASAR_ARCHIVE_INDEX_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+class DictionaryValue;
+class FilePath;
+class MemoryMappedFile;
+}
+
+namespace asar {
+
+// A flat index built from the JSON header of an asar archive.
+//
+// All nodes live in one array, every node's full path is interned in a single
+// string table, and full paths are hashed into an open addressing table, so
+// looking up a path is a single probe sequence that does not allocate.
+//
+// The same layout is persisted to an index file, which later processes map
+// read-only instead of parsing the JSON header again.
+class ArchiveIndex {
+ public:
+  // Links pointing to links are followed at most this many times.
+  static const int kMaxLinkDepth = 32;
+
+  // Identifies the archive an index file was written for.
+  struct Key {
+    uint64_t archive_size;
+    int64_t archive_mtime;
+    uint32_t header_size;
+    // SHA-256 of the JSON header.
+    uint8_t header_hash[32];
+  };
+
+  enum NodeType : uint8_t {
+    NODE_FILE = 0,
+    NODE_DIRECTORY,
+    NODE_LINK,
+  };
+
+  enum NodeFlags : uint8_t {
+    FLAG_UNPACKED = 1 << 0,
+    FLAG_EXECUTABLE = 1 << 1,
+    // The file entry misses its size or offset.
+    FLAG_INVALID = 1 << 2,
+    // The content is stored as a gzip stream of |compressed_size| bytes.
+    FLAG_GZIP = 1 << 3,
+  };
+
+  // Plain record of one entry in the header.
+  struct Node {
+    // Full path of the node, stored in the string table.
+    uint32_t path_offset;
+    uint32_t path_length;
+    // The name is the trailing |name_length| bytes of the path.
+    uint32_t name_length;
+    uint8_t type;
+    uint8_t flags;
+    uint16_t reserved;
+    // Absolute offset of the content in the archive, header included.
+    uint64_t offset;
+    uint32_t size;
+    // For directories the range of children in the children table, for links
+    // the target path in the string table.
+    uint32_t data_offset;
+    uint32_t data_length;
+    // Size of the stored content of a compressed file.
+    uint32_t compressed_size;
+  };
+
+  ~ArchiveIndex();
+
+  // Builds the index from the parsed |header|, |header_size| is added to the
+  // offsets of all files.
+  static std::unique_ptr<ArchiveIndex> Create(
+      const base::DictionaryValue& header, uint64_t header_size);
+
+  // Maps the index file at |index_path|, returns nullptr when the file is
+  // missing, corrupted, not trusted or was written for another archive than
+  // |key|.
+  static std::unique_ptr<ArchiveIndex> CreateFromFile(
+      const base::FilePath& index_path, const Key& key);
+
+  // Writes the index to |index_path| atomically.
+  bool WriteToFile(const base::FilePath& index_path, const Key& key) const;
+
+  // Returns the node of |path|, links in the last component are not followed.
+  const Node* Lookup(const base::FilePath& path) const;
+  const Node* Lookup(const base::StringPiece& path) const;
+
+  const Node* root() const { return &nodes_[0]; }
+  size_t node_count() const { return node_count_; }
+  bool is_mapped() const { return !!mapped_file_; }
+
+  // Heap memory held by the index, a mapped index file holds none.
+  size_t GetMemoryUsage() const;
+
+  base::StringPiece GetPath(const Node* node) const;
+  base::StringPiece GetName(const Node* node) const;
+  base::StringPiece GetLink(const Node* node) const;
+
+  // Children of a directory node, sorted by name.
+  size_t GetChildCount(const Node* node) const;
+  const Node* GetChild(const Node* node, size_t i) const;
+
+ private:
+  ArchiveIndex();
+
+  // Appends |dict| and its children, returns the index of the new node.
+  uint32_t AddNode(const base::DictionaryValue& dict,
+                   const std::string& path,
+                   size_t name_length,
+                   uint64_t header_size);
+  void BuildHashTable();
+
+  // Points the views at the owned vectors.
+  void UseStorage();
+  // Checks that all offsets in the mapped tables are in bounds, and that the
+  // files are stored in the archive described by |key|.
+  bool Validate(const Key& key) const;
+
+  const Node* LookupInternal(const base::StringPiece& path, int depth) const;
+  const Node* LookupInHashTable(const base::StringPiece& path) const;
+  const Node* LookupByWalking(const base::StringPiece& path, int depth) const;
+  const Node* GetChildNode(const Node* dir,
+                           const base::StringPiece& name,
+                           int depth) const;
+
+  // Views of the tables, backed by either the storage below or the mapped
+  // index file.
+  const Node* nodes_;
+  size_t node_count_;
+  const uint32_t* children_;
+  size_t children_count_;
+  const char* strings_;
+  size_t strings_size_;
+  // Open addressing table of node index + 1, 0 marks an empty slot.
+  const uint32_t* buckets_;
+  size_t bucket_count_;
+
+  std::vector<Node> node_storage_;
+  std::vector<uint32_t> children_storage_;
+  std::string strings_storage_;
+  std::vector<uint32_t> buckets_storage_;
+  std::unique_ptr<base::MemoryMappedFile> mapped_file_;
+
+  // Whether there is any link, paths through linked directories can only be
+  // resolved by walking the tree.
+  bool has_links_;
+
+  DISALLOW_COPY_AND_ASSIGN(ArchiveIndex);
+};
+
+}  // namespace asar
+
+#endif  // ATOM_COMMON_ASAR_ARCHIVE_INDEX_H_
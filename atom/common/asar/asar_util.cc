@@ -4,36 +4,229 @@
 
 #include "atom/common/asar/asar_util.h"
 
-#include <map>
+#include <iterator>
+#include <list>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "atom/common/asar/archive.h"
+#include "base/atomicops.h"
+#include "base/base_paths.h"
+#include "base/files/file.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/hash.h"
 #include "base/lazy_instance.h"
-#include "base/stl_util.h"
+#include "base/macros.h"
+#include "base/path_service.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+
+#if defined(OS_POSIX)
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace asar {
 
 namespace {
 
-// The global instance of ArchiveMap, will be destroyed on exit.
-typedef std::map<base::FilePath, std::shared_ptr<Archive>> ArchiveMap;
-static base::LazyInstance<ArchiveMap> g_archive_map = LAZY_INSTANCE_INITIALIZER;
-
 const base::FilePath::CharType kAsarExtension[] = FILE_PATH_LITERAL(".asar");
 
-}  // namespace
+// Directory under the user's cache dir where data about archives is cached.
+const base::FilePath::CharType kCacheDirectory[] =
+    FILE_PATH_LITERAL("electron-asar-index");
 
-std::shared_ptr<Archive> GetOrCreateAsarArchive(const base::FilePath& path) {
-  ArchiveMap& archive_map = *g_archive_map.Pointer();
-  if (!ContainsKey(archive_map, path)) {
+// Archives are spread over shards by path so lookups of different archives
+// from different threads rarely contend for the same lock.
+const size_t kShardCount = 8;
+
+// Limits of the whole cache.
+const size_t kMaxArchives = 64;
+const size_t kMaxHeaderMemory = 64 * 1024 * 1024;
+
+class ArchiveCache {
+ public:
+  ArchiveCache() : archive_count_(0), header_memory_(0) {}
+
+  std::shared_ptr<Archive> GetOrCreate(const base::FilePath& path) {
+    Shard& shard = shards_[BASE_HASH_NAMESPACE::hash<base::FilePath>()(path) %
+                           kShardCount];
+    {
+      base::AutoLock auto_lock(shard.lock);
+      std::shared_ptr<Archive> archive = Find(&shard, path);
+      if (archive) {
+        ++shard.hits;
+        return archive;
+      }
+      ++shard.misses;
+    }
+
+    // Opening the archive reads and parses its header, which must not block
+    // the lookups of the other archives in the shard.
     std::shared_ptr<Archive> archive(new Archive(path));
     if (!archive->Init())
       return nullptr;
-    archive_map[path] = archive;
+
+    {
+      base::AutoLock auto_lock(shard.lock);
+      // Another thread may have opened the same archive meanwhile, the new
+      // one is then closed after the lock is released.
+      std::shared_ptr<Archive> existing = Find(&shard, path);
+      if (existing)
+        return existing;
+
+      Entry entry;
+      entry.path = path;
+      entry.archive = archive;
+      entry.header_memory = archive->GetHeaderMemoryUsage();
+      entry.last_use = base::TimeTicks::Now();
+      shard.lru.push_front(entry);
+      shard.map[path] = shard.lru.begin();
+      base::subtle::NoBarrier_AtomicIncrement(&archive_count_, 1);
+      base::subtle::NoBarrier_AtomicIncrement(
+          &header_memory_, static_cast<base::subtle::AtomicWord>(
+                               entry.header_memory));
+    }
+
+    // The evicted archives are closed after all locks are released.
+    std::vector<std::shared_ptr<Archive>> evicted;
+    Evict(&evicted);
+    return archive;
+  }
+
+  ArchiveCacheStats GetStats() {
+    ArchiveCacheStats stats;
+    for (Shard& shard : shards_) {
+      base::AutoLock auto_lock(shard.lock);
+      stats.hits += shard.hits;
+      stats.misses += shard.misses;
+      stats.evictions += shard.evictions;
+      stats.archive_count += shard.lru.size();
+    }
+    stats.header_memory = static_cast<size_t>(
+        base::subtle::NoBarrier_Load(&header_memory_));
+    return stats;
+  }
+
+ private:
+  struct Entry {
+    base::FilePath path;
+    std::shared_ptr<Archive> archive;
+    size_t header_memory;
+    base::TimeTicks last_use;
+  };
+
+  typedef std::list<Entry> ArchiveList;
+
+  struct Shard {
+    Shard() : hits(0), misses(0), evictions(0) {}
+
+    base::Lock lock;
+    // The most recently used archive is at the front.
+    ArchiveList lru;
+    std::unordered_map<base::FilePath, ArchiveList::iterator> map;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+  };
+
+  // Returns the archive of |path| in |shard| and marks it as used, the lock of
+  // |shard| must be held.
+  std::shared_ptr<Archive> Find(Shard* shard, const base::FilePath& path) {
+    shard->lock.AssertAcquired();
+    auto it = shard->map.find(path);
+    if (it == shard->map.end())
+      return nullptr;
+    it->second->last_use = base::TimeTicks::Now();
+    // Move to the front of the LRU list.
+    shard->lru.splice(shard->lru.begin(), shard->lru, it->second);
+    return it->second->archive;
+  }
+
+  // Returns the least recently used archive of |shard| that can be evicted,
+  // the lock of |shard| must be held. Archives with files copied out are
+  // kept, closing them would delete files that may still be in use.
+  ArchiveList::iterator FindEvictable(Shard* shard) {
+    shard->lock.AssertAcquired();
+    for (auto it = shard->lru.rbegin(); it != shard->lru.rend(); ++it) {
+      if (!it->archive->HasExternalFiles())
+        return std::prev(it.base());
+    }
+    return shard->lru.end();
+  }
+
+  // Removes the least recently used archives of all shards until the cache is
+  // within its limits, but always keeps one archive.
+  void Evict(std::vector<std::shared_ptr<Archive>>* evicted) {
+    base::AutoLock evict_lock(evict_lock_);
+    while (OverLimits()) {
+      Shard* oldest = nullptr;
+      base::TimeTicks oldest_use;
+      for (Shard& shard : shards_) {
+        base::AutoLock auto_lock(shard.lock);
+        auto it = FindEvictable(&shard);
+        if (it != shard.lru.end() &&
+            (!oldest || it->last_use < oldest_use)) {
+          oldest = &shard;
+          oldest_use = it->last_use;
+        }
+      }
+      if (!oldest)
+        return;
+
+      base::AutoLock auto_lock(oldest->lock);
+      auto it = FindEvictable(oldest);
+      if (it == oldest->lru.end())
+        continue;
+      base::subtle::NoBarrier_AtomicIncrement(&archive_count_, -1);
+      base::subtle::NoBarrier_AtomicIncrement(
+          &header_memory_,
+          -static_cast<base::subtle::AtomicWord>(it->header_memory));
+      evicted->push_back(std::move(it->archive));
+      oldest->map.erase(it->path);
+      oldest->lru.erase(it);
+      ++oldest->evictions;
+    }
   }
-  return archive_map[path];
+
+  bool OverLimits() const {
+    base::subtle::Atomic32 count =
+        base::subtle::NoBarrier_Load(&archive_count_);
+    base::subtle::AtomicWord memory =
+        base::subtle::NoBarrier_Load(&header_memory_);
+    return count > 1 &&
+           (count > static_cast<base::subtle::Atomic32>(kMaxArchives) ||
+            memory > static_cast<base::subtle::AtomicWord>(kMaxHeaderMemory));
+  }
+
+  Shard shards_[kShardCount];
+
+  // Totals of all shards, which are updated under the lock of the shard that
+  // changed.
+  base::subtle::Atomic32 archive_count_;
+  base::subtle::AtomicWord header_memory_;
+
+  // Only one thread evicts archives at a time.
+  base::Lock evict_lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(ArchiveCache);
+};
+
+// The global instance of ArchiveCache, will be destroyed on exit.
+base::LazyInstance<ArchiveCache> g_archive_cache = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+std::shared_ptr<Archive> GetOrCreateAsarArchive(const base::FilePath& path) {
+  return g_archive_cache.Get().GetOrCreate(path);
+}
+
+ArchiveCacheStats GetArchiveCacheStats() {
+  return g_archive_cache.Get().GetStats();
 }
 
 bool GetAsarArchivePath(const base::FilePath& full_path,
@@ -58,6 +251,37 @@ bool GetAsarArchivePath(const base::FilePath& full_path,
   return true;
 }
 
+bool GetArchiveCacheFilePath(const base::FilePath& archive_path,
+                             const char* extension,
+                             base::FilePath* path) {
+  // The shared temp dir can not be used, files planted there by other users
+  // would redirect reads from archives.
+  base::FilePath cache_dir;
+#if defined(OS_WIN)
+  if (!PathService::Get(base::DIR_LOCAL_APP_DATA, &cache_dir))
+#else
+  if (!PathService::Get(base::DIR_CACHE, &cache_dir))
+#endif
+    return false;
+  *path = cache_dir.Append(kCacheDirectory).AppendASCII(base::StringPrintf(
+      "%08x.%s", base::Hash(archive_path.AsUTF8Unsafe()), extension));
+  return true;
+}
+
+bool IsArchiveCacheFileTrusted(const base::File& file) {
+  if (!file.IsValid())
+    return false;
+#if defined(OS_POSIX)
+  struct stat st;
+  if (fstat(file.GetPlatformFile(), &st) != 0)
+    return false;
+  return st.st_uid == geteuid() && (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+#else
+  // The local app data of the user is not accessible by other users.
+  return true;
+#endif
+}
+
 bool ReadFileToString(const base::FilePath& path, std::string* contents) {
   base::FilePath asar_path, relative_path;
   if (!GetAsarArchivePath(path, &asar_path, &relative_path))
@@ -78,13 +302,7 @@ bool ReadFileToString(const base::FilePath& path, std::string* contents) {
     return base::ReadFileToString(real_path, contents);
   }
 
-  base::File src(asar_path, base::File::FLAG_OPEN | base::File::FLAG_READ);
-  if (!src.IsValid())
-    return false;
-
-  contents->resize(info.size);
-  return static_cast<int>(info.size) == src.Read(
-      info.offset, const_cast<char*>(contents->data()), contents->size());
+  return archive->ReadFile(info, contents);
 }
 
 }  // namespace asar
@@ -5,10 +5,14 @@
 #ifndef ATOM_COMMON_ASAR_ASAR_UTIL_H_
 #define ATOM_COMMON_ASAR_ASAR_UTIL_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <memory>
 #include <string>
 
 namespace base {
+class File;
 class FilePath;
 }
 
@@ -16,14 +20,43 @@ namespace asar {
 
 class Archive;
 
-// Gets or creates a new Archive from the path.
+// Counters of the global archive cache.
+struct ArchiveCacheStats {
+  ArchiveCacheStats()
+      : hits(0), misses(0), evictions(0), archive_count(0), header_memory(0) {}
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  size_t archive_count;
+  size_t header_memory;
+};
+
+// Gets or creates a new Archive from the path, can be called from any thread.
+// The least recently used archives are dropped from the cache when it holds
+// too many archives or too much header memory, they stay alive until the
+// last reference goes away. Archives that have copied files out are never
+// dropped.
 std::shared_ptr<Archive> GetOrCreateAsarArchive(const base::FilePath& path);
 
+// Returns the counters of the archive cache.
+ArchiveCacheStats GetArchiveCacheStats();
+
 // Separates the path to Archive out.
 bool GetAsarArchivePath(const base::FilePath& full_path,
                         base::FilePath* asar_path,
                         base::FilePath* relative_path);
 
+// Gets the path of a file caching data about the archive at |archive_path|,
+// e.g. the parsed header, files are told apart by |extension|. The files are
+// kept in the cache directory of the current user.
+bool GetArchiveCacheFilePath(const base::FilePath& archive_path,
+                             const char* extension,
+                             base::FilePath* path);
+
+// Returns whether the cache |file| can be trusted, which is when it is owned
+// by the current user and no one else can write to it.
+bool IsArchiveCacheFileTrusted(const base::File& file);
+
 // Same with base::ReadFileToString but supports asar Archive.
 bool ReadFileToString(const base::FilePath& path, std::string* contents);
 
@@ -0,0 +1,243 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/common/asar/prefetch_profile.h"
+
+#include <limits.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "atom/common/asar/asar_util.h"
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/files/file.h"
+#include "base/files/file_enumerator.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/lazy_instance.h"
+#include "base/location.h"
+#include "base/macros.h"
+#include "base/sequenced_task_runner.h"
+#include "base/synchronization/lock.h"
+
+#if defined(OS_POSIX)
+#include <fcntl.h>
+#endif
+
+namespace asar {
+
+namespace {
+
+// "ASRP" in little endian.
+const uint32_t kProfileMagic = 0x50525341;
+const uint32_t kProfileVersion = 1;
+
+// Reads closer than this are merged, so readahead issues fewer and longer
+// sequential reads.
+const uint64_t kMergeGap = 64 * 1024;
+
+// Stop recording an archive after this many reads.
+const size_t kMaxRecordedReads = 64 * 1024;
+
+struct ProfileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t archive_size;
+  int64_t archive_mtime;
+  uint32_t range_count;
+  uint32_t padding;
+};
+
+struct Range {
+  uint64_t offset;
+  uint64_t length;
+};
+
+typedef std::map<base::FilePath, std::vector<Range>> RangeMap;
+
+// Whether reads are being recorded, checked before taking the lock so the
+// read path stays cheap after startup.
+base::subtle::Atomic32 g_recording = 0;
+
+class Recorder {
+ public:
+  Recorder() {}
+
+  void Start() {
+    base::AutoLock auto_lock(lock_);
+    base::subtle::NoBarrier_Store(&g_recording, 1);
+  }
+
+  RangeMap Stop() {
+    base::AutoLock auto_lock(lock_);
+    base::subtle::NoBarrier_Store(&g_recording, 0);
+    RangeMap ranges;
+    ranges.swap(ranges_);
+    return ranges;
+  }
+
+  void Record(const base::FilePath& path, uint64_t offset, uint64_t size) {
+    base::AutoLock auto_lock(lock_);
+    if (!base::subtle::NoBarrier_Load(&g_recording))
+      return;
+    std::vector<Range>& ranges = ranges_[path];
+    if (ranges.size() < kMaxRecordedReads)
+      ranges.push_back({offset, size});
+  }
+
+ private:
+  base::Lock lock_;
+  RangeMap ranges_;
+
+  DISALLOW_COPY_AND_ASSIGN(Recorder);
+};
+
+// Leaked, reads can still be recorded on other threads while exiting.
+base::LazyInstance<Recorder>::Leaky g_recorder = LAZY_INSTANCE_INITIALIZER;
+
+// Sorts the ranges by offset and merges the ones that are close.
+std::vector<Range> MergeRanges(std::vector<Range> ranges) {
+  std::sort(ranges.begin(), ranges.end(),
+            [](const Range& a, const Range& b) { return a.offset < b.offset; });
+  std::vector<Range> merged;
+  for (const Range& range : ranges) {
+    if (!merged.empty() &&
+        range.offset <= merged.back().offset + merged.back().length +
+                        kMergeGap) {
+      uint64_t end = std::max(merged.back().offset + merged.back().length,
+                              range.offset + range.length);
+      merged.back().length = end - merged.back().offset;
+    } else {
+      merged.push_back(range);
+    }
+  }
+  return merged;
+}
+
+// Asks the OS to bring the range into the page cache.
+void Readahead(base::File* file, uint64_t offset, uint64_t length) {
+#if defined(OS_LINUX)
+  posix_fadvise(file->GetPlatformFile(), offset, length, POSIX_FADV_WILLNEED);
+#elif defined(OS_MACOSX)
+  struct radvisory advice;
+  advice.ra_offset = offset;
+  advice.ra_count = static_cast<int>(std::min<uint64_t>(length, INT_MAX));
+  fcntl(file->GetPlatformFile(), F_RDADVISE, &advice);
+#else
+  // There is no advisory API, read the range to pull it into the cache.
+  std::vector<char> buffer(1024 * 1024);
+  while (length > 0) {
+    int size = static_cast<int>(std::min<uint64_t>(length, buffer.size()));
+    int read = file->Read(offset, buffer.data(), size);
+    if (read <= 0)
+      break;
+    offset += read;
+    length -= read;
+  }
+#endif
+}
+
+void PrefetchArchive(const base::FilePath& archive_path) {
+  base::FilePath profile_path;
+  if (!GetArchiveCacheFilePath(archive_path, "prefetch", &profile_path))
+    return;
+  base::File profile_file(profile_path,
+                          base::File::FLAG_OPEN | base::File::FLAG_READ);
+  if (!IsArchiveCacheFileTrusted(profile_file))
+    return;
+  int64_t length = profile_file.GetLength();
+  if (length < static_cast<int64_t>(sizeof(ProfileHeader)) ||
+      length > static_cast<int64_t>(sizeof(ProfileHeader) +
+                                    kMaxRecordedReads * sizeof(Range)))
+    return;
+  std::string profile(static_cast<size_t>(length), '\0');
+  if (profile_file.Read(0, &profile[0], static_cast<int>(length)) != length)
+    return;
+
+  ProfileHeader header;
+  memcpy(&header, profile.data(), sizeof(header));
+  if (header.magic != kProfileMagic || header.version != kProfileVersion ||
+      profile.size() !=
+          sizeof(header) + static_cast<uint64_t>(header.range_count) *
+                           sizeof(Range))
+    return;
+
+  base::File file(archive_path,
+                  base::File::FLAG_OPEN | base::File::FLAG_READ);
+  base::File::Info info;
+  if (!file.IsValid() || !file.GetInfo(&info) ||
+      static_cast<uint64_t>(info.size) != header.archive_size ||
+      info.last_modified.ToInternalValue() != header.archive_mtime)
+    return;
+
+  const char* p = profile.data() + sizeof(header);
+  for (uint32_t i = 0; i < header.range_count; ++i, p += sizeof(Range)) {
+    Range range;
+    memcpy(&range, p, sizeof(range));
+    Readahead(&file, range.offset, range.length);
+  }
+}
+
+void SaveProfile(const base::FilePath& archive_path,
+                 const std::vector<Range>& reads) {
+  base::FilePath profile_path;
+  base::File::Info info;
+  if (!GetArchiveCacheFilePath(archive_path, "prefetch", &profile_path) ||
+      !base::GetFileInfo(archive_path, &info))
+    return;
+
+  std::vector<Range> ranges = MergeRanges(reads);
+  ProfileHeader header = {};
+  header.magic = kProfileMagic;
+  header.version = kProfileVersion;
+  header.archive_size = static_cast<uint64_t>(info.size);
+  header.archive_mtime = info.last_modified.ToInternalValue();
+  header.range_count = static_cast<uint32_t>(ranges.size());
+
+  std::string data(reinterpret_cast<const char*>(&header), sizeof(header));
+  data.append(reinterpret_cast<const char*>(ranges.data()),
+              ranges.size() * sizeof(Range));
+  if (base::CreateDirectory(profile_path.DirName()))
+    base::ImportantFileWriter::WriteFileAtomically(profile_path, data);
+}
+
+void PrefetchArchives(const base::FilePath& dir) {
+  base::FileEnumerator archives(dir, false, base::FileEnumerator::FILES,
+                                FILE_PATH_LITERAL("*.asar"));
+  for (base::FilePath path = archives.Next(); !path.empty();
+       path = archives.Next())
+    PrefetchArchive(path);
+}
+
+void SaveProfiles() {
+  RangeMap reads = g_recorder.Get().Stop();
+  for (const auto& iter : reads)
+    SaveProfile(iter.first, iter.second);
+}
+
+}  // namespace
+
+void StartPrefetching(const base::FilePath& dir,
+                      base::TimeDelta duration,
+                      scoped_refptr<base::SequencedTaskRunner> task_runner) {
+  // Start recording before returning, so reads made by init.js are included.
+  g_recorder.Get().Start();
+  task_runner->PostTask(FROM_HERE, base::Bind(&PrefetchArchives, dir));
+  task_runner->PostDelayedTask(FROM_HERE, base::Bind(&SaveProfiles),
+                               duration);
+}
+
+void RecordArchiveRead(const base::FilePath& path,
+                       uint64_t offset,
+                       uint64_t size) {
+  if (base::subtle::NoBarrier_Load(&g_recording))
+    g_recorder.Get().Record(path, offset, size);
+}
+
+}  // namespace asar
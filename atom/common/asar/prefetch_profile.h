@@ -0,0 +1,37 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_COMMON_ASAR_PREFETCH_PROFILE_H_
+#define ATOM_COMMON_ASAR_PREFETCH_PROFILE_H_
+
+#include <stdint.h>
+
+#include "base/memory/ref_counted.h"
+#include "base/time/time.h"
+
+namespace base {
+class FilePath;
+class SequencedTaskRunner;
+}
+
+namespace asar {
+
+// Issues readahead on |task_runner| for the ranges that previous launches
+// read from the archives under |dir|, and records the ranges read from any
+// archive during the next |duration|. The recorded ranges are then saved on
+// |task_runner| as the profiles used by the next launch, the saving should be
+// skipped when |task_runner| shuts down.
+void StartPrefetching(const base::FilePath& dir,
+                      base::TimeDelta duration,
+                      scoped_refptr<base::SequencedTaskRunner> task_runner);
+
+// Called when |size| bytes at |offset| of the archive at |path| are going to
+// be read, does nothing when not recording. Can be called from any thread.
+void RecordArchiveRead(const base::FilePath& path,
+                       uint64_t offset,
+                       uint64_t size);
+
+}  // namespace asar
+
+#endif  // ATOM_COMMON_ASAR_PREFETCH_PROFILE_H_
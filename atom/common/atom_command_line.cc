@@ -26,6 +26,12 @@ void AtomCommandLine::Init(int argc, const char* const* argv) {
   }
 }
 
+// static
+void AtomCommandLine::AppendSwitch(const std::string& name,
+                                   const std::string& value) {
+  argv_.push_back(value.empty() ? "--" + name : "--" + name + "=" + value);
+}
+
 #if defined(OS_WIN)
 // static
 void AtomCommandLine::InitW(int argc, const wchar_t* const* argv) {
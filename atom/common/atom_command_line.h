@@ -19,6 +19,9 @@ class AtomCommandLine {
   static void Init(int argc, const char* const* argv);
   static std::vector<std::string> argv() { return argv_; }
 
+  // Appends a switch that was not known when the process was launched.
+  static void AppendSwitch(const std::string& name, const std::string& value);
+
 #if defined(OS_WIN)
   static void InitW(int argc, const wchar_t* const* argv);
   static std::vector<std::wstring> wargv() { return wargv_; }
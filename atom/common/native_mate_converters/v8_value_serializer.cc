@@ -0,0 +1,892 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/common/native_mate_converters/v8_value_serializer.h"
+
+#include <string.h>
+
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "build/build_config.h"
+
+#include "atom/common/node_includes.h"
+
+namespace atom {
+
+namespace {
+
+const uint8_t kVersion = 2;
+
+// Limits the recursion on both sides, the data can come from an untrusted
+// process.
+const int kMaxDepth = 1000;
+
+// Allocating a region costs a round trip to the browser in the renderer, so
+// only buffers that are expensive to copy are worth it.
+base::subtle::AtomicWord g_shared_memory_threshold = 1024 * 1024;
+
+// Keeps typed arrays in the shared region aligned for their elements.
+const size_t kSharedBufferAlignment = 8;
+
+// Offsets in the shared region are written as 32-bit varints.
+const size_t kMaxSharedSize =
+    std::numeric_limits<uint32_t>::max() - kSharedBufferAlignment;
+
+enum Tag : uint8_t {
+  TAG_UNDEFINED = '_',
+  TAG_NULL = '0',
+  TAG_TRUE = 'T',
+  TAG_FALSE = 'F',
+  TAG_INT32 = 'I',
+  TAG_DOUBLE = 'N',
+  TAG_ONE_BYTE_STRING = 's',
+  TAG_TWO_BYTE_STRING = 'w',
+  TAG_DATE = 'D',
+  TAG_REGEXP = 'R',
+  TAG_ARRAY = 'A',
+  TAG_OBJECT = 'O',
+  TAG_MAP = 'M',
+  TAG_SET = 'S',
+  TAG_ARRAY_BUFFER = 'B',
+  TAG_ARRAY_BUFFER_VIEW = 'V',
+  TAG_NODE_BUFFER = 'b',
+  // One of the binary tags above with its contents in shared memory.
+  TAG_SHARED_BUFFER = 'H',
+  // An object that has already been written, by the order it was written.
+  TAG_OBJECT_REFERENCE = 'r',
+};
+
+enum ViewType : uint8_t {
+  VIEW_DATA_VIEW = 0,
+  VIEW_INT8,
+  VIEW_UINT8,
+  VIEW_UINT8_CLAMPED,
+  VIEW_INT16,
+  VIEW_UINT16,
+  VIEW_INT32,
+  VIEW_UINT32,
+  VIEW_FLOAT32,
+  VIEW_FLOAT64,
+  VIEW_TYPE_COUNT,
+};
+
+const size_t kViewElementSizes[VIEW_TYPE_COUNT] = {
+  1, 1, 1, 1, 2, 2, 4, 4, 4, 8,
+};
+
+const int kRegExpFlagsMask = v8::RegExp::kGlobal | v8::RegExp::kIgnoreCase |
+                             v8::RegExp::kMultiline;
+
+ViewType GetViewType(v8::Local<v8::ArrayBufferView> view) {
+  if (view->IsInt8Array())
+    return VIEW_INT8;
+  if (view->IsUint8Array())
+    return VIEW_UINT8;
+  if (view->IsUint8ClampedArray())
+    return VIEW_UINT8_CLAMPED;
+  if (view->IsInt16Array())
+    return VIEW_INT16;
+  if (view->IsUint16Array())
+    return VIEW_UINT16;
+  if (view->IsInt32Array())
+    return VIEW_INT32;
+  if (view->IsUint32Array())
+    return VIEW_UINT32;
+  if (view->IsFloat32Array())
+    return VIEW_FLOAT32;
+  if (view->IsFloat64Array())
+    return VIEW_FLOAT64;
+  return VIEW_DATA_VIEW;
+}
+
+v8::Local<v8::Object> NewView(ViewType type,
+                              v8::Local<v8::ArrayBuffer> buffer,
+                              size_t byte_length) {
+  size_t length = byte_length / kViewElementSizes[type];
+  switch (type) {
+    case VIEW_INT8:
+      return v8::Int8Array::New(buffer, 0, length);
+    case VIEW_UINT8:
+      return v8::Uint8Array::New(buffer, 0, length);
+    case VIEW_UINT8_CLAMPED:
+      return v8::Uint8ClampedArray::New(buffer, 0, length);
+    case VIEW_INT16:
+      return v8::Int16Array::New(buffer, 0, length);
+    case VIEW_UINT16:
+      return v8::Uint16Array::New(buffer, 0, length);
+    case VIEW_INT32:
+      return v8::Int32Array::New(buffer, 0, length);
+    case VIEW_UINT32:
+      return v8::Uint32Array::New(buffer, 0, length);
+    case VIEW_FLOAT32:
+      return v8::Float32Array::New(buffer, 0, length);
+    case VIEW_FLOAT64:
+      return v8::Float64Array::New(buffer, 0, length);
+    default:
+      return v8::DataView::New(buffer, 0, length);
+  }
+}
+
+// Keeps a received region mapped while Buffers created from it are alive.
+class SharedRegion : public base::RefCountedThreadSafe<SharedRegion> {
+ public:
+  explicit SharedRegion(std::unique_ptr<base::SharedMemory> memory)
+      : memory_(std::move(memory)) {}
+
+ private:
+  friend class base::RefCountedThreadSafe<SharedRegion>;
+
+  ~SharedRegion() {}
+
+  std::unique_ptr<base::SharedMemory> memory_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedRegion);
+};
+
+void FreeSharedMemory(char* data, void* hint) {
+  static_cast<SharedRegion*>(hint)->Release();
+}
+
+bool MapSharedMemory(base::SharedMemory* memory, size_t size) {
+#if defined(OS_POSIX)
+  // Mapping past the end of the region would only fail on access.
+  size_t region_size;
+  if (!base::SharedMemory::GetSizeFromSharedMemoryHandle(memory->handle(),
+                                                         &region_size) ||
+      region_size < size)
+    return false;
+#endif
+  return memory->Map(size);
+}
+
+class Serializer {
+ public:
+  Serializer(v8::Isolate* isolate,
+             const SharedMemoryWriter& shared_memory_writer,
+             SerializedV8Value* result,
+             std::string* error)
+      : context_(isolate->GetCurrentContext()),
+        shared_memory_writer_(shared_memory_writer),
+        shared_memory_threshold_(GetSharedMemoryThreshold()),
+        result_(result),
+        data_(&result->data),
+        error_(error),
+        shared_size_(0),
+        next_id_(0) {}
+
+  bool Serialize(v8::Local<v8::Value> value) {
+    data_->clear();
+    result_->shared_buffers.clear();
+    result_->shared_buffers_size = 0;
+    WriteByte(kVersion);
+    return WriteValue(value, 0) && WriteSharedMemory();
+  }
+
+ private:
+  bool WriteValue(v8::Local<v8::Value> value, int depth) {
+    if (value->IsUndefined()) {
+      WriteByte(TAG_UNDEFINED);
+    } else if (value->IsNull()) {
+      WriteByte(TAG_NULL);
+    } else if (value->IsTrue()) {
+      WriteByte(TAG_TRUE);
+    } else if (value->IsFalse()) {
+      WriteByte(TAG_FALSE);
+    } else if (value->IsInt32()) {
+      WriteByte(TAG_INT32);
+      // Zigzag encoding keeps small negative numbers short.
+      int32_t number = value.As<v8::Int32>()->Value();
+      WriteVarint((static_cast<uint32_t>(number) << 1) ^
+                  static_cast<uint32_t>(number >> 31));
+    } else if (value->IsNumber()) {
+      WriteByte(TAG_DOUBLE);
+      WriteDouble(value.As<v8::Number>()->Value());
+    } else if (value->IsString()) {
+      WriteString(value.As<v8::String>());
+    } else if (value->IsObject()) {
+      return WriteObject(value.As<v8::Object>(), depth);
+    } else {
+      return Fail("A Symbol could not be cloned");
+    }
+    return true;
+  }
+
+  bool WriteObject(v8::Local<v8::Object> object, int depth) {
+    if (WriteReferenceIfSeen(object))
+      return true;
+    if (depth > kMaxDepth)
+      return Fail("Object is too deeply nested to be cloned");
+
+    if (object->IsFunction())
+      return Fail("A function could not be cloned");
+
+    // node::Buffer::HasInstance also accepts plain Uint8Arrays, which then
+    // arrive as Buffers, a subclass of Uint8Array.
+    if (node::Buffer::HasInstance(object)) {
+      v8::Local<v8::Uint8Array> array = object.As<v8::Uint8Array>();
+      size_t length = node::Buffer::Length(object);
+      if (!WriteSharedBuffer(TAG_NODE_BUFFER, VIEW_UINT8, array->Buffer(),
+                             array->ByteOffset(), length)) {
+        WriteByte(TAG_NODE_BUFFER);
+        WriteVarint(length);
+        WriteRaw(node::Buffer::Data(object), length);
+      }
+    } else if (object->IsArrayBufferView()) {
+      v8::Local<v8::ArrayBufferView> view = object.As<v8::ArrayBufferView>();
+      ViewType type = GetViewType(view);
+      size_t length = view->ByteLength();
+      // Small typed arrays can live on the V8 heap, only ask for the backing
+      // store when it is going to be shared.
+      if (!CanShare(length) ||
+          !WriteSharedBuffer(TAG_ARRAY_BUFFER_VIEW, type, view->Buffer(),
+                             view->ByteOffset(), length)) {
+        WriteByte(TAG_ARRAY_BUFFER_VIEW);
+        WriteByte(type);
+        WriteVarint(length);
+        view->CopyContents(Grow(length), length);
+      }
+    } else if (object->IsArrayBuffer()) {
+      v8::Local<v8::ArrayBuffer> buffer = object.As<v8::ArrayBuffer>();
+      size_t length = buffer->ByteLength();
+      if (!WriteSharedBuffer(TAG_ARRAY_BUFFER, VIEW_UINT8, buffer, 0,
+                             length)) {
+        WriteByte(TAG_ARRAY_BUFFER);
+        WriteVarint(length);
+        WriteRaw(buffer->GetContents().Data(), length);
+      }
+    } else if (object->IsDate()) {
+      WriteByte(TAG_DATE);
+      WriteDouble(object.As<v8::Date>()->ValueOf());
+    } else if (object->IsRegExp()) {
+      v8::Local<v8::RegExp> regexp = object.As<v8::RegExp>();
+      WriteByte(TAG_REGEXP);
+      WriteString(regexp->GetSource());
+      WriteVarint(regexp->GetFlags() & kRegExpFlagsMask);
+    } else if (object->IsMap()) {
+      WriteByte(TAG_MAP);
+      return WriteElements(object.As<v8::Map>()->AsArray(), depth);
+    } else if (object->IsSet()) {
+      WriteByte(TAG_SET);
+      return WriteElements(object.As<v8::Set>()->AsArray(), depth);
+    } else if (object->IsArray()) {
+      WriteByte(TAG_ARRAY);
+      return WriteElements(object.As<v8::Array>(), depth);
+    } else if (object->IsNativeError() || object->IsSharedArrayBuffer() ||
+               object->IsProxy() || object->InternalFieldCount() > 0) {
+      return Fail("An object could not be cloned");
+    } else {
+      return WriteProperties(object, depth);
+    }
+    return true;
+  }
+
+  bool WriteElements(v8::Local<v8::Array> array, int depth) {
+    uint32_t length = array->Length();
+    WriteVarint(length);
+    for (uint32_t i = 0; i < length; ++i) {
+      v8::Local<v8::Value> element;
+      if (!array->Get(context_, i).ToLocal(&element) ||
+          !WriteValue(element, depth + 1))
+        return false;
+    }
+    return true;
+  }
+
+  bool WriteProperties(v8::Local<v8::Object> object, int depth) {
+    v8::Local<v8::Array> keys;
+    if (!object->GetOwnPropertyNames(context_).ToLocal(&keys))
+      return false;
+
+    WriteByte(TAG_OBJECT);
+    uint32_t length = keys->Length();
+    WriteVarint(length);
+    for (uint32_t i = 0; i < length; ++i) {
+      v8::Local<v8::Value> key;
+      v8::Local<v8::String> name;
+      v8::Local<v8::Value> value;
+      if (!keys->Get(context_, i).ToLocal(&key) ||
+          !key->ToString(context_).ToLocal(&name) ||
+          !object->Get(context_, name).ToLocal(&value))
+        return false;
+      WriteString(name);
+      if (!WriteValue(value, depth + 1))
+        return false;
+    }
+    return true;
+  }
+
+  void WriteString(v8::Local<v8::String> string) {
+    int length = string->Length();
+    if (string->IsOneByte()) {
+      WriteByte(TAG_ONE_BYTE_STRING);
+      WriteVarint(length);
+      string->WriteOneByte(reinterpret_cast<uint8_t*>(Grow(length)), 0,
+                           length, v8::String::NO_NULL_TERMINATION);
+    } else {
+      WriteByte(TAG_TWO_BYTE_STRING);
+      WriteVarint(length);
+      std::vector<uint16_t> buffer(length);
+      string->Write(buffer.data(), 0, length,
+                    v8::String::NO_NULL_TERMINATION);
+      WriteRaw(buffer.data(), length * sizeof(uint16_t));
+    }
+  }
+
+  bool CanShare(size_t length) const {
+    return !shared_memory_writer_.is_null() &&
+           shared_memory_threshold_ > 0 &&
+           length >= shared_memory_threshold_ &&
+           shared_size_ <= kMaxSharedSize &&
+           length <= kMaxSharedSize - shared_size_;
+  }
+
+  // Reserves a place in the shared region for the |length| bytes at
+  // |byte_offset| in |buffer| when they are large enough, returns false when
+  // they have to be written inline. The bytes are copied once the whole value
+  // has been written, so the region is allocated once.
+  bool WriteSharedBuffer(Tag tag,
+                         ViewType type,
+                         v8::Local<v8::ArrayBuffer> buffer,
+                         size_t byte_offset,
+                         size_t length) {
+    if (!CanShare(length))
+      return false;
+
+    WriteByte(TAG_SHARED_BUFFER);
+    WriteByte(tag);
+    WriteByte(type);
+    WriteVarint(length);
+    WriteVarint(shared_size_);
+    shared_chunks_.push_back({ buffer, byte_offset, length, shared_size_ });
+    shared_size_ += length;
+    shared_size_ += (kSharedBufferAlignment -
+                     shared_size_ % kSharedBufferAlignment) %
+                    kSharedBufferAlignment;
+    return true;
+  }
+
+  bool WriteSharedMemory() {
+    if (shared_chunks_.empty())
+      return true;
+
+    // Getters that ran while writing the value could have detached buffers.
+    for (const auto& chunk : shared_chunks_) {
+      if (chunk.buffer->ByteLength() < chunk.byte_offset + chunk.length)
+        return Fail("An ArrayBuffer was detached while it was being cloned");
+    }
+
+    base::SharedMemoryHandle handle;
+    if (!shared_memory_writer_.Run(
+            shared_size_,
+            base::Bind(&Serializer::FillSharedMemory, base::Unretained(this)),
+            &handle))
+      return Fail("Unable to allocate shared memory");
+    result_->shared_buffers.push_back(handle);
+    result_->shared_buffers_size = shared_size_;
+    return true;
+  }
+
+  void FillSharedMemory(char* memory) {
+    for (const auto& chunk : shared_chunks_) {
+      const char* data =
+          static_cast<const char*>(chunk.buffer->GetContents().Data());
+      memcpy(memory + chunk.shared_offset, data + chunk.byte_offset,
+             chunk.length);
+    }
+  }
+
+  // Writes a reference when |object| has already been written, otherwise
+  // gives it the next id.
+  bool WriteReferenceIfSeen(v8::Local<v8::Object> object) {
+    int hash = object->GetIdentityHash();
+    auto range = seen_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      // Operator == for handles compares the underlying objects.
+      if (it->second.first == object) {
+        WriteByte(TAG_OBJECT_REFERENCE);
+        WriteVarint(it->second.second);
+        return true;
+      }
+    }
+    seen_.insert(std::make_pair(hash, std::make_pair(object, next_id_++)));
+    return false;
+  }
+
+  char* Grow(size_t size) {
+    size_t offset = data_->size();
+    data_->resize(offset + size);
+    return data_->data() + offset;
+  }
+
+  void WriteByte(uint8_t byte) {
+    data_->push_back(static_cast<char>(byte));
+  }
+
+  void WriteVarint(uint32_t value) {
+    while (value >= 0x80) {
+      WriteByte(static_cast<uint8_t>(value) | 0x80);
+      value >>= 7;
+    }
+    WriteByte(static_cast<uint8_t>(value));
+  }
+
+  void WriteDouble(double value) {
+    WriteRaw(&value, sizeof(value));
+  }
+
+  void WriteRaw(const void* data, size_t size) {
+    if (size > 0)
+      memcpy(Grow(size), data, size);
+  }
+
+  bool Fail(const char* message) {
+    *error_ = message;
+    return false;
+  }
+
+  v8::Local<v8::Context> context_;
+  const SharedMemoryWriter& shared_memory_writer_;
+  // Read once, so every buffer of a value sees the same threshold.
+  const size_t shared_memory_threshold_;
+  SerializedV8Value* result_;
+  std::vector<char>* data_;
+  std::string* error_;
+
+  // A buffer that goes to |shared_offset| in the shared region.
+  struct SharedChunk {
+    v8::Local<v8::ArrayBuffer> buffer;
+    size_t byte_offset;
+    size_t length;
+    size_t shared_offset;
+  };
+  std::vector<SharedChunk> shared_chunks_;
+  size_t shared_size_;
+
+  using ObjectAndId = std::pair<v8::Local<v8::Object>, uint32_t>;
+  std::unordered_multimap<int, ObjectAndId> seen_;
+  uint32_t next_id_;
+
+  DISALLOW_COPY_AND_ASSIGN(Serializer);
+};
+
+class Deserializer {
+ public:
+  Deserializer(v8::Isolate* isolate,
+               const std::vector<char>& data,
+               SharedMemoryList* shared_buffers,
+               bool copy_shared_buffers)
+      : isolate_(isolate),
+        context_(isolate->GetCurrentContext()),
+        position_(data.data()),
+        end_(data.data() + data.size()),
+        shared_buffers_(shared_buffers),
+        copy_shared_buffers_(copy_shared_buffers),
+        shared_data_(nullptr),
+        shared_size_(0) {}
+
+  v8::Local<v8::Value> Deserialize() {
+    uint8_t version;
+    v8::Local<v8::Value> value;
+    if (!ReadByte(&version) || version != kVersion ||
+        !ReadValue(0, &value) || position_ != end_)
+      return v8::Local<v8::Value>();
+    return value;
+  }
+
+ private:
+  bool ReadValue(int depth, v8::Local<v8::Value>* value) {
+    if (depth > kMaxDepth)
+      return false;
+
+    uint8_t tag;
+    if (!ReadByte(&tag))
+      return false;
+
+    switch (tag) {
+      case TAG_UNDEFINED:
+        *value = v8::Undefined(isolate_);
+        return true;
+      case TAG_NULL:
+        *value = v8::Null(isolate_);
+        return true;
+      case TAG_TRUE:
+        *value = v8::True(isolate_);
+        return true;
+      case TAG_FALSE:
+        *value = v8::False(isolate_);
+        return true;
+      case TAG_INT32: {
+        uint32_t zigzag;
+        if (!ReadVarint(&zigzag))
+          return false;
+        int32_t number = static_cast<int32_t>((zigzag >> 1) ^ -(zigzag & 1));
+        *value = v8::Integer::New(isolate_, number);
+        return true;
+      }
+      case TAG_DOUBLE: {
+        double number;
+        if (!ReadDouble(&number))
+          return false;
+        *value = v8::Number::New(isolate_, number);
+        return true;
+      }
+      case TAG_ONE_BYTE_STRING:
+      case TAG_TWO_BYTE_STRING: {
+        v8::Local<v8::String> string;
+        if (!ReadStringBody(tag, &string))
+          return false;
+        *value = string;
+        return true;
+      }
+      case TAG_OBJECT_REFERENCE: {
+        uint32_t id;
+        if (!ReadVarint(&id) || id >= objects_.size())
+          return false;
+        *value = objects_[id];
+        return true;
+      }
+      default:
+        return ReadObject(tag, depth, value);
+    }
+  }
+
+  bool ReadObject(uint8_t tag, int depth, v8::Local<v8::Value>* value) {
+    switch (tag) {
+      case TAG_NODE_BUFFER: {
+        uint32_t length;
+        const char* data;
+        v8::Local<v8::Object> buffer;
+        if (!ReadVarint(&length) || !ReadRaw(length, &data) ||
+            !node::Buffer::Copy(isolate_, data, length).ToLocal(&buffer))
+          return false;
+        return AddObject(buffer, value);
+      }
+      case TAG_ARRAY_BUFFER_VIEW: {
+        uint8_t type;
+        uint32_t length;
+        const char* data;
+        if (!ReadByte(&type) || type >= VIEW_TYPE_COUNT ||
+            !ReadVarint(&length) || length % kViewElementSizes[type] != 0 ||
+            !ReadRaw(length, &data))
+          return false;
+        v8::Local<v8::ArrayBuffer> buffer = NewArrayBuffer(data, length);
+        return AddObject(
+            NewView(static_cast<ViewType>(type), buffer, length), value);
+      }
+      case TAG_ARRAY_BUFFER: {
+        uint32_t length;
+        const char* data;
+        if (!ReadVarint(&length) || !ReadRaw(length, &data))
+          return false;
+        return AddObject(NewArrayBuffer(data, length), value);
+      }
+      case TAG_SHARED_BUFFER: {
+        uint8_t binary_tag;
+        uint8_t type;
+        uint32_t length;
+        uint32_t offset;
+        v8::Local<v8::Object> buffer;
+        if (!ReadByte(&binary_tag) || !ReadByte(&type) ||
+            type >= VIEW_TYPE_COUNT || !ReadVarint(&length) ||
+            length % kViewElementSizes[type] != 0 || !ReadVarint(&offset) ||
+            !TakeSharedBuffer(offset, length, &buffer))
+          return false;
+        if (binary_tag == TAG_NODE_BUFFER)
+          return AddObject(buffer, value);
+        v8::Local<v8::ArrayBuffer> array_buffer =
+            buffer.As<v8::Uint8Array>()->Buffer();
+        if (binary_tag == TAG_ARRAY_BUFFER)
+          return AddObject(array_buffer, value);
+        if (binary_tag == TAG_ARRAY_BUFFER_VIEW)
+          return AddObject(
+              NewView(static_cast<ViewType>(type), array_buffer, length),
+              value);
+        return false;
+      }
+      case TAG_DATE: {
+        double time;
+        v8::Local<v8::Value> date;
+        if (!ReadDouble(&time) ||
+            !v8::Date::New(context_, time).ToLocal(&date))
+          return false;
+        return AddObject(date.As<v8::Object>(), value);
+      }
+      case TAG_REGEXP: {
+        uint8_t string_tag;
+        v8::Local<v8::String> source;
+        uint32_t flags;
+        v8::Local<v8::RegExp> regexp;
+        if (!ReadByte(&string_tag) || !ReadStringBody(string_tag, &source) ||
+            !ReadVarint(&flags) ||
+            !v8::RegExp::New(context_, source,
+                             static_cast<v8::RegExp::Flags>(
+                                 flags & kRegExpFlagsMask)).ToLocal(&regexp))
+          return false;
+        return AddObject(regexp, value);
+      }
+      case TAG_MAP: {
+        v8::Local<v8::Map> map = v8::Map::New(isolate_);
+        AddObject(map, value);
+        uint32_t length;
+        if (!ReadLength(&length) || length % 2 != 0)
+          return false;
+        for (uint32_t i = 0; i < length; i += 2) {
+          v8::Local<v8::Value> key;
+          v8::Local<v8::Value> element;
+          if (!ReadValue(depth + 1, &key) ||
+              !ReadValue(depth + 1, &element) ||
+              map->Set(context_, key, element).IsEmpty())
+            return false;
+        }
+        return true;
+      }
+      case TAG_SET: {
+        v8::Local<v8::Set> set = v8::Set::New(isolate_);
+        AddObject(set, value);
+        uint32_t length;
+        if (!ReadLength(&length))
+          return false;
+        for (uint32_t i = 0; i < length; ++i) {
+          v8::Local<v8::Value> element;
+          if (!ReadValue(depth + 1, &element) ||
+              set->Add(context_, element).IsEmpty())
+            return false;
+        }
+        return true;
+      }
+      case TAG_ARRAY: {
+        uint32_t length;
+        if (!ReadLength(&length))
+          return false;
+        v8::Local<v8::Array> array = v8::Array::New(isolate_, length);
+        AddObject(array, value);
+        for (uint32_t i = 0; i < length; ++i) {
+          v8::Local<v8::Value> element;
+          if (!ReadValue(depth + 1, &element) ||
+              !array->CreateDataProperty(context_, i, element).FromMaybe(false))
+            return false;
+        }
+        return true;
+      }
+      case TAG_OBJECT: {
+        uint32_t length;
+        if (!ReadLength(&length))
+          return false;
+        v8::Local<v8::Object> object = v8::Object::New(isolate_);
+        AddObject(object, value);
+        for (uint32_t i = 0; i < length; ++i) {
+          uint8_t string_tag;
+          v8::Local<v8::String> key;
+          v8::Local<v8::Value> element;
+          if (!ReadByte(&string_tag) || !ReadStringBody(string_tag, &key) ||
+              !ReadValue(depth + 1, &element) ||
+              !object->CreateDataProperty(context_, key, element)
+                   .FromMaybe(false))
+            return false;
+        }
+        return true;
+      }
+      default:
+        return false;
+    }
+  }
+
+  bool ReadStringBody(uint8_t tag, v8::Local<v8::String>* string) {
+    uint32_t length;
+    const char* data;
+    if (tag == TAG_ONE_BYTE_STRING) {
+      return ReadVarint(&length) && ReadRaw(length, &data) &&
+             v8::String::NewFromOneByte(
+                 isolate_, reinterpret_cast<const uint8_t*>(data),
+                 v8::NewStringType::kNormal, length).ToLocal(string);
+    } else if (tag == TAG_TWO_BYTE_STRING) {
+      if (!ReadVarint(&length) ||
+          !ReadRaw(static_cast<size_t>(length) * sizeof(uint16_t), &data))
+        return false;
+      // The data is not guaranteed to be aligned.
+      std::vector<uint16_t> buffer(length);
+      if (length > 0)
+        memcpy(buffer.data(), data, length * sizeof(uint16_t));
+      return v8::String::NewFromTwoByte(
+          isolate_, buffer.data(), v8::NewStringType::kNormal, length)
+          .ToLocal(string);
+    }
+    return false;
+  }
+
+  v8::Local<v8::ArrayBuffer> NewArrayBuffer(const char* data, size_t length) {
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate_, length);
+    if (length > 0)
+      memcpy(buffer->GetContents().Data(), data, length);
+    return buffer;
+  }
+
+  // Creates a node Buffer with |length| bytes at |offset| in the shared
+  // region, the buffer keeps the region mapped unless it is copied.
+  bool TakeSharedBuffer(uint32_t offset,
+                        size_t length,
+                        v8::Local<v8::Object>* buffer) {
+    char* data = GetSharedData(offset, length);
+    if (!data)
+      return false;
+    if (copy_shared_buffers_)
+      return node::Buffer::Copy(isolate_, data, length).ToLocal(buffer);
+
+    if (!region_)
+      region_ = new SharedRegion(std::move(shared_buffers_->front()));
+    if (!node::Buffer::New(isolate_, data, length, &FreeSharedMemory,
+                           region_.get()).ToLocal(buffer))
+      return false;
+    region_->AddRef();
+    return true;
+  }
+
+  char* GetSharedData(uint32_t offset, size_t length) {
+    if (!shared_data_) {
+      if (!shared_buffers_ || shared_buffers_->empty())
+        return nullptr;
+      base::SharedMemory* memory = shared_buffers_->front().get();
+      if (!memory || !memory->memory())
+        return nullptr;
+      shared_data_ = static_cast<char*>(memory->memory());
+      shared_size_ = memory->mapped_size();
+    }
+    if (offset > shared_size_ || length > shared_size_ - offset)
+      return nullptr;
+    return shared_data_ + offset;
+  }
+
+  bool AddObject(v8::Local<v8::Object> object, v8::Local<v8::Value>* value) {
+    objects_.push_back(object);
+    *value = object;
+    return true;
+  }
+
+  // Every element takes at least one byte, so longer lengths are invalid and
+  // are rejected before allocating anything.
+  bool ReadLength(uint32_t* length) {
+    return ReadVarint(length) &&
+           *length <= static_cast<size_t>(end_ - position_);
+  }
+
+  bool ReadByte(uint8_t* byte) {
+    if (position_ == end_)
+      return false;
+    *byte = static_cast<uint8_t>(*position_++);
+    return true;
+  }
+
+  bool ReadVarint(uint32_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+      uint8_t byte;
+      if (!ReadByte(&byte))
+        return false;
+      *value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  bool ReadDouble(double* value) {
+    const char* data;
+    if (!ReadRaw(sizeof(*value), &data))
+      return false;
+    memcpy(value, data, sizeof(*value));
+    return true;
+  }
+
+  bool ReadRaw(size_t size, const char** data) {
+    if (size > static_cast<size_t>(end_ - position_))
+      return false;
+    *data = position_;
+    position_ += size;
+    return true;
+  }
+
+  v8::Isolate* isolate_;
+  v8::Local<v8::Context> context_;
+  const char* position_;
+  const char* end_;
+  SharedMemoryList* shared_buffers_;
+  bool copy_shared_buffers_;
+  // The mapping of the first region in |shared_buffers_|, which moves to
+  // |region_| once a Buffer is created from it.
+  char* shared_data_;
+  size_t shared_size_;
+  scoped_refptr<SharedRegion> region_;
+  std::vector<v8::Local<v8::Object>> objects_;
+
+  DISALLOW_COPY_AND_ASSIGN(Deserializer);
+};
+
+}  // namespace
+
+SerializedV8Value::SerializedV8Value() : shared_buffers_size(0) {
+}
+
+SerializedV8Value::SerializedV8Value(const SerializedV8Value& other) = default;
+
+SerializedV8Value::~SerializedV8Value() {
+}
+
+void SetSharedMemoryThreshold(size_t threshold) {
+  base::subtle::NoBarrier_Store(
+      &g_shared_memory_threshold,
+      static_cast<base::subtle::AtomicWord>(threshold));
+}
+
+size_t GetSharedMemoryThreshold() {
+  return static_cast<size_t>(
+      base::subtle::NoBarrier_Load(&g_shared_memory_threshold));
+}
+
+bool SerializeV8Value(v8::Isolate* isolate,
+                      v8::Local<v8::Value> value,
+                      const SharedMemoryWriter& shared_memory_writer,
+                      SerializedV8Value* result,
+                      std::string* error) {
+  v8::HandleScope handle_scope(isolate);
+  if (Serializer(isolate, shared_memory_writer, result, error)
+          .Serialize(value))
+    return true;
+
+  // Nobody is going to receive the regions written so far.
+  for (const auto& handle : result->shared_buffers)
+    base::SharedMemory::CloseHandle(handle);
+  result->shared_buffers.clear();
+  return false;
+}
+
+SharedMemoryList TakeSharedMemory(const SerializedV8Value& value,
+                                  bool read_only) {
+  SharedMemoryList result;
+  for (const auto& handle : value.shared_buffers) {
+    result.emplace_back(new base::SharedMemory(handle, read_only));
+    // The deserializer fails when the region is not mapped.
+    MapSharedMemory(result.back().get(), value.shared_buffers_size);
+  }
+  return result;
+}
+
+v8::Local<v8::Value> DeserializeV8Value(v8::Isolate* isolate,
+                                        const std::vector<char>& data,
+                                        SharedMemoryList* shared_buffers,
+                                        bool copy_shared_buffers) {
+  v8::EscapableHandleScope handle_scope(isolate);
+  v8::Local<v8::Value> value = Deserializer(
+      isolate, data, shared_buffers, copy_shared_buffers).Deserialize();
+  if (value.IsEmpty())
+    return value;
+  return handle_scope.Escape(value);
+}
+
+}  // namespace atom
@@ -0,0 +1,86 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_COMMON_NATIVE_MATE_CONVERTERS_V8_VALUE_SERIALIZER_H_
+#define ATOM_COMMON_NATIVE_MATE_CONVERTERS_V8_VALUE_SERIALIZER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/memory/shared_memory.h"
+#include "v8/include/v8.h"
+
+namespace atom {
+
+// The serialized form of a value. Large binary data is moved out of |data|
+// into a shared memory region, which is owned by the receiver once the value
+// has been sent.
+struct SerializedV8Value {
+  SerializedV8Value();
+  SerializedV8Value(const SerializedV8Value& other);
+  ~SerializedV8Value();
+
+  std::vector<char> data;
+  // Holds at most one region with all the large buffers of the value.
+  std::vector<base::SharedMemoryHandle> shared_buffers;
+  uint32_t shared_buffers_size;
+};
+
+// Writes the large buffers of a value to |memory|.
+using SharedMemoryFiller = base::Callback<void(char* memory)>;
+
+// Creates a shared memory region of |size| bytes, writes it with |fill|, and
+// returns a handle of it that can be sent to the receiving process. It is run
+// at most once for each value.
+using SharedMemoryWriter = base::Callback<bool(size_t size,
+                                               const SharedMemoryFiller& fill,
+                                               base::SharedMemoryHandle*)>;
+
+// The shared memory regions received with a SerializedV8Value.
+using SharedMemoryList = std::vector<std::unique_ptr<base::SharedMemory>>;
+
+// Buffers of at least |threshold| bytes are moved to shared memory when a
+// writer is passed to SerializeV8Value, 0 disables it.
+void SetSharedMemoryThreshold(size_t threshold);
+size_t GetSharedMemoryThreshold();
+
+// Serializes |value| with structured clone semantics straight into a byte
+// buffer, without going through base::Value.
+//
+// Primitives, arrays, plain objects, Date, RegExp, Map and Set are supported,
+// and shared or cyclic references are kept. The contents of ArrayBuffers,
+// typed arrays and node Buffers are written as raw bytes, or handed to
+// |shared_memory_writer| when they are above the shared memory threshold.
+// The writer can be null.
+//
+// Returns false when |value| can not be cloned, |error| is then set unless a
+// JavaScript exception was thrown while reading |value|.
+bool SerializeV8Value(v8::Isolate* isolate,
+                      v8::Local<v8::Value> value,
+                      const SharedMemoryWriter& shared_memory_writer,
+                      SerializedV8Value* result,
+                      std::string* error);
+
+// Takes the ownership of the shared memory handles in |value|, and maps them
+// read-only with |read_only|.
+SharedMemoryList TakeSharedMemory(const SerializedV8Value& value,
+                                  bool read_only);
+
+// Recreates the value serialized in |data| in the current context, returns
+// an empty handle when |data| is malformed.
+//
+// The buffers in |shared_buffers| are moved into external ArrayBuffers
+// without copying, and the region is released when all of those are garbage
+// collected. With |copy_shared_buffers| they are copied instead, so the same
+// list can be deserialized again, and the sender can no longer change them.
+v8::Local<v8::Value> DeserializeV8Value(v8::Isolate* isolate,
+                                        const std::vector<char>& data,
+                                        SharedMemoryList* shared_buffers,
+                                        bool copy_shared_buffers);
+
+}  // namespace atom
+
+#endif  // ATOM_COMMON_NATIVE_MATE_CONVERTERS_V8_VALUE_SERIALIZER_H_
@@ -90,7 +90,10 @@ std::unique_ptr<const char*[]> StringVectorToArgArray(
   return array;
 }
 
-base::FilePath GetResourcesPath(bool is_browser) {
+}  // namespace
+
+// static
+base::FilePath NodeBindings::GetResourcesPath(bool is_browser) {
   auto command_line = base::CommandLine::ForCurrentProcess();
   base::FilePath exec_path(command_line->GetProgram());
   PathService::Get(base::FILE_EXE, &exec_path);
@@ -106,8 +109,6 @@ base::FilePath GetResourcesPath(bool is_browser) {
   return resources_path;
 }
 
-}  // namespace
-
 NodeBindings::NodeBindings(bool is_browser)
     : is_browser_(is_browser),
       message_loop_(nullptr),
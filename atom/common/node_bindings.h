@@ -5,6 +5,7 @@
 #ifndef ATOM_COMMON_NODE_BINDINGS_H_
 #define ATOM_COMMON_NODE_BINDINGS_H_
 
+#include "base/files/file_path.h"
 #include "base/macros.h"
 #include "base/memory/weak_ptr.h"
 #include "v8/include/v8.h"
@@ -24,6 +25,9 @@ class NodeBindings {
  public:
   static NodeBindings* Create(bool is_browser);
 
+  // Returns the directory of electron.asar and the app.
+  static base::FilePath GetResourcesPath(bool is_browser);
+
   virtual ~NodeBindings();
 
   // Setup V8, libuv.
@@ -0,0 +1,214 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/common/remote_object_registry.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace atom {
+
+namespace {
+
+// How many constructor names are reported by GetStats.
+const size_t kMaxConstructors = 10;
+
+// A rough estimate of the memory kept alive by |object| itself, not counting
+// the objects it references.
+size_t EstimateSize(v8::Isolate* isolate, v8::Local<v8::Object> object) {
+  size_t size = sizeof(void*) * (3 + object->InternalFieldCount());
+  if (object->IsArrayBufferView())
+    return size + object.As<v8::ArrayBufferView>()->ByteLength();
+  if (object->IsArrayBuffer())
+    return size + object.As<v8::ArrayBuffer>()->ByteLength();
+
+  v8::TryCatch try_catch(isolate);
+  v8::Local<v8::Array> names;
+  if (object->GetOwnPropertyNames(isolate->GetCurrentContext())
+          .ToLocal(&names))
+    size += sizeof(void*) * 2 * names->Length();
+  return size;
+}
+
+}  // namespace
+
+RemoteObjectRegistry::Stats::Stats() : count(0), bytes(0) {
+}
+
+RemoteObjectRegistry::Stats::Stats(const Stats& other) = default;
+
+RemoteObjectRegistry::Stats::~Stats() {
+}
+
+RemoteObjectRegistry::Entry::Entry() : hash(0), ref_count(0) {
+}
+
+RemoteObjectRegistry::Entry::~Entry() {
+}
+
+RemoteObjectRegistry::Context::Context() : generation(0) {
+}
+
+RemoteObjectRegistry::Context::~Context() {
+}
+
+RemoteObjectRegistry::WebContentsEntry::WebContentsEntry()
+    : next_generation(0) {
+}
+
+RemoteObjectRegistry::WebContentsEntry::~WebContentsEntry() {
+}
+
+RemoteObjectRegistry::RemoteObjectRegistry() : next_id_(0) {
+}
+
+RemoteObjectRegistry::~RemoteObjectRegistry() {
+}
+
+int32_t RemoteObjectRegistry::Add(v8::Isolate* isolate,
+                                  int web_contents_id,
+                                  const std::string& context_id,
+                                  v8::Local<v8::Object> object) {
+  int hash = object->GetIdentityHash();
+  int32_t id = FindId(object, hash);
+  if (id == 0) {
+    id = ++next_id_;
+    std::unique_ptr<Entry> entry(new Entry);
+    entry->object.Reset(isolate, object);
+    entry->hash = hash;
+    entries_[id] = std::move(entry);
+    ids_by_hash_.insert(std::make_pair(hash, id));
+  }
+
+  WebContentsEntry& web_contents = web_contents_[web_contents_id];
+  auto it = web_contents.contexts.find(context_id);
+  if (it == web_contents.contexts.end()) {
+    it = web_contents.contexts.insert(
+        std::make_pair(context_id, Context())).first;
+    it->second.generation = ++web_contents.next_generation;
+  }
+  if (it->second.ids.insert(id).second)
+    entries_[id]->ref_count++;
+  return id;
+}
+
+v8::MaybeLocal<v8::Object> RemoteObjectRegistry::Get(v8::Isolate* isolate,
+                                                     int32_t id) const {
+  auto it = entries_.find(id);
+  if (it == entries_.end())
+    return v8::MaybeLocal<v8::Object>();
+  return v8::Local<v8::Object>::New(isolate, it->second->object);
+}
+
+void RemoteObjectRegistry::Remove(int web_contents_id,
+                                  const std::string& context_id,
+                                  const std::vector<int32_t>& ids) {
+  auto web_contents = web_contents_.find(web_contents_id);
+  if (web_contents == web_contents_.end())
+    return;
+  auto context = web_contents->second.contexts.find(context_id);
+  if (context == web_contents->second.contexts.end())
+    return;
+  for (int32_t id : ids) {
+    if (context->second.ids.erase(id) > 0)
+      Dereference(id);
+  }
+}
+
+void RemoteObjectRegistry::ClearContext(int web_contents_id,
+                                        const std::string& context_id) {
+  auto web_contents = web_contents_.find(web_contents_id);
+  if (web_contents == web_contents_.end())
+    return;
+  auto context = web_contents->second.contexts.find(context_id);
+  if (context == web_contents->second.contexts.end())
+    return;
+  for (int32_t id : context->second.ids)
+    Dereference(id);
+  // The generation counter is kept for the next contexts.
+  web_contents->second.contexts.erase(context);
+}
+
+void RemoteObjectRegistry::ClearWebContents(int web_contents_id) {
+  auto web_contents = web_contents_.find(web_contents_id);
+  if (web_contents == web_contents_.end())
+    return;
+  for (const auto& context : web_contents->second.contexts) {
+    for (int32_t id : context.second.ids)
+      Dereference(id);
+  }
+  web_contents_.erase(web_contents);
+}
+
+RemoteObjectRegistry::Stats RemoteObjectRegistry::GetStats(
+    v8::Isolate* isolate, int web_contents_id) const {
+  Stats stats;
+  auto web_contents = web_contents_.find(web_contents_id);
+  if (web_contents == web_contents_.end())
+    return stats;
+
+  // An object can be referenced by more than one context.
+  std::unordered_set<int32_t> ids;
+  for (const auto& context : web_contents->second.contexts) {
+    ContextStats context_stats;
+    context_stats.context_id = context.first;
+    context_stats.generation = context.second.generation;
+    context_stats.count = context.second.ids.size();
+    stats.contexts.push_back(context_stats);
+    ids.insert(context.second.ids.begin(), context.second.ids.end());
+  }
+
+  v8::HandleScope handle_scope(isolate);
+  std::map<std::string, size_t> constructors;
+  for (int32_t id : ids) {
+    auto it = entries_.find(id);
+    DCHECK(it != entries_.end());
+    v8::Local<v8::Object> object =
+        v8::Local<v8::Object>::New(isolate, it->second->object);
+    stats.bytes += EstimateSize(isolate, object);
+    v8::String::Utf8Value name(object->GetConstructorName());
+    constructors[std::string(*name, name.length())]++;
+  }
+  stats.count = ids.size();
+
+  stats.constructors.assign(constructors.begin(), constructors.end());
+  std::stable_sort(stats.constructors.begin(), stats.constructors.end(),
+                   [](const std::pair<std::string, size_t>& a,
+                      const std::pair<std::string, size_t>& b) {
+                     return a.second > b.second;
+                   });
+  if (stats.constructors.size() > kMaxConstructors)
+    stats.constructors.resize(kMaxConstructors);
+  return stats;
+}
+
+int32_t RemoteObjectRegistry::FindId(v8::Local<v8::Object> object,
+                                     int hash) const {
+  auto range = ids_by_hash_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (entries_.at(it->second)->object == object)
+      return it->second;
+  }
+  return 0;
+}
+
+void RemoteObjectRegistry::Dereference(int32_t id) {
+  auto it = entries_.find(id);
+  if (it == entries_.end())
+    return;
+  if (--it->second->ref_count > 0)
+    return;
+
+  auto range = ids_by_hash_.equal_range(it->second->hash);
+  for (auto hash = range.first; hash != range.second; ++hash) {
+    if (hash->second == id) {
+      ids_by_hash_.erase(hash);
+      break;
+    }
+  }
+  entries_.erase(it);
+}
+
+}  // namespace atom
@@ -0,0 +1,120 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_COMMON_REMOTE_OBJECT_REGISTRY_H_
+#define ATOM_COMMON_REMOTE_OBJECT_REGISTRY_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "v8/include/v8.h"
+
+namespace atom {
+
+// Keeps the objects of the browser process that renderers reference through
+// the remote module, an object is kept alive as long as any renderer context
+// references it.
+//
+// The references are grouped by WebContents, and by the script context that
+// made them, so everything a context referenced can be released at once when
+// the context goes away. Each new context of a WebContents gets the next
+// generation number.
+class RemoteObjectRegistry {
+ public:
+  struct ContextStats {
+    std::string context_id;
+    int generation;
+    size_t count;
+  };
+
+  struct Stats {
+    Stats();
+    Stats(const Stats& other);
+    ~Stats();
+
+    // Objects referenced by the WebContents, and an estimate of their size.
+    size_t count;
+    size_t bytes;
+    std::vector<ContextStats> contexts;
+    // The most common constructor names, in descending order of count.
+    std::vector<std::pair<std::string, size_t>> constructors;
+  };
+
+  RemoteObjectRegistry();
+  ~RemoteObjectRegistry();
+
+  // Adds a reference to |object| from the context, and returns the id of the
+  // object, which stays the same while it is referenced.
+  int32_t Add(v8::Isolate* isolate,
+              int web_contents_id,
+              const std::string& context_id,
+              v8::Local<v8::Object> object);
+
+  // Gets the object by its |id|.
+  v8::MaybeLocal<v8::Object> Get(v8::Isolate* isolate, int32_t id) const;
+
+  // Removes the references to |ids| from the context.
+  void Remove(int web_contents_id,
+              const std::string& context_id,
+              const std::vector<int32_t>& ids);
+
+  // Removes all references of a context or a WebContents.
+  void ClearContext(int web_contents_id, const std::string& context_id);
+  void ClearWebContents(int web_contents_id);
+
+  Stats GetStats(v8::Isolate* isolate, int web_contents_id) const;
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    v8::Global<v8::Object> object;
+    int hash;
+    int ref_count;
+  };
+
+  struct Context {
+    Context();
+    ~Context();
+
+    int generation;
+    std::unordered_set<int32_t> ids;
+  };
+
+  struct WebContentsEntry {
+    WebContentsEntry();
+    ~WebContentsEntry();
+
+    int next_generation;
+    std::map<std::string, Context> contexts;
+  };
+
+  // Returns the id of a registered |object|, or 0.
+  int32_t FindId(v8::Local<v8::Object> object, int hash) const;
+
+  void Dereference(int32_t id);
+
+  int32_t next_id_;
+  std::unordered_map<int32_t, std::unique_ptr<Entry>> entries_;
+  // Finds the id of an object without tagging the object itself.
+  std::unordered_multimap<int, int32_t> ids_by_hash_;
+  std::map<int, WebContentsEntry> web_contents_;
+
+  DISALLOW_COPY_AND_ASSIGN(RemoteObjectRegistry);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_COMMON_REMOTE_OBJECT_REGISTRY_H_
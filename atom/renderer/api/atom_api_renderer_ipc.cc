@@ -2,15 +2,24 @@
 // Use of this source code is governed by the MIT license that can be
 // found in the LICENSE file.
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "atom/common/api/api_messages.h"
 #include "atom/common/native_mate_converters/string16_converter.h"
+#include "atom/common/native_mate_converters/v8_value_serializer.h"
 #include "atom/common/native_mate_converters/value_converter.h"
 #include "atom/common/node_includes.h"
+#include "atom/renderer/invoke_manager.h"
+#include "base/bind.h"
+#include "content/public/renderer/render_thread.h"
 #include "content/public/renderer/render_view.h"
 #include "native_mate/dictionary.h"
 #include "third_party/WebKit/public/web/WebLocalFrame.h"
 #include "third_party/WebKit/public/web/WebView.h"
 
+using atom::SerializeV8Value;
 using content::RenderView;
 using blink::WebLocalFrame;
 using blink::WebView;
@@ -43,6 +52,69 @@ void Send(mate::Arguments* args,
     args->ThrowError("Unable to send AtomViewHostMsg_Message");
 }
 
+// The renderer can not create shared memory by itself, the region is
+// allocated by the browser.
+bool WriteSharedMemory(size_t size,
+                       const atom::SharedMemoryFiller& fill,
+                       base::SharedMemoryHandle* handle) {
+  std::unique_ptr<base::SharedMemory> memory =
+      content::RenderThread::Get()->HostAllocateSharedMemoryBuffer(size);
+  if (!memory || !memory->Map(size))
+    return false;
+  fill.Run(static_cast<char*>(memory->memory()));
+  *handle = base::SharedMemory::DuplicateHandle(memory->handle());
+  return base::SharedMemory::IsHandleValid(*handle);
+}
+
+void SendStructured(mate::Arguments* args,
+                    const base::string16& channel,
+                    v8::Local<v8::Value> arguments) {
+  RenderView* render_view = GetCurrentRenderView();
+  if (render_view == nullptr)
+    return;
+
+  atom::SerializedV8Value value;
+  std::string error;
+  if (!SerializeV8Value(args->isolate(), arguments,
+                        base::Bind(&WriteSharedMemory), &value, &error)) {
+    // Otherwise the exception thrown while reading |arguments| is pending.
+    if (!error.empty())
+      args->ThrowError(error);
+    return;
+  }
+
+  bool success = render_view->Send(new AtomViewHostMsg_StructuredMessage(
+      render_view->GetRoutingID(), channel, value));
+
+  if (!success)
+    args->ThrowError("Unable to send AtomViewHostMsg_StructuredMessage");
+}
+
+v8::Local<v8::Value> Invoke(mate::Arguments* args,
+                            const base::string16& channel,
+                            v8::Local<v8::Value> arguments,
+                            double timeout) {
+  RenderView* render_view = GetCurrentRenderView();
+  if (render_view == nullptr)
+    return v8::Undefined(args->isolate());
+
+  atom::SerializedV8Value value;
+  std::string error;
+  if (!SerializeV8Value(args->isolate(), arguments,
+                        base::Bind(&WriteSharedMemory), &value, &error)) {
+    if (!error.empty())
+      args->ThrowError(error);
+    return v8::Undefined(args->isolate());
+  }
+
+  v8::Local<v8::Promise> promise = atom::InvokeManager::GetInstance()->Invoke(
+      args->isolate(), render_view->GetRoutingID(), channel, value,
+      base::TimeDelta::FromMillisecondsD(timeout));
+  if (promise.IsEmpty())
+    return v8::Undefined(args->isolate());
+  return promise;
+}
+
 base::string16 SendSync(mate::Arguments* args,
                         const base::string16& channel,
                         const base::ListValue& arguments) {
@@ -66,6 +138,8 @@ void Initialize(v8::Local<v8::Object> exports, v8::Local<v8::Value> unused,
                 v8::Local<v8::Context> context, void* priv) {
   mate::Dictionary dict(context->GetIsolate(), exports);
   dict.SetMethod("send", &Send);
+  dict.SetMethod("sendStructured", &SendStructured);
+  dict.SetMethod("invoke", &Invoke);
   dict.SetMethod("sendSync", &SendSync);
 }
 
@@ -13,10 +13,12 @@
 #include "atom/browser/web_contents_preferences.h"
 #include "atom/common/api/api_messages.h"
 #include "atom/common/api/event_emitter_caller.h"
+#include "atom/common/native_mate_converters/v8_value_serializer.h"
 #include "atom/common/native_mate_converters/value_converter.h"
 #include "atom/common/node_includes.h"
 #include "atom/common/options_switches.h"
 #include "atom/renderer/atom_renderer_client.h"
+#include "atom/renderer/invoke_manager.h"
 #include "base/command_line.h"
 #include "base/strings/string_number_conversions.h"
 #include "content/public/renderer/render_view.h"
@@ -51,18 +53,35 @@ bool GetIPCObject(v8::Isolate* isolate,
   return true;
 }
 
-std::vector<v8::Local<v8::Value>> ListValueToVector(
-    v8::Isolate* isolate,
-    const base::ListValue& list) {
+bool ToArgumentsVector(v8::Isolate* isolate,
+                       const base::ListValue& list,
+                       std::vector<v8::Local<v8::Value>>* result) {
   v8::Local<v8::Value> array = mate::ConvertToV8(isolate, list);
-  std::vector<v8::Local<v8::Value>> result;
-  mate::ConvertFromV8(isolate, array, &result);
-  return result;
+  return mate::ConvertFromV8(isolate, array, result);
 }
 
+// The arguments of a structured message, with the shared memory regions that
+// came with it.
+struct StructuredArguments {
+  const std::vector<char>& data;
+  SharedMemoryList* shared_buffers;
+  // Each frame needs its own copy when the message goes to several frames.
+  bool copy_shared_buffers;
+};
+
+bool ToArgumentsVector(v8::Isolate* isolate,
+                       const StructuredArguments& args,
+                       std::vector<v8::Local<v8::Value>>* result) {
+  v8::Local<v8::Value> array = DeserializeV8Value(
+      isolate, args.data, args.shared_buffers, args.copy_shared_buffers);
+  return !array.IsEmpty() && array->IsArray() &&
+         mate::ConvertFromV8(isolate, array, result);
+}
+
+template<typename Args>
 void EmitIPCEvent(blink::WebFrame* frame,
                   const base::string16& channel,
-                  const base::ListValue& args) {
+                  const Args& args) {
   if (!frame || frame->isWebRemoteFrame())
     return;
 
@@ -78,8 +97,9 @@ void EmitIPCEvent(blink::WebFrame* frame,
     return;
 
   v8::Local<v8::Object> ipc;
-  if (GetIPCObject(isolate, context, &ipc)) {
-    auto args_vector = ListValueToVector(isolate, args);
+  std::vector<v8::Local<v8::Value>> args_vector;
+  if (GetIPCObject(isolate, context, &ipc) &&
+      ToArgumentsVector(isolate, args, &args_vector)) {
     // Insert the Event object, event.sender is ipc.
     mate::Dictionary event = mate::Dictionary::CreateEmpty(isolate);
     event.Set("sender", ipc);
@@ -88,6 +108,30 @@ void EmitIPCEvent(blink::WebFrame* frame,
   }
 }
 
+// Emits the message in the main frame, and in its sub-frames when
+// |send_to_all| is set.
+template<typename Args>
+void EmitIPCEventInFrames(content::RenderView* render_view,
+                          bool send_to_all,
+                          const base::string16& channel,
+                          const Args& args) {
+  if (!render_view->GetWebView())
+    return;
+
+  blink::WebFrame* frame = render_view->GetWebView()->mainFrame();
+  if (!frame || frame->isWebRemoteFrame())
+    return;
+
+  EmitIPCEvent(frame, channel, args);
+
+  // Also send the message to all sub-frames.
+  if (send_to_all) {
+    for (blink::WebFrame* child = frame->firstChild(); child;
+         child = child->nextSibling())
+      EmitIPCEvent(child, channel, args);
+  }
+}
+
 base::StringPiece NetResourceProvider(int key) {
   if (key == IDR_DIR_HEADER_HTML) {
     base::StringPiece html_data =
@@ -150,6 +194,11 @@ bool AtomRenderViewObserver::OnMessageReceived(const IPC::Message& message) {
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(AtomRenderViewObserver, message)
     IPC_MESSAGE_HANDLER(AtomViewMsg_Message, OnBrowserMessage)
+    IPC_MESSAGE_HANDLER(AtomViewMsg_StructuredMessage,
+                        OnBrowserStructuredMessage)
+    IPC_MESSAGE_HANDLER(AtomViewMsg_BroadcastMessage,
+                        OnBrowserBroadcastMessage)
+    IPC_MESSAGE_HANDLER(AtomViewMsg_InvokeReply, OnInvokeReply)
     IPC_MESSAGE_UNHANDLED(handled = false)
   IPC_END_MESSAGE_MAP()
 
@@ -162,21 +211,38 @@ void AtomRenderViewObserver::OnBrowserMessage(bool send_to_all,
   if (!document_created_)
     return;
 
-  if (!render_view()->GetWebView())
+  EmitIPCEventInFrames(render_view(), send_to_all, channel, args);
+}
+
+void AtomRenderViewObserver::OnBrowserStructuredMessage(
+    bool send_to_all,
+    const base::string16& channel,
+    const SerializedV8Value& value) {
+  // Closes the regions when they are not used.
+  SharedMemoryList shared_buffers = TakeSharedMemory(value, false);
+  if (!document_created_)
     return;
 
-  blink::WebFrame* frame = render_view()->GetWebView()->mainFrame();
-  if (!frame || frame->isWebRemoteFrame())
+  StructuredArguments args = { value.data, &shared_buffers, send_to_all };
+  EmitIPCEventInFrames(render_view(), send_to_all, channel, args);
+}
+
+void AtomRenderViewObserver::OnBrowserBroadcastMessage(
+    const base::string16& channel,
+    const SerializedV8Value& value) {
+  // Other processes received the same region, so it is only read.
+  SharedMemoryList shared_buffers = TakeSharedMemory(value, true);
+  if (!document_created_)
     return;
 
-  EmitIPCEvent(frame, channel, args);
+  StructuredArguments args = { value.data, &shared_buffers, true };
+  EmitIPCEventInFrames(render_view(), false, channel, args);
+}
 
-  // Also send the message to all sub-frames.
-  if (send_to_all) {
-    for (blink::WebFrame* child = frame->firstChild(); child;
-         child = child->nextSibling())
-      EmitIPCEvent(child, channel, args);
-  }
+void AtomRenderViewObserver::OnInvokeReply(int request_id,
+                                           bool success,
+                                           const SerializedV8Value& result) {
+  InvokeManager::GetInstance()->OnReply(request_id, success, result);
 }
 
 }  // namespace atom
@@ -15,6 +15,7 @@ class ListValue;
 namespace atom {
 
 class AtomRendererClient;
+struct SerializedV8Value;
 
 class AtomRenderViewObserver : public content::RenderViewObserver {
  public:
@@ -33,6 +34,14 @@ class AtomRenderViewObserver : public content::RenderViewObserver {
   void OnBrowserMessage(bool send_to_all,
                         const base::string16& channel,
                         const base::ListValue& args);
+  void OnBrowserStructuredMessage(bool send_to_all,
+                                  const base::string16& channel,
+                                  const SerializedV8Value& value);
+  void OnBrowserBroadcastMessage(const base::string16& channel,
+                                 const SerializedV8Value& value);
+  void OnInvokeReply(int request_id,
+                     bool success,
+                     const SerializedV8Value& result);
 
   // Weak reference to renderer client.
   AtomRendererClient* renderer_client_;
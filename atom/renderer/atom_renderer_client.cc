@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 
+#include "atom/browser/web_contents_preferences.h"
 #include "atom/common/api/api_messages.h"
 #include "atom/common/api/atom_bindings.h"
 #include "atom/common/api/event_emitter_caller.h"
@@ -17,9 +18,12 @@
 #include "atom/common/options_switches.h"
 #include "atom/renderer/atom_render_view_observer.h"
 #include "atom/renderer/guest_view_container.h"
+#include "atom/renderer/invoke_manager.h"
 #include "atom/renderer/node_array_buffer_bridge.h"
 #include "atom/renderer/preferences_manager.h"
 #include "base/command_line.h"
+#include "base/process/process_handle.h"
+#include "base/strings/stringprintf.h"
 #include "chrome/renderer/media/chrome_key_systems.h"
 #include "chrome/renderer/pepper/pepper_helper.h"
 #include "chrome/renderer/printing/print_web_view_helper.h"
@@ -119,7 +123,9 @@ bool IsDevToolsExtension(content::RenderFrame* render_frame) {
 
 AtomRendererClient::AtomRendererClient()
     : node_bindings_(NodeBindings::Create(false)),
-      atom_bindings_(new AtomBindings) {
+      atom_bindings_(new AtomBindings),
+      node_initialized_(false),
+      next_context_id_(0) {
   // Parse --standard-schemes=scheme1,scheme2
   base::CommandLine* command_line = base::CommandLine::ForCurrentProcess();
   std::string custom_schemes = command_line->GetSwitchValueASCII(
@@ -143,6 +149,12 @@ void AtomRendererClient::RenderThreadStarted() {
 
   preferences_manager_.reset(new PreferencesManager);
 
+  // Initialize node before any page is loaded when the renderer's pages will
+  // use it, so a renderer launched ahead of its navigation only has to create
+  // the environment of the page.
+  if (WebContentsPreferences::run_node())
+    InitializeNode();
+
 #if defined(OS_WIN)
   // Set ApplicationUserModelID in renderer process.
   base::CommandLine* command_line = base::CommandLine::ForCurrentProcess();
@@ -167,6 +179,12 @@ void AtomRendererClient::RenderThreadStarted() {
 #endif
 }
 
+void AtomRendererClient::InitializeNode() {
+  node_bindings_->Initialize();
+  node_bindings_->PrepareMessageLoop();
+  node_initialized_ = true;
+}
+
 void AtomRendererClient::RenderFrameCreated(
     content::RenderFrame* render_frame) {
   new PepperHelper(render_frame);
@@ -249,14 +267,11 @@ void AtomRendererClient::DidCreateScriptContext(
   if (!render_frame->IsMainFrame() && !IsDevToolsExtension(render_frame))
     return;
 
-  // Whether the node binding has been initialized.
+  // Whether the node environment of any window has been created.
   bool first_time = node_bindings_->uv_env() == nullptr;
 
-  // Prepare the node bindings.
-  if (first_time) {
-    node_bindings_->Initialize();
-    node_bindings_->PrepareMessageLoop();
-  }
+  if (!node_initialized_)
+    InitializeNode();
 
   // Setup node environment for each window.
   node::Environment* env = node_bindings_->CreateEnvironment(context);
@@ -266,6 +281,13 @@ void AtomRendererClient::DidCreateScriptContext(
   AddRenderBindings(env->isolate(), env->process_object(),
                     preferences_manager_.get());
 
+  // Identifies the context to the browser, which releases the objects it
+  // referenced through the remote module once it is gone.
+  mate::Dictionary process(env->isolate(), env->process_object());
+  process.SetHidden("contextId", base::StringPrintf(
+      "%d-%d", static_cast<int>(base::GetCurrentProcId()),
+      ++next_context_id_));
+
   // Load everything.
   node_bindings_->LoadEnvironment(env);
 
@@ -285,6 +307,9 @@ void AtomRendererClient::WillReleaseScriptContext(
   if (!render_frame->IsMainFrame() && !IsDevToolsExtension(render_frame))
     return;
 
+  // The pending ipcRenderer.invoke requests are cancelled on navigation.
+  InvokeManager::GetInstance()->CancelRequests(context);
+
   node::Environment* env = node::Environment::GetCurrent(context);
   if (env)
     mate::EmitEvent(env->isolate(), env->process_object(), "exit");
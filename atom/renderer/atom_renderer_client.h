@@ -39,6 +39,9 @@ class AtomRendererClient : public content::ContentRendererClient {
     DISABLE,
   };
 
+  // Runs node's process-wide initialization.
+  void InitializeNode();
+
   // content::ContentRendererClient:
   void RenderThreadStarted() override;
   void RenderFrameCreated(content::RenderFrame*) override;
@@ -69,6 +72,12 @@ class AtomRendererClient : public content::ContentRendererClient {
   std::unique_ptr<AtomBindings> atom_bindings_;
   std::unique_ptr<PreferencesManager> preferences_manager_;
 
+  // Whether node's process-wide initialization has run.
+  bool node_initialized_;
+
+  // The number of script contexts with node integration created so far.
+  int next_context_id_;
+
   friend class brave::BraveContentRendererClient;
 
   DISALLOW_COPY_AND_ASSIGN(AtomRendererClient);
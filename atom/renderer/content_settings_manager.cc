@@ -8,7 +8,6 @@
 #include <vector>
 #include "atom/common/api/api_messages.h"
 #include "base/values.h"
-#include "components/content_settings/core/common/content_settings_pattern.h"
 #include "content/public/common/url_constants.h"
 #include "content/public/renderer/render_thread.h"
 #include "url/url_constants.h"
@@ -51,6 +50,7 @@ void ContentSettingsManager::OnUpdateWebKitPrefs(
 void ContentSettingsManager::OnUpdateContentSettings(
     const base::DictionaryValue& content_settings) {
   content_settings_ = content_settings.CreateDeepCopy();
+  rules_.clear();
   FOR_EACH_OBSERVER(
     ContentSettingsObserver,
     observers_,
@@ -111,47 +111,26 @@ ContentSetting ContentSettingsManager::GetContentSettingFromRules(
     ? ContentSetting::CONTENT_SETTING_ALLOW
     : ContentSetting::CONTENT_SETTING_BLOCK;
 
-  const base::ListValue* rules = nullptr;
-  if (!content_settings_->GetList(content_type, &rules))
-    return result;
-
-  // all rules are evaluated in order and the
-  // most specific matching rule will apply
-  for (base::ListValue::const_iterator it = rules->begin();
-       it != rules->end(); ++it) {
-    base::DictionaryValue* rule;
-    std::string pattern_string;
-    std::string setting_string;
-    if (!(*it)->GetAsDictionary(&rule) ||
-        !rule->GetString("primaryPattern", &pattern_string) ||
-        !rule->GetString("setting", &setting_string)) {
-      // skip invalid entries
-      // TODO(bridiver) should also send an ipc error message
-      ++it;
-    } else {
-      std::string secondary_pattern_string;
-      rule->GetString("secondaryPattern", &secondary_pattern_string);
-
-      ContentSetting setting = result;
-      if (setting_string != "block" && setting_string != "deny") {
-        setting = ContentSetting::CONTENT_SETTING_ALLOW;
-      } else {
-        setting = ContentSetting::CONTENT_SETTING_BLOCK;
-      }
-
-      if (secondary_pattern_string == "[firstParty]") {
-        secondary_pattern_string = "[*.]" + primary_url.HostNoBrackets();
-      }
-
-      if (ContentSettingsPattern::FromString(
-            pattern_string).Matches(primary_url) &&
-          // if there is a secondary resource pattern it has to match as well
-          (secondary_pattern_string.empty() ||
-            ContentSettingsPattern::FromString(
-              secondary_pattern_string).Matches(secondary_url)))
-        result = setting;
-    }
-  }
+  const ContentSettingsRules* rules = GetRules(content_type);
+  if (rules)
+    rules->GetSetting(primary_url, secondary_url, &result);
   return result;
 }
+
+const ContentSettingsRules* ContentSettingsManager::GetRules(
+    const std::string& content_type) {
+  auto it = rules_.find(content_type);
+  if (it != rules_.end())
+    return it->second.get();
+
+  // The patterns are parsed here instead of when the content settings are
+  // updated, so they see the schemes registered by ContentSettingsClient.
+  const base::ListValue* rules = nullptr;
+  if (!content_settings_ || !content_settings_->GetList(content_type, &rules))
+    return nullptr;
+  std::unique_ptr<ContentSettingsRules>& compiled = rules_[content_type];
+  compiled.reset(new ContentSettingsRules(*rules));
+  return compiled.get();
+}
+
 }  // namespace atom
@@ -5,10 +5,12 @@
 #ifndef ATOM_RENDERER_CONTENT_SETTINGS_MANAGER_H_
 #define ATOM_RENDERER_CONTENT_SETTINGS_MANAGER_H_
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 #include "atom/renderer/content_settings_observer.h"
+#include "atom/renderer/content_settings_rules.h"
 #include "base/values.h"
 #include "components/content_settings/core/common/content_settings.h"
 #include "content/public/common/web_preferences.h"
@@ -74,6 +76,9 @@ class ContentSettingsManager : public content::RenderThreadObserver {
     const std::string& content_type,
     const bool& enabled_per_settings);
 
+  // Returns the compiled rules of |content_type|, or nullptr if it has none.
+  const ContentSettingsRules* GetRules(const std::string& content_type);
+
   // content::RenderThreadObserver:
   bool OnControlMessageReceived(const IPC::Message& message) override;
 
@@ -87,6 +92,10 @@ class ContentSettingsManager : public content::RenderThreadObserver {
   content::WebPreferences web_preferences_;
   std::unique_ptr<base::DictionaryValue> content_settings_;
 
+  // The rules of each content type, compiled when they are first used after
+  // the content settings are updated.
+  std::map<std::string, std::unique_ptr<ContentSettingsRules>> rules_;
+
   DISALLOW_COPY_AND_ASSIGN(ContentSettingsManager);
 };
 
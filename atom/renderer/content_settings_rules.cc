@@ -0,0 +1,172 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/renderer/content_settings_rules.h"
+
+#include <utility>
+
+#include "base/strings/string_util.h"
+#include "base/values.h"
+#include "url/gurl.h"
+#include "url/url_canon.h"
+#include "url/url_canon_stdstring.h"
+
+namespace atom {
+
+namespace {
+
+const char kDomainWildcard[] = "[*.]";
+
+// Reads the host of |pattern|, returns false when the pattern could match
+// other hosts, or its host might be written differently in URLs.
+bool GetPatternHost(const std::string& pattern,
+                    std::string* host,
+                    bool* domain_wildcard) {
+  size_t start = pattern.find("://");
+  start = start == std::string::npos ? 0 : start + 3;
+  size_t end = pattern.find_first_of(":/", start);
+  *host = pattern.substr(start, end == std::string::npos ? end : end - start);
+
+  *domain_wildcard = base::StartsWith(*host, kDomainWildcard,
+                                      base::CompareCase::SENSITIVE);
+  if (*domain_wildcard)
+    host->erase(0, arraysize(kDomainWildcard) - 1);
+
+  // Leave the canonicalization of unusual hosts to the pattern.
+  if (host->empty() || host->front() == '.' || host->back() == '.')
+    return false;
+  for (char c : *host) {
+    if (!base::IsAsciiAlpha(c) && !base::IsAsciiDigit(c) && c != '.' &&
+        c != '-')
+      return false;
+  }
+
+  // Hosts like "127.1" or "0x7f.1" are IP addresses, bucket them the way
+  // GURL writes them. Domain wildcards do not apply to IP addresses.
+  std::string canonical;
+  url::StdStringCanonOutput output(&canonical);
+  url::CanonHostInfo host_info;
+  url::CanonicalizeHost(host->data(),
+                        url::Component(0, static_cast<int>(host->size())),
+                        &output, &host_info);
+  output.Complete();
+  if (host_info.family == url::CanonHostInfo::BROKEN ||
+      (host_info.IsIPAddress() && *domain_wildcard))
+    return false;
+  *host = canonical;
+  return true;
+}
+
+}  // namespace
+
+ContentSettingsRules::Rule::Rule()
+    : has_secondary_pattern(false),
+      first_party(false),
+      setting(CONTENT_SETTING_DEFAULT) {
+}
+
+ContentSettingsRules::Rule::~Rule() {
+}
+
+ContentSettingsRules::ContentSettingsRules(const base::ListValue& rules) {
+  for (const auto& value : rules) {
+    const base::DictionaryValue* dict = nullptr;
+    std::string primary_pattern;
+    std::string setting;
+    // Skip invalid entries.
+    if (!value->GetAsDictionary(&dict) ||
+        !dict->GetString("primaryPattern", &primary_pattern) ||
+        !dict->GetString("setting", &setting))
+      continue;
+
+    std::unique_ptr<Rule> rule(new Rule);
+    rule->primary_pattern = ContentSettingsPattern::FromString(primary_pattern);
+    std::string secondary_pattern;
+    dict->GetString("secondaryPattern", &secondary_pattern);
+    if (secondary_pattern == "[firstParty]") {
+      rule->first_party = true;
+    } else if (!secondary_pattern.empty()) {
+      rule->has_secondary_pattern = true;
+      rule->secondary_pattern =
+          ContentSettingsPattern::FromString(secondary_pattern);
+    }
+    rule->setting = setting != "block" && setting != "deny" ?
+        CONTENT_SETTING_ALLOW : CONTENT_SETTING_BLOCK;
+
+    // Rules with invalid patterns never match.
+    if (!rule->primary_pattern.IsValid() ||
+        (rule->has_secondary_pattern && !rule->secondary_pattern.IsValid()))
+      continue;
+
+    size_t index = rules_.size();
+    std::string host;
+    bool domain_wildcard;
+    if (!GetPatternHost(primary_pattern, &host, &domain_wildcard))
+      other_rules_.push_back(index);
+    else if (domain_wildcard)
+      domain_rules_[host].push_back(index);
+    else
+      host_rules_[host].push_back(index);
+    rules_.push_back(std::move(rule));
+  }
+}
+
+ContentSettingsRules::~ContentSettingsRules() {
+}
+
+bool ContentSettingsRules::GetSetting(const GURL& primary_url,
+                                      const GURL& secondary_url,
+                                      ContentSetting* setting) const {
+  int index = -1;
+  MatchBucket(other_rules_, primary_url, secondary_url, &index);
+
+  const std::string& host = primary_url.host();
+  auto it = host_rules_.find(host);
+  if (it != host_rules_.end())
+    MatchBucket(it->second, primary_url, secondary_url, &index);
+
+  // Test the domain rules of the host and all of its parent domains.
+  for (size_t pos = 0; pos != std::string::npos && !domain_rules_.empty();) {
+    it = domain_rules_.find(host.substr(pos));
+    if (it != domain_rules_.end())
+      MatchBucket(it->second, primary_url, secondary_url, &index);
+    pos = host.find('.', pos);
+    if (pos != std::string::npos)
+      ++pos;
+  }
+
+  if (index < 0)
+    return false;
+  *setting = rules_[index]->setting;
+  return true;
+}
+
+bool ContentSettingsRules::Matches(const Rule& rule,
+                                   const GURL& primary_url,
+                                   const GURL& secondary_url) const {
+  if (!rule.primary_pattern.Matches(primary_url))
+    return false;
+  if (rule.first_party) {
+    return ContentSettingsPattern::FromString(
+        kDomainWildcard + primary_url.HostNoBrackets()).Matches(secondary_url);
+  }
+  // If there is a secondary resource pattern it has to match as well.
+  return !rule.has_secondary_pattern ||
+         rule.secondary_pattern.Matches(secondary_url);
+}
+
+void ContentSettingsRules::MatchBucket(const Bucket& bucket,
+                                       const GURL& primary_url,
+                                       const GURL& secondary_url,
+                                       int* index) const {
+  for (auto it = bucket.rbegin();
+       it != bucket.rend() && static_cast<int>(*it) > *index; ++it) {
+    if (Matches(*rules_[*it], primary_url, secondary_url)) {
+      *index = static_cast<int>(*it);
+      return;
+    }
+  }
+}
+
+}  // namespace atom
@@ -0,0 +1,84 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_RENDERER_CONTENT_SETTINGS_RULES_H_
+#define ATOM_RENDERER_CONTENT_SETTINGS_RULES_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+#include "components/content_settings/core/common/content_settings.h"
+#include "components/content_settings/core/common/content_settings_pattern.h"
+
+class GURL;
+
+namespace base {
+class ListValue;
+}
+
+namespace atom {
+
+// The rules of a content type, with their patterns parsed once and indexed
+// by the host of the primary pattern.
+//
+// Rules are evaluated in order and the last matching rule applies. Only the
+// rules whose primary pattern can match the host of the URL are tested, so
+// the result is the same as testing every rule.
+class ContentSettingsRules {
+ public:
+  explicit ContentSettingsRules(const base::ListValue& rules);
+  ~ContentSettingsRules();
+
+  // Sets |setting| to the setting of the last rule matching the URLs, returns
+  // false when there is none.
+  bool GetSetting(const GURL& primary_url,
+                  const GURL& secondary_url,
+                  ContentSetting* setting) const;
+
+  size_t size() const { return rules_.size(); }
+
+ private:
+  struct Rule {
+    Rule();
+    ~Rule();
+
+    ContentSettingsPattern primary_pattern;
+    ContentSettingsPattern secondary_pattern;
+    bool has_secondary_pattern;
+    // The secondary pattern is the domain of the primary URL.
+    bool first_party;
+    ContentSetting setting;
+  };
+
+  using Bucket = std::vector<size_t>;
+
+  bool Matches(const Rule& rule,
+               const GURL& primary_url,
+               const GURL& secondary_url) const;
+
+  // Updates |index| with the last rule in |bucket| that matches the URLs and
+  // comes after |index|.
+  void MatchBucket(const Bucket& bucket,
+                   const GURL& primary_url,
+                   const GURL& secondary_url,
+                   int* index) const;
+
+  std::vector<std::unique_ptr<Rule>> rules_;
+
+  // Indexes of |rules_|, in order, keyed by the host of their primary pattern.
+  std::unordered_map<std::string, Bucket> host_rules_;
+  // Same as above for the patterns that match the host and its subdomains.
+  std::unordered_map<std::string, Bucket> domain_rules_;
+  // The rules that can match any host.
+  Bucket other_rules_;
+
+  DISALLOW_COPY_AND_ASSIGN(ContentSettingsRules);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_RENDERER_CONTENT_SETTINGS_RULES_H_
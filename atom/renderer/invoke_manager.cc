@@ -0,0 +1,169 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/renderer/invoke_manager.h"
+
+#include <utility>
+#include <vector>
+
+#include "atom/common/api/api_messages.h"
+#include "atom/common/native_mate_converters/v8_value_serializer.h"
+#include "base/bind.h"
+#include "base/macros.h"
+#include "base/message_loop/message_loop.h"
+#include "base/strings/utf_string_conversions.h"
+#include "content/public/renderer/render_thread.h"
+#include "native_mate/converter.h"
+
+namespace atom {
+
+namespace {
+
+base::LazyInstance<InvokeManager>::Leaky g_invoke_manager =
+    LAZY_INSTANCE_INITIALIZER;
+
+void RejectWithError(v8::Isolate* isolate,
+                     v8::Local<v8::Context> context,
+                     v8::Local<v8::Promise::Resolver> resolver,
+                     const std::string& message) {
+  ignore_result(resolver->Reject(
+      context, v8::Exception::Error(mate::StringToV8(isolate, message))));
+}
+
+}  // namespace
+
+InvokeManager::Request::Request() : routing_id(0), isolate(nullptr) {
+}
+
+InvokeManager::Request::~Request() {
+}
+
+InvokeManager::InvokeManager() : next_request_id_(0) {
+}
+
+InvokeManager::~InvokeManager() {
+}
+
+// static
+InvokeManager* InvokeManager::GetInstance() {
+  return g_invoke_manager.Pointer();
+}
+
+v8::Local<v8::Promise> InvokeManager::Invoke(v8::Isolate* isolate,
+                                             int routing_id,
+                                             const base::string16& channel,
+                                             const SerializedV8Value& args,
+                                             base::TimeDelta timeout) {
+  v8::EscapableHandleScope handle_scope(isolate);
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Promise::Resolver> resolver;
+  if (!v8::Promise::Resolver::New(context).ToLocal(&resolver))
+    return v8::Local<v8::Promise>();
+
+  int request_id = ++next_request_id_;
+  if (!content::RenderThread::Get()->Send(new AtomViewHostMsg_Invoke(
+          routing_id, request_id, channel, args))) {
+    RejectWithError(isolate, context, resolver,
+                    "Unable to send AtomViewHostMsg_Invoke");
+    return handle_scope.Escape(resolver->GetPromise());
+  }
+
+  std::unique_ptr<Request> request(new Request);
+  request->routing_id = routing_id;
+  request->channel = base::UTF16ToUTF8(channel);
+  request->isolate = isolate;
+  request->context.Reset(isolate, context);
+  request->resolver.Reset(isolate, resolver);
+  requests_[request_id] = std::move(request);
+
+  if (!timeout.is_zero()) {
+    base::MessageLoop::current()->PostDelayedTask(
+        FROM_HERE,
+        base::Bind(&InvokeManager::OnTimeout, base::Unretained(this),
+                   request_id),
+        timeout);
+  }
+  return handle_scope.Escape(resolver->GetPromise());
+}
+
+void InvokeManager::OnReply(int request_id,
+                            bool success,
+                            const SerializedV8Value& result) {
+  SharedMemoryList shared_buffers = TakeSharedMemory(result, false);
+  auto it = requests_.find(request_id);
+  if (it == requests_.end())
+    return;
+  std::unique_ptr<Request> request = std::move(it->second);
+  requests_.erase(it);
+
+  v8::Isolate* isolate = request->isolate;
+  v8::HandleScope handle_scope(isolate);
+  v8::Local<v8::Context> context =
+      v8::Local<v8::Context>::New(isolate, request->context);
+  v8::Context::Scope context_scope(context);
+  v8::MicrotasksScope script_scope(isolate,
+                                   v8::MicrotasksScope::kRunMicrotasks);
+  v8::Local<v8::Promise::Resolver> resolver =
+      v8::Local<v8::Promise::Resolver>::New(isolate, request->resolver);
+
+  v8::Local<v8::Value> value =
+      DeserializeV8Value(isolate, result.data, &shared_buffers, false);
+  if (value.IsEmpty()) {
+    RejectWithError(isolate, context, resolver,
+                    "Received a malformed reply on '" + request->channel +
+                    "'");
+  } else if (success) {
+    ignore_result(resolver->Resolve(context, value));
+  } else if (value->IsString()) {
+    ignore_result(resolver->Reject(
+        context, v8::Exception::Error(value.As<v8::String>())));
+  } else {
+    ignore_result(resolver->Reject(context, value));
+  }
+}
+
+void InvokeManager::CancelRequests(v8::Local<v8::Context> context) {
+  std::vector<int> request_ids;
+  for (const auto& it : requests_) {
+    if (it.second->context == context)
+      request_ids.push_back(it.first);
+  }
+  // The promises are gone with the context, so they are not settled.
+  for (int request_id : request_ids)
+    CancelRequest(request_id);
+}
+
+void InvokeManager::OnTimeout(int request_id) {
+  std::unique_ptr<Request> request = CancelRequest(request_id);
+  if (!request)
+    return;
+
+  v8::Isolate* isolate = request->isolate;
+  v8::HandleScope handle_scope(isolate);
+  v8::Local<v8::Context> context =
+      v8::Local<v8::Context>::New(isolate, request->context);
+  v8::Context::Scope context_scope(context);
+  v8::MicrotasksScope script_scope(isolate,
+                                   v8::MicrotasksScope::kRunMicrotasks);
+  v8::Local<v8::Promise::Resolver> resolver =
+      v8::Local<v8::Promise::Resolver>::New(isolate, request->resolver);
+  RejectWithError(isolate, context, resolver,
+                  "Timed out waiting for a reply on '" + request->channel +
+                  "'");
+}
+
+std::unique_ptr<InvokeManager::Request> InvokeManager::CancelRequest(
+    int request_id) {
+  auto it = requests_.find(request_id);
+  if (it == requests_.end())
+    return nullptr;
+  std::unique_ptr<Request> request = std::move(it->second);
+  requests_.erase(it);
+
+  content::RenderThread::Get()->Send(new AtomViewHostMsg_InvokeCancel(
+      request->routing_id, request_id));
+  return request;
+}
+
+}  // namespace atom
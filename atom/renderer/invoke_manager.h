@@ -0,0 +1,73 @@
+// Copyright (c) 2016 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_RENDERER_INVOKE_MANAGER_H_
+#define ATOM_RENDERER_INVOKE_MANAGER_H_
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "base/lazy_instance.h"
+#include "base/strings/string16.h"
+#include "base/time/time.h"
+#include "v8/include/v8.h"
+
+namespace atom {
+
+struct SerializedV8Value;
+
+// Keeps the ipcRenderer.invoke requests that wait for a reply from the
+// browser, and settles their promises.
+class InvokeManager {
+ public:
+  static InvokeManager* GetInstance();
+
+  // Sends |args| to the handler of |channel| in the browser. The promise is
+  // rejected when there is no reply within |timeout|, unless it is zero.
+  v8::Local<v8::Promise> Invoke(v8::Isolate* isolate,
+                                int routing_id,
+                                const base::string16& channel,
+                                const SerializedV8Value& args,
+                                base::TimeDelta timeout);
+
+  // Called when the browser replied to |request_id|, |result| is the error
+  // message when the handler failed.
+  void OnReply(int request_id, bool success, const SerializedV8Value& result);
+
+  // Drops the requests made in |context| when it is released, the browser is
+  // told that their replies are no longer needed.
+  void CancelRequests(v8::Local<v8::Context> context);
+
+ private:
+  friend struct base::DefaultLazyInstanceTraits<InvokeManager>;
+
+  struct Request {
+    Request();
+    ~Request();
+
+    int routing_id;
+    std::string channel;
+    v8::Isolate* isolate;
+    v8::Global<v8::Context> context;
+    v8::Global<v8::Promise::Resolver> resolver;
+  };
+
+  InvokeManager();
+  ~InvokeManager();
+
+  void OnTimeout(int request_id);
+
+  // Removes |request_id| and sends the cancellation to the browser.
+  std::unique_ptr<Request> CancelRequest(int request_id);
+
+  int next_request_id_;
+  std::map<int, std::unique_ptr<Request>> requests_;
+
+  DISALLOW_COPY_AND_ASSIGN(InvokeManager);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_RENDERER_INVOKE_MANAGER_H_
@@ -5,6 +5,8 @@
 #include "atom/renderer/preferences_manager.h"
 
 #include "atom/common/api/api_messages.h"
+#include "atom/common/atom_command_line.h"
+#include "base/command_line.h"
 #include "content/public/renderer/render_thread.h"
 
 namespace atom {
@@ -21,6 +23,7 @@ bool PreferencesManager::OnControlMessageReceived(
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(PreferencesManager, message)
     IPC_MESSAGE_HANDLER(AtomMsg_UpdatePreferences, OnUpdatePreferences)
+    IPC_MESSAGE_HANDLER(AtomMsg_AppendSwitches, OnAppendSwitches)
     IPC_MESSAGE_UNHANDLED(handled = false)
   IPC_END_MESSAGE_MAP()
   return handled;
@@ -31,4 +34,14 @@ void PreferencesManager::OnUpdatePreferences(
   preferences_ = preferences.CreateDeepCopy();
 }
 
+void PreferencesManager::OnAppendSwitches(const base::StringPairs& switches) {
+  // Node reads the switches when the page creates its environment, which is
+  // after the process has been taken.
+  base::CommandLine* command_line = base::CommandLine::ForCurrentProcess();
+  for (const auto& it : switches) {
+    command_line->AppendSwitchASCII(it.first, it.second);
+    AtomCommandLine::AppendSwitch(it.first, it.second);
+  }
+}
+
 }  // namespace atom
@@ -7,6 +7,7 @@
 
 #include <memory>
 
+#include "base/strings/string_split.h"
 #include "base/values.h"
 #include "content/public/renderer/render_thread_observer.h"
 
@@ -24,6 +25,7 @@ class PreferencesManager : public content::RenderThreadObserver {
   bool OnControlMessageReceived(const IPC::Message& message) override;
 
   void OnUpdatePreferences(const base::ListValue& preferences);
+  void OnAppendSwitches(const base::StringPairs& switches);
 
   std::unique_ptr<base::ListValue> preferences_;
 
@@ -1,6 +1,36 @@
 const EventEmitter = require('events').EventEmitter
+const v8Util = process.atomBinding('v8_util')
 
 module.exports = new EventEmitter()
 
+module.exports.setSharedMemoryThreshold = function (size) {
+  v8Util.setSharedMemoryThreshold(size)
+}
+
+module.exports.getSharedMemoryThreshold = function () {
+  return v8Util.getSharedMemoryThreshold()
+}
+
+// The handlers of ipcRenderer.invoke requests, keyed by channel.
+const invokeHandlers = new Map()
+
+module.exports.handle = function (channel, handler) {
+  if (typeof handler !== 'function') {
+    throw new TypeError('Handler has to be a function')
+  }
+  if (invokeHandlers.has(channel)) {
+    throw new Error(`A handler is already registered for '${channel}'`)
+  }
+  invokeHandlers.set(channel, handler)
+}
+
+module.exports.removeHandler = function (channel) {
+  invokeHandlers.delete(channel)
+}
+
+module.exports._getHandler = function (channel) {
+  return invokeHandlers.get(channel)
+}
+
 // Do not throw exception when channel name is "error".
 module.exports.on('error', () => {})
@@ -109,6 +109,20 @@ const wrapWebContents = function (webContents) {
   webContents.send = sendWrapper.bind(null, false)
   webContents.sendToAll = sendWrapper.bind(null, true)
 
+  // WebContents::sendStructured(channel, args..)
+  webContents.sendStructured = function (channel, ...args) {
+    if (channel == null) {
+      throw new Error('Missing required channel argument')
+    }
+    return webContents._sendStructured(false, channel, args)
+  }
+
+  // The objects of the main process referenced by the renderer through the
+  // remote module.
+  webContents.getRemoteObjectStats = function () {
+    return require('../objects-registry').getStats(this.getId())
+  }
+
   // The navigation controller.
   const controller = new NavigationController(webContents)
   for (const name in NavigationController.prototype) {
@@ -165,6 +179,43 @@ const wrapWebContents = function (webContents) {
     ipcMain.emit(channel, event, ...args)
   })
 
+  // Run the handlers of ipcRenderer.invoke requests.
+  const pendingInvokes = new Map()
+  webContents.on('-ipc-invoke', function (event, requestId, channel, args) {
+    const handler = ipcMain._getHandler(channel)
+    if (!handler) {
+      webContents._replyInvoke(requestId, false, `No handler registered for '${channel}'`)
+      return
+    }
+
+    // The page can be closed while the handler is running.
+    const reply = (success, result) => {
+      if (!event.cancelled && !webContents.isDestroyed()) {
+        webContents._replyInvoke(requestId, success, result)
+      }
+    }
+
+    event.cancelled = false
+    pendingInvokes.set(requestId, event)
+    new Promise((resolve) => {
+      resolve(handler(event, ...args))
+    }).then((result) => {
+      reply(true, result)
+    }, (error) => {
+      reply(false, error instanceof Error ? error.message : String(error))
+    }).then(() => {
+      pendingInvokes.delete(requestId)
+    })
+  })
+  // The renderer timed out or navigated away.
+  webContents.on('-ipc-invoke-cancel', function (event, requestId) {
+    const invokeEvent = pendingInvokes.get(requestId)
+    if (invokeEvent) {
+      invokeEvent.cancelled = true
+      pendingInvokes.delete(requestId)
+    }
+  })
+
   // Handle context menu action request from pepper plugin.
   webContents.on('pepper-context-menu', function (event, params) {
     const menu = Menu.buildFromTemplate(params.menu)
@@ -260,5 +311,12 @@ module.exports = {
 
   getAllWebContents () {
     return binding.getAllWebContents()
+  },
+
+  broadcast (targets, channel, ...args) {
+    if (channel == null) {
+      throw new Error('Missing required channel argument')
+    }
+    return binding._broadcast(targets, channel, args)
   }
 }
@@ -4,93 +4,76 @@ const v8Util = process.atomBinding('v8_util')
 
 class ObjectsRegistry {
   constructor () {
-    this.nextId = 0
+    // Stores the objects referenced by renderers, by the WebContents and the
+    // script context that referenced them.
+    this.registry = v8Util.createRemoteObjectRegistry()
 
-    // Stores all objects by ref-counting.
-    // (id) => {object, count}
-    this.storage = {}
+    // The IDs of WebContents that referenced objects.
+    this.owners = new Set()
 
-    // Stores the IDs of objects referenced by WebContents.
-    // (webContentsId) => [id]
-    this.owners = {}
+    // Counters of the batched releases received from each WebContents.
+    // (webContentsId) => {batches, released, largestBatch}
+    this.releases = {}
   }
 
   // Register a new object and return its assigned ID. If the object is already
   // registered then the already assigned ID would be returned.
-  add (webContents, obj) {
-    // Get or assign an ID to the object.
-    let id = this.saveToStorage(obj)
-
-    // Add object to the set of referenced objects.
+  add (webContents, contextId, obj) {
     let webContentsId = webContents.getId()
-    let owner = this.owners[webContentsId]
-    if (!owner) {
-      owner = this.owners[webContentsId] = new Set()
+    if (!this.owners.has(webContentsId)) {
+      this.owners.add(webContentsId)
       // Clear the storage when webContents is reloaded/navigated.
       webContents.once('render-view-deleted', (event, id) => {
         this.clear(id)
       })
     }
-    if (!owner.has(id)) {
-      owner.add(id)
-      // Increase reference count if not referenced before.
-      this.storage[id].count++
-    }
-    return id
+    return this.registry.add(webContentsId, contextId, obj)
   }
 
   // Get an object according to its ID.
   get (id) {
-    return this.storage[id].object
+    let object = this.registry.get(id)
+    if (object === undefined) {
+      throw new Error(`Cannot find the remote object with ID ${id}`)
+    }
+    return object
   }
 
-  // Dereference an object according to its ID.
-  remove (webContentsId, id) {
-    // Dereference from the storage.
-    this.dereference(id)
+  // Dereference the objects released by a context at once.
+  remove (webContentsId, contextId, ids) {
+    this.registry.remove(webContentsId, contextId, ids)
 
-    // Also remove the reference in owner.
-    let owner = this.owners[webContentsId]
-    if (owner) {
-      owner.delete(id)
+    let releases = this.releases[webContentsId]
+    if (!releases) {
+      releases = this.releases[webContentsId] = {batches: 0, released: 0, largestBatch: 0}
     }
+    releases.batches++
+    releases.released += ids.length
+    releases.largestBatch = Math.max(releases.largestBatch, ids.length)
   }
 
-  // Clear all references to objects refrenced by the WebContents.
-  clear (webContentsId) {
-    let owner = this.owners[webContentsId]
-    if (!owner) return
-
-    for (let id of owner) this.dereference(id)
-
-    delete this.owners[webContentsId]
+  // Clear all references to objects referenced by a context of the
+  // WebContents, which is released.
+  clearContext (webContentsId, contextId) {
+    this.registry.clearContext(webContentsId, contextId)
   }
 
-  // Private: Saves the object into storage and assigns an ID for it.
-  saveToStorage (object) {
-    let id = v8Util.getHiddenValue(object, 'atomId')
-    if (!id) {
-      id = ++this.nextId
-      this.storage[id] = {
-        count: 0,
-        object: object
-      }
-      v8Util.setHiddenValue(object, 'atomId', id)
-    }
-    return id
+  // Clear all references to objects refrenced by the WebContents.
+  clear (webContentsId) {
+    if (!this.owners.has(webContentsId)) return
+    this.registry.clearWebContents(webContentsId)
+    this.owners.delete(webContentsId)
+    delete this.releases[webContentsId]
   }
 
-  // Private: Dereference the object from store.
-  dereference (id) {
-    let pointer = this.storage[id]
-    if (pointer == null) {
-      return
-    }
-    pointer.count -= 1
-    if (pointer.count === 0) {
-      v8Util.deleteHiddenValue(pointer.object, 'atomId')
-      return delete this.storage[id]
-    }
+  // Return the number and estimated size of the objects referenced by the
+  // WebContents, with the contexts that referenced them, the most common
+  // constructors and the counters of released objects.
+  getStats (webContentsId) {
+    const stats = this.registry.getStats(webContentsId)
+    stats.releases = Object.assign({batches: 0, released: 0, largestBatch: 0},
+                                   this.releases[webContentsId])
+    return stats
   }
 }
 
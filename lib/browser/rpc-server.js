@@ -41,18 +41,117 @@ let getObjectMembers = function (object) {
   })
 }
 
+// The descriptions of class prototypes, which are cached by renderers and
+// only sent again when their version changes.
+// (proto) => {id, version, signature, members, turn}
+const prototypeMetas = new WeakMap()
+let nextPrototypeId = 0
+
+// Prototypes are walked at most once in a turn of the event loop, so the
+// objects of one class returned by a remote call share one walk.
+let prototypeTurn = 0
+let prototypeTurnScheduled = false
+const getPrototypeTurn = function () {
+  if (!prototypeTurnScheduled) {
+    prototypeTurnScheduled = true
+    process.nextTick(() => {
+      prototypeTurnScheduled = false
+      prototypeTurn++
+    })
+  }
+  return prototypeTurn
+}
+
+// The prototypes each WebContents has received, with their versions.
+// (webContentsId) => Map(id => {version, proto})
+const sentPrototypes = {}
+
+// Only the prototypes of classes live long enough to be worth caching.
+const isClassPrototype = function (proto) {
+  return hasProp.call(proto, 'constructor') &&
+         typeof proto.constructor === 'function' &&
+         proto.constructor.prototype === proto
+}
+
+// Return the cached description of a class prototype, its version changes
+// when the prototype or its parent gets or loses members.
+// A member that changes between a method and a property also changes it.
+// Changes made during a turn are seen in the next one.
+const getPrototypeMeta = function (proto) {
+  const turn = getPrototypeTurn()
+  let meta = prototypeMetas.get(proto)
+  if (meta && meta.turn === turn) return meta
+
+  const parent = Object.getPrototypeOf(proto)
+  const members = getObjectMembers(proto)
+  let signature = members.map((member) => {
+    return `${member.name}:${member.type}:${member.writable}:${member.enumerable}`
+  }).join(',')
+  if (parent !== null && parent !== Object.prototype && isClassPrototype(parent)) {
+    const parentMeta = getPrototypeMeta(parent)
+    signature += `|${parentMeta.id}:${parentMeta.version}`
+  }
+
+  if (!meta) {
+    meta = {id: ++nextPrototypeId, version: 0}
+    prototypeMetas.set(proto, meta)
+  }
+  meta.turn = turn
+  if (meta.signature !== signature) {
+    meta.signature = signature
+    meta.version++
+    meta.members = members
+  }
+  return meta
+}
+
+const getSentPrototypes = function (sender) {
+  const webContentsId = sender.getId()
+  let sent = sentPrototypes[webContentsId]
+  if (!sent) {
+    sent = sentPrototypes[webContentsId] = new Map()
+    // A new page starts with an empty cache.
+    const clear = () => sent.clear()
+    sender.on('did-navigate', clear)
+    sender.once('render-view-deleted', () => {
+      sender.removeListener('did-navigate', clear)
+      delete sentPrototypes[webContentsId]
+    })
+  }
+  return sent
+}
+
+// Return the description of a class prototype and its chain, leaving out
+// the members the renderer already has.
+const prototypeToMeta = function (sender, proto, full = false) {
+  const meta = getPrototypeMeta(proto)
+  const sent = getSentPrototypes(sender)
+  const entry = sent.get(meta.id)
+  if (!full && entry && entry.version === meta.version) {
+    return {id: meta.id, version: meta.version}
+  }
+  sent.set(meta.id, {version: meta.version, proto})
+  return {
+    id: meta.id,
+    version: meta.version,
+    members: meta.members,
+    proto: getObjectPrototype(sender, proto)
+  }
+}
+
 // Return the description of object's prototype.
-let getObjectPrototype = function (object) {
+let getObjectPrototype = function (sender, object) {
   let proto = Object.getPrototypeOf(object)
   if (proto === null || proto === Object.prototype) return null
+  if (isClassPrototype(proto)) return prototypeToMeta(sender, proto)
   return {
     members: getObjectMembers(proto),
-    proto: getObjectPrototype(proto)
+    proto: getObjectPrototype(sender, proto)
   }
 }
 
 // Convert a real value into meta data.
-let valueToMeta = function (sender, value, optimizeSimpleObject = false) {
+let valueToMeta = function (sender, contextId, value, optimizeSimpleObject = false) {
   // Determine the type of value.
   const meta = { type: typeof value }
   if (meta.type === 'object') {
@@ -61,6 +160,9 @@ let valueToMeta = function (sender, value, optimizeSimpleObject = false) {
       meta.type = 'value'
     } else if (Buffer.isBuffer(value)) {
       meta.type = 'buffer'
+    } else if (Array.isArray(value) && v8Util.isPlainValue(value)) {
+      // Arrays of primitives are sent by value instead of member by member.
+      meta.type = 'value'
     } else if (Array.isArray(value)) {
       meta.type = 'array'
     } else if (value instanceof Error) {
@@ -80,16 +182,16 @@ let valueToMeta = function (sender, value, optimizeSimpleObject = false) {
 
   // Fill the meta object according to value's type.
   if (meta.type === 'array') {
-    meta.members = value.map((el) => valueToMeta(sender, el))
+    meta.members = value.map((el) => valueToMeta(sender, contextId, el))
   } else if (meta.type === 'object' || meta.type === 'function') {
     meta.name = value.constructor ? value.constructor.name : ''
 
     // Reference the original value if it's an object, because when it's
     // passed to renderer we would assume the renderer keeps a reference of
     // it.
-    meta.id = objectsRegistry.add(sender, value)
+    meta.id = objectsRegistry.add(sender, contextId, value)
     meta.members = getObjectMembers(value)
-    meta.proto = getObjectPrototype(value)
+    meta.proto = getObjectPrototype(sender, value)
   } else if (meta.type === 'buffer') {
     meta.value = Array.prototype.slice.call(value, 0)
   } else if (meta.type === 'promise') {
@@ -97,7 +199,7 @@ let valueToMeta = function (sender, value, optimizeSimpleObject = false) {
     // Instead they should appear in the renderer process
     value.then(function () {}, function () {})
 
-    meta.then = valueToMeta(sender, function (onFulfilled, onRejected) {
+    meta.then = valueToMeta(sender, contextId, function (onFulfilled, onRejected) {
       value.then(onFulfilled, onRejected)
     })
   } else if (meta.type === 'error') {
@@ -137,7 +239,7 @@ const exceptionToMeta = function (error) {
 }
 
 // Convert array of meta data from renderer into array of real values.
-const unwrapArgs = function (sender, args) {
+const unwrapArgs = function (sender, contextId, args) {
   const metaToValue = function (meta) {
     let i, len, member, ref, returnValue
     switch (meta.type) {
@@ -146,7 +248,7 @@ const unwrapArgs = function (sender, args) {
       case 'remote-object':
         return objectsRegistry.get(meta.id)
       case 'array':
-        return unwrapArgs(sender, meta.value)
+        return unwrapArgs(sender, contextId, meta.value)
       case 'buffer':
         return new Buffer(meta.value)
       case 'date':
@@ -184,7 +286,7 @@ const unwrapArgs = function (sender, args) {
 
         let callIntoRenderer = function (...args) {
           if (!sender.isDestroyed() && webContentsId === sender.getId()) {
-            sender.send('ELECTRON_RENDERER_CALLBACK', meta.id, valueToMeta(sender, args))
+            sender.send('ELECTRON_RENDERER_CALLBACK', meta.id, valueToMeta(sender, contextId, args))
           } else {
             throw new Error(`Attempting to call a function in a renderer window that has been closed or released. Function provided here: ${meta.location}.`)
           }
@@ -203,19 +305,19 @@ const unwrapArgs = function (sender, args) {
 
 // Call a function and send reply asynchronously if it's a an asynchronous
 // style function and the caller didn't pass a callback.
-const callFunction = function (event, func, caller, args) {
+const callFunction = function (event, contextId, func, caller, args) {
   let funcMarkedAsync, funcName, funcPassedCallback, ref, ret
   funcMarkedAsync = v8Util.getHiddenValue(func, 'asynchronous')
   funcPassedCallback = typeof args[args.length - 1] === 'function'
   try {
     if (funcMarkedAsync && !funcPassedCallback) {
       args.push(function (ret) {
-        event.returnValue = valueToMeta(event.sender, ret, true)
+        event.returnValue = valueToMeta(event.sender, contextId, ret, true)
       })
       func.apply(caller, args)
     } else {
       ret = func.apply(caller, args)
-      event.returnValue = valueToMeta(event.sender, ret, true)
+      event.returnValue = valueToMeta(event.sender, contextId, ret, true)
     }
   } catch (error) {
     // Catch functions thrown further down in function invocation and wrap
@@ -226,90 +328,90 @@ const callFunction = function (event, func, caller, args) {
   }
 }
 
-ipcMain.on('ELECTRON_BROWSER_REQUIRE', function (event, module) {
+ipcMain.on('ELECTRON_BROWSER_REQUIRE', function (event, contextId, module) {
   try {
-    event.returnValue = valueToMeta(event.sender, process.mainModule.require(module))
+    event.returnValue = valueToMeta(event.sender, contextId, process.mainModule.require(module))
   } catch (error) {
     event.returnValue = exceptionToMeta(error)
   }
 })
 
-ipcMain.on('ELECTRON_BROWSER_GET_BUILTIN', function (event, module) {
+ipcMain.on('ELECTRON_BROWSER_GET_BUILTIN', function (event, contextId, module) {
   try {
-    event.returnValue = valueToMeta(event.sender, electron[module])
+    event.returnValue = valueToMeta(event.sender, contextId, electron[module])
   } catch (error) {
     event.returnValue = exceptionToMeta(error)
   }
 })
 
-ipcMain.on('ELECTRON_BROWSER_GLOBAL', function (event, name) {
+ipcMain.on('ELECTRON_BROWSER_GLOBAL', function (event, contextId, name) {
   try {
-    event.returnValue = valueToMeta(event.sender, global[name])
+    event.returnValue = valueToMeta(event.sender, contextId, global[name])
   } catch (error) {
     event.returnValue = exceptionToMeta(error)
   }
 })
 
-ipcMain.on('ELECTRON_BROWSER_CURRENT_WINDOW', function (event) {
+ipcMain.on('ELECTRON_BROWSER_CURRENT_WINDOW', function (event, contextId) {
   try {
-    event.returnValue = valueToMeta(event.sender, event.sender.getOwnerBrowserWindow())
+    event.returnValue = valueToMeta(event.sender, contextId, event.sender.getOwnerBrowserWindow())
   } catch (error) {
     event.returnValue = exceptionToMeta(error)
   }
 })
 
-ipcMain.on('ELECTRON_BROWSER_CURRENT_WEB_CONTENTS', function (event) {
-  event.returnValue = valueToMeta(event.sender, event.sender)
+ipcMain.on('ELECTRON_BROWSER_CURRENT_WEB_CONTENTS', function (event, contextId) {
+  event.returnValue = valueToMeta(event.sender, contextId, event.sender)
 })
 
-ipcMain.on('ELECTRON_BROWSER_CONSTRUCTOR', function (event, id, args) {
+ipcMain.on('ELECTRON_BROWSER_CONSTRUCTOR', function (event, contextId, id, args) {
   try {
-    args = unwrapArgs(event.sender, args)
+    args = unwrapArgs(event.sender, contextId, args)
     let constructor = objectsRegistry.get(id)
 
     // Call new with array of arguments.
     // http://stackoverflow.com/questions/1606797/use-of-apply-with-new-operator-is-this-possible
     let obj = new (Function.prototype.bind.apply(constructor, [null].concat(args)))
-    event.returnValue = valueToMeta(event.sender, obj)
+    event.returnValue = valueToMeta(event.sender, contextId, obj)
   } catch (error) {
     event.returnValue = exceptionToMeta(error)
   }
 })
 
-ipcMain.on('ELECTRON_BROWSER_FUNCTION_CALL', function (event, id, args) {
+ipcMain.on('ELECTRON_BROWSER_FUNCTION_CALL', function (event, contextId, id, args) {
   try {
-    args = unwrapArgs(event.sender, args)
+    args = unwrapArgs(event.sender, contextId, args)
     let func = objectsRegistry.get(id)
-    callFunction(event, func, global, args)
+    callFunction(event, contextId, func, global, args)
   } catch (error) {
     event.returnValue = exceptionToMeta(error)
   }
 })
 
-ipcMain.on('ELECTRON_BROWSER_MEMBER_CONSTRUCTOR', function (event, id, method, args) {
+ipcMain.on('ELECTRON_BROWSER_MEMBER_CONSTRUCTOR', function (event, contextId, id, method, args) {
   try {
-    args = unwrapArgs(event.sender, args)
+    args = unwrapArgs(event.sender, contextId, args)
     let constructor = objectsRegistry.get(id)[method]
 
     // Call new with array of arguments.
     let obj = new (Function.prototype.bind.apply(constructor, [null].concat(args)))
-    event.returnValue = valueToMeta(event.sender, obj)
+    event.returnValue = valueToMeta(event.sender, contextId, obj)
   } catch (error) {
     event.returnValue = exceptionToMeta(error)
   }
 })
 
-ipcMain.on('ELECTRON_BROWSER_MEMBER_CALL', function (event, id, method, args) {
+ipcMain.on('ELECTRON_BROWSER_MEMBER_CALL', function (event, contextId, id, method, args) {
   try {
-    args = unwrapArgs(event.sender, args)
+    args = unwrapArgs(event.sender, contextId, args)
     let obj = objectsRegistry.get(id)
-    callFunction(event, obj[method], obj, args)
+    callFunction(event, contextId, obj[method], obj, args)
   } catch (error) {
     event.returnValue = exceptionToMeta(error)
   }
 })
 
-ipcMain.on('ELECTRON_BROWSER_MEMBER_SET', function (event, id, name, value) {
+ipcMain.on('ELECTRON_BROWSER_MEMBER_SET', function (event, contextId, id, name, value) {
   try {
     let obj = objectsRegistry.get(id)
     obj[name] = value
@@ -319,23 +421,54 @@ ipcMain.on('ELECTRON_BROWSER_MEMBER_SET', function (event, id, name, value) {
   }
 })
 
-ipcMain.on('ELECTRON_BROWSER_MEMBER_GET', function (event, id, name) {
+ipcMain.on('ELECTRON_BROWSER_MEMBER_GET', function (event, contextId, id, name) {
   try {
     let obj = objectsRegistry.get(id)
-    event.returnValue = valueToMeta(event.sender, obj[name])
+    event.returnValue = valueToMeta(event.sender, contextId, obj[name])
   } catch (error) {
     event.returnValue = exceptionToMeta(error)
   }
 })
 
-ipcMain.on('ELECTRON_BROWSER_DEREFERENCE', function (event, id) {
-  objectsRegistry.remove(event.sender.getId(), id)
+// Called when the renderer lost its cache of a prototype, e.g. after reload.
+// Only prototypes that were sent to this WebContents can be asked for.
+ipcMain.on('ELECTRON_BROWSER_PROTOTYPE', function (event, contextId, id) {
+  try {
+    const sent = sentPrototypes[event.sender.getId()]
+    const entry = sent && sent.get(id)
+    if (!entry) throw new Error(`Unknown prototype ${id}`)
+    event.returnValue = prototypeToMeta(event.sender, entry.proto, true)
+  } catch (error) {
+    event.returnValue = exceptionToMeta(error)
+  }
+})
+
+// Calls from the renderer that do not need a result, sent together. Only
+// setting members is batched by the renderer.
+ipcMain.on('ELECTRON_BROWSER_BATCH', function (event, calls) {
+  if (!Array.isArray(calls)) return
+  for (const call of calls) {
+    if (!Array.isArray(call) || call[0] !== 'ELECTRON_BROWSER_MEMBER_SET') continue
+    ipcMain.emit(call[0], {sender: event.sender}, ...call.slice(1))
+  }
+})
+
+// The renderer released objects, which are sent in batches.
+ipcMain.on('ELECTRON_BROWSER_DEREFERENCE', function (event, contextId, ids) {
+  objectsRegistry.remove(event.sender.getId(), contextId, ids)
+})
+
+ipcMain.on('ELECTRON_BROWSER_CONTEXT_RELEASE', function (event, contextId) {
+  objectsRegistry.clearContext(event.sender.getId(), contextId)
+  // The prototypes cached by the released context are gone with it.
+  const sent = sentPrototypes[event.sender.getId()]
+  if (sent) sent.clear()
 })
 
-ipcMain.on('ELECTRON_BROWSER_GUEST_WEB_CONTENTS', function (event, guestInstanceId) {
+ipcMain.on('ELECTRON_BROWSER_GUEST_WEB_CONTENTS', function (event, contextId, guestInstanceId) {
   try {
     let guestViewManager = require('./guest-view-manager')
-    event.returnValue = valueToMeta(event.sender, guestViewManager.getGuest(guestInstanceId))
+    event.returnValue = valueToMeta(event.sender, contextId, guestViewManager.getGuest(guestInstanceId))
   } catch (error) {
     event.returnValue = exceptionToMeta(error)
   }
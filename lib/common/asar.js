@@ -3,36 +3,14 @@
   const childProcess = require('child_process')
   const path = require('path')
   const util = require('util')
+  const zlib = require('zlib')
 
-  var hasProp = {}.hasOwnProperty
-
-  // Cache asar archive objects.
-  var cachedArchives = {}
-
+  // The archives are cached natively, keeping them here would stop the cache
+  // from closing the least recently used ones.
   var getOrCreateArchive = function (p) {
-    var archive
-    archive = cachedArchives[p]
-    if (archive != null) {
-      return archive
-    }
-    archive = asar.createArchive(p)
-    if (!archive) {
-      return false
-    }
-    cachedArchives[p] = archive
-    return archive
+    return asar.createArchive(p)
   }
 
-  // Clean cache on quit.
-  process.on('exit', function () {
-    var archive, p
-    for (p in cachedArchives) {
-      if (!hasProp.call(cachedArchives, p)) continue
-      archive = cachedArchives[p]
-      archive.destroy()
-    }
-  })
-
   // Separate asar package's path from full path.
   var splitPath = function (p) {
     var index
@@ -202,6 +180,17 @@
 
   // Override fs APIs.
   exports.wrapFsWithAsar = function (fs) {
+    // Reads from the fd of |archive|, which is referenced until the read is
+    // done so the cache can not close the fd meanwhile.
+    const readingArchives = new Set()
+    const readArchive = function (archive, buffer, length, offset, callback) {
+      readingArchives.add(archive)
+      fs.read(archive.getFd(), buffer, 0, length, offset, function (error) {
+        readingArchives.delete(archive)
+        callback(error)
+      })
+    }
+
     var exists, existsSync, internalModuleReadFile, internalModuleStat, lstat, lstatSync, mkdir, mkdirSync, readFile, readFileSync, readdir, readdirSync, realpath, realpathSync, stat, statSync, statSyncNoException, logFDs, logASARAccess
 
     logFDs = {}
@@ -368,7 +357,7 @@
     }
     readFile = fs.readFile
     fs.readFile = function (p, options, callback) {
-      var archive, buffer, encoding, fd, info, realPath
+      var archive, buffer, encoding, info, realPath
       const [isAsar, asarPath, filePath] = splitPath(p)
       if (!isAsar) {
         return readFile.apply(this, arguments)
@@ -406,20 +395,32 @@
         throw new TypeError('Bad arguments')
       }
       encoding = options.encoding
-      buffer = new Buffer(info.size)
-      fd = archive.getFd()
-      if (!(fd >= 0)) {
+      if (!(archive.getFd() >= 0)) {
         return notFoundError(asarPath, filePath, callback)
       }
       logASARAccess(asarPath, filePath, info.offset)
-      return fs.read(fd, buffer, 0, info.size, info.offset, function (error) {
+      if (info.compressed) {
+        // The stored gzip stream is inflated on the thread pool.
+        buffer = new Buffer(info.compressedSize)
+        return readArchive(archive, buffer, info.compressedSize, info.offset, function (error) {
+          if (error) return callback(error)
+          zlib.gunzip(buffer, function (error, result) {
+            if (error || result.length !== info.size) {
+              return notFoundError(asarPath, filePath, callback)
+            }
+            callback(null, encoding ? result.toString(encoding) : result)
+          })
+        })
+      }
+      buffer = new Buffer(info.size)
+      return readArchive(archive, buffer, info.size, info.offset, function (error) {
         return callback(error, encoding ? buffer.toString(encoding) : buffer)
       })
     }
     readFileSync = fs.readFileSync
     fs.readFileSync = function (p, opts) {
       // this allows v8 to optimize this function
-      var archive, buffer, encoding, fd, info, options, realPath
+      var archive, buffer, encoding, info, options, realPath
       options = opts
       const [isAsar, asarPath, filePath] = splitPath(p)
       if (!isAsar) {
@@ -456,13 +457,11 @@
         throw new TypeError('Bad arguments')
       }
       encoding = options.encoding
-      buffer = new Buffer(info.size)
-      fd = archive.getFd()
-      if (!(fd >= 0)) {
+      logASARAccess(asarPath, filePath, info.offset)
+      buffer = archive.readFile(filePath)
+      if (!buffer) {
         notFoundError(asarPath, filePath)
       }
-      logASARAccess(asarPath, filePath, info.offset)
-      fs.readSync(fd, buffer, 0, info.size, info.offset)
       if (encoding) {
         return buffer.toString(encoding)
       } else {
@@ -507,7 +506,7 @@
     }
     internalModuleReadFile = process.binding('fs').internalModuleReadFile
     process.binding('fs').internalModuleReadFile = function (p) {
-      var archive, buffer, fd, info, realPath
+      var archive, info, realPath, source
       const [isAsar, asarPath, filePath] = splitPath(p)
       if (!isAsar) {
         return internalModuleReadFile(p)
@@ -529,14 +528,12 @@
           encoding: 'utf8'
         })
       }
-      buffer = new Buffer(info.size)
-      fd = archive.getFd()
-      if (!(fd >= 0)) {
+      logASARAccess(asarPath, filePath, info.offset)
+      source = archive.readFileString(filePath)
+      if (source === false) {
         return void 0
       }
-      logASARAccess(asarPath, filePath, info.offset)
-      fs.readSync(fd, buffer, 0, info.size, info.offset)
-      return buffer.toString('utf8')
+      return source
     }
     internalModuleStat = process.binding('fs').internalModuleStat
     process.binding('fs').internalModuleStat = function (p) {
@@ -6,15 +6,63 @@ const v8Util = process.atomBinding('v8_util')
 // Created by init.js.
 const ipcRenderer = v8Util.getHiddenValue(global, 'ipc')
 
+// Internal messages that need no reply are queued and sent together once the
+// current microtask ends. Sending anything else flushes them first, so the
+// browser still receives all messages in order.
+let batchedMessages = []
+
+const flushBatchedMessages = function () {
+  if (batchedMessages.length === 0) return
+  const messages = batchedMessages
+  batchedMessages = []
+  binding.send('ipc-message', ['ELECTRON_BROWSER_BATCH', messages])
+}
+
+ipcRenderer._sendBatched = function (...args) {
+  if (batchedMessages.length === 0) {
+    Promise.resolve().then(flushBatchedMessages)
+  }
+  batchedMessages.push(args)
+}
+
 ipcRenderer.send = function (...args) {
+  flushBatchedMessages()
   return binding.send('ipc-message', args)
 }
 
+ipcRenderer.sendStructured = function (...args) {
+  flushBatchedMessages()
+  return binding.sendStructured('ipc-message', args)
+}
+
+ipcRenderer.setSharedMemoryThreshold = function (size) {
+  v8Util.setSharedMemoryThreshold(size)
+}
+
+ipcRenderer.getSharedMemoryThreshold = function () {
+  return v8Util.getSharedMemoryThreshold()
+}
+
+ipcRenderer.invoke = function (channel, ...args) {
+  flushBatchedMessages()
+  return binding.invoke(channel, args, 0)
+}
+
+ipcRenderer.invokeWithTimeout = function (timeout, channel, ...args) {
+  if (typeof timeout !== 'number' || !isFinite(timeout) || timeout < 0) {
+    throw new TypeError('Timeout has to be a non-negative number')
+  }
+  flushBatchedMessages()
+  return binding.invoke(channel, args, timeout)
+}
+
 ipcRenderer.sendSync = function (...args) {
+  flushBatchedMessages()
   return JSON.parse(binding.sendSync('ipc-message-sync', args))
 }
 
 ipcRenderer.sendToHost = function (...args) {
+  flushBatchedMessages()
   return binding.send('ipc-message-host', args)
 }
 
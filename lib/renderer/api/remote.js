@@ -5,8 +5,17 @@ const {ipcRenderer, isPromise, CallbacksRegistry} = require('electron')
 
 const callbacksRegistry = new CallbacksRegistry()
 
+// Identifies this context to the browser, which keeps the objects referenced
+// by it until it is released.
+const contextId = v8Util.getHiddenValue(process, 'contextId')
+
 const remoteObjectCache = v8Util.createIDWeakMap()
 
+// The descriptions of class prototypes sent by the browser, which only sends
+// them again when they change.
+// (id) => {id, version, members, proto}
+const prototypeCache = new Map()
+
 // Convert the arguments object into an array of meta data.
 const wrapArgs = function (args, visited) {
   if (visited == null) {
@@ -102,11 +111,11 @@ const setObjectMembers = function (ref, object, metaId, members) {
       let remoteMemberFunction = function () {
         if (this && this.constructor === remoteMemberFunction) {
           // Constructor call.
-          let ret = ipcRenderer.sendSync('ELECTRON_BROWSER_MEMBER_CONSTRUCTOR', metaId, member.name, wrapArgs(arguments))
+          let ret = ipcRenderer.sendSync('ELECTRON_BROWSER_MEMBER_CONSTRUCTOR', contextId, metaId, member.name, wrapArgs(arguments))
           return metaToValue(ret)
         } else {
           // Call member function.
-          let ret = ipcRenderer.sendSync('ELECTRON_BROWSER_MEMBER_CALL', metaId, member.name, wrapArgs(arguments))
+          let ret = ipcRenderer.sendSync('ELECTRON_BROWSER_MEMBER_CALL', contextId, metaId, member.name, wrapArgs(arguments))
           return metaToValue(ret)
         }
       }
@@ -122,13 +131,14 @@ const setObjectMembers = function (ref, object, metaId, members) {
       descriptor.configurable = true
     } else if (member.type === 'get') {
       descriptor.get = function () {
-        return metaToValue(ipcRenderer.sendSync('ELECTRON_BROWSER_MEMBER_GET', metaId, member.name))
+        return metaToValue(ipcRenderer.sendSync('ELECTRON_BROWSER_MEMBER_GET', contextId, metaId, member.name))
       }
 
       // Only set setter when it is writable.
       if (member.writable) {
         descriptor.set = function (value) {
-          ipcRenderer.sendSync('ELECTRON_BROWSER_MEMBER_SET', metaId, member.name, value)
+          // The result is not needed, so the call is batched with others.
+          ipcRenderer._sendBatched('ELECTRON_BROWSER_MEMBER_SET', contextId, metaId, member.name, value)
           return value
         }
       }
@@ -138,9 +148,28 @@ const setObjectMembers = function (ref, object, metaId, members) {
   }
 }
 
+// Return the full description of a prototype that may have been sent only as
+// a reference to the cache.
+const resolvePrototype = function (descriptor) {
+  if (descriptor === null || descriptor.id == null) return descriptor
+  if (descriptor.members) {
+    prototypeCache.set(descriptor.id, descriptor)
+    return descriptor
+  }
+  const cached = prototypeCache.get(descriptor.id)
+  if (cached && cached.version === descriptor.version) return cached
+
+  // The cache does not match the browser's, e.g. after a reload.
+  const meta = ipcRenderer.sendSync('ELECTRON_BROWSER_PROTOTYPE', contextId, descriptor.id)
+  if (meta.type === 'exception') metaToValue(meta)
+  prototypeCache.set(meta.id, meta)
+  return meta
+}
+
 // Populate object's prototype from descriptor.
 // This matches |getObjectPrototype| in rpc-server.
 const setObjectPrototype = function (ref, object, metaId, descriptor) {
+  descriptor = resolvePrototype(descriptor)
   if (descriptor === null) return
   let proto = {}
   setObjectMembers(ref, proto, metaId, descriptor.members)
@@ -182,14 +211,14 @@ const metaToValue = function (meta) {
         let remoteFunction = function () {
           if (this && this.constructor === remoteFunction) {
             // Constructor call.
-            let obj = ipcRenderer.sendSync('ELECTRON_BROWSER_CONSTRUCTOR', meta.id, wrapArgs(arguments))
+            let obj = ipcRenderer.sendSync('ELECTRON_BROWSER_CONSTRUCTOR', contextId, meta.id, wrapArgs(arguments))
             // Returning object in constructor will replace constructed object
             // with the returned object.
             // http://stackoverflow.com/questions/1978049/what-values-can-a-constructor-return-to-avoid-returning-this
             return metaToValue(obj)
           } else {
             // Function call.
-            let obj = ipcRenderer.sendSync('ELECTRON_BROWSER_FUNCTION_CALL', meta.id, wrapArgs(arguments))
+            let obj = ipcRenderer.sendSync('ELECTRON_BROWSER_FUNCTION_CALL', contextId, meta.id, wrapArgs(arguments))
             return metaToValue(obj)
           }
         }
@@ -208,7 +237,7 @@ const metaToValue = function (meta) {
 
       // Track delegate object's life time, and tell the browser to clean up
       // when the object is GCed.
-      v8Util.setRemoteObjectFreer(ret, meta.id)
+      v8Util.setRemoteObjectFreer(ret, contextId, meta.id)
 
       // Remember object's id.
       v8Util.setHiddenValue(ret, 'atomId', meta.id)
@@ -236,14 +265,19 @@ const metaToPlainObject = function (meta) {
   return obj
 }
 
+// Release all the objects referenced by this context at once.
+process.on('exit', () => {
+  ipcRenderer.send('ELECTRON_BROWSER_CONTEXT_RELEASE', contextId)
+})
+
 // Browser calls a callback in renderer.
 ipcRenderer.on('ELECTRON_RENDERER_CALLBACK', function (event, id, args) {
   callbacksRegistry.apply(id, metaToValue(args))
 })
 
-// A callback in browser is released.
-ipcRenderer.on('ELECTRON_RENDERER_RELEASE_CALLBACK', function (event, id) {
-  callbacksRegistry.remove(id)
+// Callbacks in browser are released, which are sent in batches.
+ipcRenderer.on('ELECTRON_RENDERER_RELEASE_CALLBACK', function (event, ids) {
+  for (const id of ids) callbacksRegistry.remove(id)
 })
 
 // List all built-in modules in browser process.
@@ -260,27 +294,27 @@ for (let name of Object.getOwnPropertyNames(browserModules)) {
 
 // Get remote module.
 exports.require = function (module) {
-  return metaToValue(ipcRenderer.sendSync('ELECTRON_BROWSER_REQUIRE', module))
+  return metaToValue(ipcRenderer.sendSync('ELECTRON_BROWSER_REQUIRE', contextId, module))
 }
 
 // Alias to remote.require('electron').xxx.
 exports.getBuiltin = function (module) {
-  return metaToValue(ipcRenderer.sendSync('ELECTRON_BROWSER_GET_BUILTIN', module))
+  return metaToValue(ipcRenderer.sendSync('ELECTRON_BROWSER_GET_BUILTIN', contextId, module))
 }
 
 // Get current BrowserWindow.
 exports.getCurrentWindow = function () {
-  return metaToValue(ipcRenderer.sendSync('ELECTRON_BROWSER_CURRENT_WINDOW'))
+  return metaToValue(ipcRenderer.sendSync('ELECTRON_BROWSER_CURRENT_WINDOW', contextId))
 }
 
 // Get current WebContents object.
 exports.getCurrentWebContents = function () {
-  return metaToValue(ipcRenderer.sendSync('ELECTRON_BROWSER_CURRENT_WEB_CONTENTS'))
+  return metaToValue(ipcRenderer.sendSync('ELECTRON_BROWSER_CURRENT_WEB_CONTENTS', contextId))
 }
 
 // Get a global object in browser.
 exports.getGlobal = function (name) {
-  return metaToValue(ipcRenderer.sendSync('ELECTRON_BROWSER_GLOBAL', name))
+  return metaToValue(ipcRenderer.sendSync('ELECTRON_BROWSER_GLOBAL', contextId, name))
 }
 
 // Get the process object in browser.
@@ -299,6 +333,6 @@ exports.createFunctionWithReturnValue = function (returnValue) {
 
 // Get the guest WebContents from guestInstanceId.
 exports.getGuestWebContents = function (guestInstanceId) {
-  const meta = ipcRenderer.sendSync('ELECTRON_BROWSER_GUEST_WEB_CONTENTS', guestInstanceId)
+  const meta = ipcRenderer.sendSync('ELECTRON_BROWSER_GUEST_WEB_CONTENTS', contextId, guestInstanceId)
   return metaToValue(meta)
 }
@@ -274,6 +274,35 @@ describe('browser-window module', function () {
     })
   })
 
+  describe('BrowserWindow.capturePage(rect, options, callback)', function () {
+    it('calls the callback with an encoded Buffer', function (done) {
+      w.webContents.once('did-finish-load', function () {
+        w.capturePage({
+          x: 0,
+          y: 0,
+          width: 100,
+          height: 100
+        }, {
+          format: 'jpeg',
+          quality: 50
+        }, function (error, data) {
+          assert.equal(error, null)
+          assert(Buffer.isBuffer(data))
+          assert.equal(data[0], 0xFF)
+          assert.equal(data[1], 0xD8)
+          done()
+        })
+      })
+      w.loadURL('file://' + fixtures + '/api/frame-subscriber.html')
+    })
+
+    it('throws error when the format is not supported', function () {
+      assert.throws(function () {
+        w.capturePage({format: 'gif'}, function () {})
+      }, /Unsupported image format: gif/)
+    })
+  })
+
   describe('BrowserWindow.setSize(width, height)', function () {
     it('sets the window size', function (done) {
       var size = [300, 400]
@@ -658,6 +687,54 @@ describe('browser-window module', function () {
       })
     })
 
+    it('subscribes to scaled I420 frames', function (done) {
+      let called = false
+      w.loadURL('file://' + fixtures + '/api/frame-subscriber.html')
+      w.webContents.on('dom-ready', function () {
+        const options = {
+          format: 'i420',
+          maxSize: {width: 100, height: 100},
+          reuseBuffer: true
+        }
+        w.webContents.beginFrameSubscription(options, function (data, dirtyRect, info) {
+          // This callback might be called twice.
+          if (called) return
+          called = true
+
+          assert.equal(info.format, 'i420')
+          assert(info.width <= 100 && info.height <= 100)
+          assert.equal(typeof info.timestamp, 'number')
+          const chromaSize = Math.ceil(info.width / 2) * Math.ceil(info.height / 2)
+          assert.equal(data.length, info.width * info.height + 2 * chromaSize)
+          w.webContents.endFrameSubscription()
+          done()
+        })
+      })
+    })
+
+    it('subscribes to encoded frames', function (done) {
+      let called = false
+      w.loadURL('file://' + fixtures + '/api/frame-subscriber.html')
+      w.webContents.on('dom-ready', function () {
+        w.webContents.beginFrameSubscription({format: 'png'}, function (data, dirtyRect, info) {
+          // This callback might be called twice.
+          if (called) return
+          called = true
+
+          assert.equal(info.format, 'png')
+          assert.equal(data.toString('ascii', 1, 4), 'PNG')
+          w.webContents.endFrameSubscription()
+          done()
+        })
+      })
+    })
+
+    it('throws error when the pixel format is not supported', function () {
+      assert.throws(function () {
+        w.webContents.beginFrameSubscription({format: 'rgb'}, function () {})
+      }, /Unsupported pixel format: rgb/)
+    })
+
     it('throws error when subscriber is not well defined', function (done) {
       w.loadURL('file://' + fixtures + '/api/frame-subscriber.html')
       try {
@@ -118,6 +118,15 @@ describe('ipc module', function () {
       property.property = 1127
     })
 
+    it('sends property changes before other messages', function () {
+      var modulePath = path.join(fixtures, 'module', 'property.js')
+      var property = remote.require(modulePath)
+      property.property = 1007
+      var value = ipcRenderer.sendSync('eval', 'require(' + JSON.stringify(modulePath) + ').property')
+      assert.equal(value, 1007)
+      property.property = 1127
+    })
+
     it('can construct an object from its member', function () {
       var call = remote.require(path.join(fixtures, 'module', 'call.js'))
       var obj = new call.constructor()
@@ -253,6 +262,20 @@ describe('ipc module', function () {
       assert(Object.getPrototypeOf(proto).hasOwnProperty('method'))
     })
 
+    it('updates cached prototypes when they change', function () {
+      assert.equal(cl.create().method(), 'method')
+      assert.equal(cl.create().added, undefined)
+      cl.addMethod()
+      assert.equal(cl.create().added(), 'added')
+    })
+
+    it('updates cached prototypes when a member changes its type', function () {
+      cl.setChangedMember(true)
+      assert.equal(cl.create().changed(), 'method')
+      cl.setChangedMember(false)
+      assert.equal(cl.create().changed, 'property')
+    })
+
     it('is referenced by methods in prototype chain', function () {
       let method = derived.method
       derived = null
@@ -261,6 +284,57 @@ describe('ipc module', function () {
     })
   })
 
+  describe('remote object registry', function () {
+    var w = null
+
+    afterEach(function () {
+      if (w) w.destroy()
+      w = null
+    })
+
+    it('reports the objects referenced by the renderer', function () {
+      remote.getCurrentWindow()
+      var stats = remote.getCurrentWebContents().getRemoteObjectStats()
+      assert(stats.count > 0)
+      assert(stats.bytes > 0)
+      assert(stats.contexts.length > 0)
+      assert(stats.constructors.length > 0)
+    })
+
+    it('releases garbage collected objects in batches', function (done) {
+      var cl = remote.require(path.join(fixtures, 'module', 'class.js'))
+      var contents = remote.getCurrentWebContents()
+      var released = contents.getRemoteObjectStats().releases.released
+      for (var i = 0; i < 10; i++) cl.create()
+      global.gc()
+      setTimeout(function () {
+        var releases = contents.getRemoteObjectStats().releases
+        assert(releases.released >= released + 10)
+        assert(releases.largestBatch >= 10)
+        done()
+      }, 500)
+    })
+
+    it('releases the objects of a context when it is released', function (done) {
+      w = new BrowserWindow({
+        show: false
+      })
+      w.webContents.once('did-finish-load', function () {
+        var stats = w.webContents.getRemoteObjectStats()
+        assert.equal(stats.contexts.length, 1)
+        assert.equal(stats.contexts[0].generation, 1)
+        w.webContents.once('did-finish-load', function () {
+          stats = w.webContents.getRemoteObjectStats()
+          assert.equal(stats.contexts.length, 1)
+          assert.equal(stats.contexts[0].generation, 2)
+          done()
+        })
+        w.reload()
+      })
+      w.loadURL('file://' + path.join(fixtures, 'pages', 'remote-window.html'))
+    })
+  })
+
   describe('ipc.sender.send', function () {
     it('should work when sending an object containing id property', function (done) {
       var obj = {
@@ -284,6 +358,197 @@ describe('ipc module', function () {
     })
   })
 
+  describe('ipcRenderer.sendStructured', function () {
+    afterEach(function () {
+      ipcRenderer.removeAllListeners('structured-message')
+    })
+
+    it('keeps the types of binary data', function (done) {
+      const buffer = Buffer.from('hello world')
+      const floats = new Float32Array([1.5, -2.25, 3])
+      const arrayBuffer = new Uint8Array([1, 2, 3]).buffer
+      ipcRenderer.once('structured-message', function (event, value1, value2, value3) {
+        assert(Buffer.isBuffer(value1))
+        assert.equal(value1.toString(), 'hello world')
+        assert(value2 instanceof Float32Array)
+        assert.deepEqual(Array.from(value2), [1.5, -2.25, 3])
+        assert(value3 instanceof ArrayBuffer)
+        assert.deepEqual(Array.from(new Uint8Array(value3)), [1, 2, 3])
+        done()
+      })
+      ipcRenderer.sendStructured('structured-message', buffer, floats, arrayBuffer)
+    })
+
+    it('keeps Date, RegExp, Map and Set values', function (done) {
+      const date = new Date()
+      ipcRenderer.once('structured-message', function (event, value) {
+        assert(value.date instanceof Date)
+        assert.equal(value.date.getTime(), date.getTime())
+        assert(value.regexp instanceof RegExp)
+        assert.equal(value.regexp.source, 'a+b')
+        assert(value.regexp.global)
+        assert(value.map instanceof Map)
+        assert.equal(value.map.get('key'), -1)
+        assert(value.set instanceof Set)
+        assert(value.set.has('\u2603'))
+        done()
+      })
+      ipcRenderer.sendStructured('structured-message', {
+        date: date,
+        regexp: /a+b/g,
+        map: new Map([['key', -1]]),
+        set: new Set(['\u2603'])
+      })
+    })
+
+    it('handles shared and circular references', function (done) {
+      const shared = {name: 'shared'}
+      const obj = {a: shared, b: shared, list: [1.5, null, undefined]}
+      obj.self = obj
+      ipcRenderer.once('structured-message', function (event, value) {
+        assert.strictEqual(value.a, value.b)
+        assert.equal(value.a.name, 'shared')
+        assert.strictEqual(value.self, value)
+        assert.deepEqual(value.list, [1.5, null, undefined])
+        done()
+      })
+      ipcRenderer.sendStructured('structured-message', obj)
+    })
+
+    it('sends large buffers through shared memory', function (done) {
+      const threshold = ipcRenderer.getSharedMemoryThreshold()
+      ipcRenderer.setSharedMemoryThreshold(1024)
+      ipcMain.setSharedMemoryThreshold(1024)
+      const buffer = Buffer.alloc(64 * 1024, 'a')
+      const doubles = new Float64Array(1024).fill(0.5)
+      ipcRenderer.once('structured-message', function (event, value1, value2, value3) {
+        ipcRenderer.setSharedMemoryThreshold(threshold)
+        ipcMain.setSharedMemoryThreshold(threshold)
+        assert(Buffer.isBuffer(value1))
+        assert(value1.equals(buffer))
+        assert(value2 instanceof Float64Array)
+        assert.deepEqual(Array.from(value2), Array.from(doubles))
+        assert.strictEqual(value3, value1)
+        done()
+      })
+      ipcRenderer.sendStructured('structured-message', buffer, doubles, buffer)
+    })
+
+    it('throws when a value can not be cloned', function () {
+      assert.throws(function () {
+        ipcRenderer.sendStructured('structured-message', {fn: function () {}})
+      }, /could not be cloned/)
+    })
+  })
+
+  describe('webContents.broadcast', function () {
+    let windows = []
+
+    afterEach(function () {
+      ipcRenderer.removeAllListeners('broadcast-received')
+      windows.forEach((w) => w.destroy())
+      windows = []
+    })
+
+    it('sends the same message to every target', function (done) {
+      const threshold = ipcRenderer.getSharedMemoryThreshold()
+      ipcRenderer.setSharedMemoryThreshold(1024)
+      ipcMain.setSharedMemoryThreshold(1024)
+      const buffer = Buffer.alloc(64 * 1024, 'b')
+      const replyTo = remote.getCurrentWebContents().id
+      const received = []
+      ipcRenderer.on('broadcast-received', function (event, id, isBuffer, equal, value) {
+        assert(isBuffer)
+        assert(equal)
+        assert.deepEqual(value, {count: 1, replyTo: replyTo})
+        received.push(id)
+        if (received.length === 2) {
+          ipcRenderer.setSharedMemoryThreshold(threshold)
+          ipcMain.setSharedMemoryThreshold(threshold)
+          assert.deepEqual(received.sort(), ids.sort())
+          done()
+        }
+      })
+
+      let loaded = 0
+      const ids = []
+      for (let i = 0; i < 2; ++i) {
+        const w = new BrowserWindow({show: false})
+        windows.push(w)
+        ids.push(w.webContents.id)
+        w.webContents.once('did-finish-load', function () {
+          if (++loaded < 2) return
+          const sent = ipcRenderer.sendSync('broadcast-message', ids, buffer, {count: 1, replyTo: replyTo})
+          assert.equal(sent, 2)
+        })
+        w.loadURL('file://' + path.join(fixtures, 'pages', 'broadcast.html'))
+      }
+    })
+
+    it('throws without a channel', function () {
+      assert.throws(function () {
+        webContents.broadcast([])
+      }, /Missing required channel argument/)
+    })
+  })
+
+  describe('ipcRenderer.invoke', function () {
+    it('resolves with the value returned by the handler', function () {
+      const buffer = Buffer.from('invoke')
+      return ipcRenderer.invoke('invoke-echo', 'a', 1, buffer).then(function (result) {
+        assert.equal(result[0], 'a')
+        assert.equal(result[1], 1)
+        assert(Buffer.isBuffer(result[2]))
+        assert.equal(result[2].toString(), 'invoke')
+      })
+    })
+
+    it('waits for promises returned by the handler', function () {
+      return ipcRenderer.invoke('invoke-async', 21).then(function (result) {
+        assert.equal(result, 42)
+      })
+    })
+
+    it('rejects when the handler throws', function () {
+      return ipcRenderer.invoke('invoke-error').then(function () {
+        assert.fail('should not resolve')
+      }, function (error) {
+        assert.equal(error.message, 'handler failed')
+      })
+    })
+
+    it('rejects when there is no handler', function () {
+      return ipcRenderer.invoke('invoke-missing').then(function () {
+        assert.fail('should not resolve')
+      }, function (error) {
+        assert.equal(error.message, "No handler registered for 'invoke-missing'")
+      })
+    })
+
+    it('rejects when the reply times out', function () {
+      return ipcRenderer.invokeWithTimeout(50, 'invoke-never').then(function () {
+        assert.fail('should not resolve')
+      }, function (error) {
+        assert(/Timed out/.test(error.message))
+      })
+    })
+
+    it('throws for an invalid timeout', function () {
+      assert.throws(function () {
+        ipcRenderer.invokeWithTimeout(-1, 'invoke-echo')
+      }, /Timeout has to be a non-negative number/)
+      assert.throws(function () {
+        ipcRenderer.invokeWithTimeout(NaN, 'invoke-echo')
+      }, /Timeout has to be a non-negative number/)
+    })
+
+    it('can not register two handlers for a channel', function () {
+      assert.throws(function () {
+        ipcMain.handle('invoke-echo', function () {})
+      }, /already registered/)
+    })
+  })
+
   describe('ipc.sendSync', function () {
     afterEach(function () {
       ipcMain.removeAllListeners('send-sync-message')
@@ -1,4 +1,5 @@
 const assert = require('assert')
+const fs = require('fs')
 const http = require('http')
 const path = require('path')
 const qs = require('querystring')
@@ -568,6 +569,221 @@ describe('protocol module', function () {
     })
   })
 
+  describe('protocol.registerStreamProtocol', function () {
+    var filePath = path.join(__dirname, 'fixtures', 'assets', 'LICENSE')
+    var fileContent = fs.readFileSync(filePath, 'utf8')
+    var remoteFs = remote.require('fs')
+
+    it('sends the data of a stream as response', function (done) {
+      var handler = function (request, callback) {
+        callback(remoteFs.createReadStream(filePath))
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          cache: false,
+          success: function (data) {
+            assert.equal(data, fileContent)
+            done()
+          },
+          error: function (xhr, errorType, error) {
+            done(error)
+          }
+        })
+      })
+    })
+
+    it('sends the headers and request headers', function (done) {
+      var handler = function (request, callback) {
+        callback({
+          statusCode: 200,
+          headers: {
+            'Content-Length': fileContent.length,
+            'X-Request-Header': request.headers['X-Test']
+          },
+          mimeType: 'text/plain',
+          data: remoteFs.createReadStream(filePath)
+        })
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          headers: {'X-Test': 'value'},
+          cache: false,
+          success: function (data, status, request) {
+            assert.equal(data, fileContent)
+            assert.equal(request.getResponseHeader('X-Request-Header'), 'value')
+            assert.equal(request.getResponseHeader('Accept-Ranges'), 'bytes')
+            assert.equal(request.getResponseHeader('Content-Type'), 'text/plain')
+            done()
+          },
+          error: function (xhr, errorType, error) {
+            done(error)
+          }
+        })
+      })
+    })
+
+    it('sends the requested range of the stream', function (done) {
+      var handler = function (request, callback) {
+        callback({
+          headers: {'Content-Length': fileContent.length},
+          data: remoteFs.createReadStream(filePath)
+        })
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          headers: {Range: 'bytes=10-29'},
+          cache: false,
+          success: function (data, status, request) {
+            assert.equal(request.status, 206)
+            assert.equal(data, fileContent.substr(10, 20))
+            assert.equal(request.getResponseHeader('Content-Range'),
+                         `bytes 10-29/${fileContent.length}`)
+            done()
+          },
+          error: function (xhr, errorType, error) {
+            done(error)
+          }
+        })
+      })
+    })
+
+    it('fails the request when the range is not satisfiable', function (done) {
+      var handler = function (request, callback) {
+        callback({
+          headers: {'Content-Length': fileContent.length},
+          data: remoteFs.createReadStream(filePath)
+        })
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          headers: {Range: `bytes=${fileContent.length + 10}-`},
+          cache: false,
+          success: function () {
+            done('request succeeded but it should not')
+          },
+          error: function (xhr) {
+            assert.equal(xhr.status, 416)
+            done()
+          }
+        })
+      })
+    })
+
+    it('only accepts ranges of full responses', function (done) {
+      var handler = function (request, callback) {
+        callback({
+          statusCode: 201,
+          headers: {'Content-Length': fileContent.length},
+          data: remoteFs.createReadStream(filePath)
+        })
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          cache: false,
+          success: function (data, status, request) {
+            assert.equal(request.status, 201)
+            assert.equal(request.getResponseHeader('Accept-Ranges'), null)
+            done()
+          },
+          error: function (xhr, errorType, error) {
+            done(error)
+          }
+        })
+      })
+    })
+
+    it('fails when a header is invalid', function (done) {
+      var handler = function (request, callback) {
+        callback({
+          headers: {'X-Test': 'value\r\nX-Injected: value'},
+          data: remoteFs.createReadStream(filePath)
+        })
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          cache: false,
+          success: function () {
+            done('request succeeded but it should not')
+          },
+          error: function (xhr, errorType) {
+            assert.equal(errorType, 'error')
+            done()
+          }
+        })
+      })
+    })
+
+    it('fails when the stream is closed before it ends', function (done) {
+      var handler = function (request, callback) {
+        var stream = remoteFs.createReadStream(filePath)
+        stream.destroy()
+        callback(stream)
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          cache: false,
+          success: function () {
+            done('request succeeded but it should not')
+          },
+          error: function (xhr, errorType) {
+            assert.equal(errorType, 'error')
+            done()
+          }
+        })
+      })
+    })
+
+    it('fails when the response is not a stream', function (done) {
+      var handler = function (request, callback) {
+        callback({data: 'not a stream'})
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          cache: false,
+          success: function () {
+            done('request succeeded but it should not')
+          },
+          error: function (xhr, errorType) {
+            assert.equal(errorType, 'error')
+            done()
+          }
+        })
+      })
+    })
+  })
+
   describe('protocol.isProtocolHandled', function () {
     it('returns true for file:', function (done) {
       protocol.isProtocolHandled('file', function (result) {
@@ -880,6 +1096,272 @@ describe('protocol module', function () {
     })
   })
 
+  describe('protocol.setNativeRoutes', function () {
+    var handler = function (request, callback) {
+      callback('fallback')
+    }
+
+    it('sends the files without calling the handler', function (done) {
+      protocol.registerStringProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        protocol.setNativeRoutes(protocolName, {
+          files: {
+            [protocolName + '://fake-host/native']: {data: text, mimeType: 'text/plain'}
+          }
+        }, function (error) {
+          if (error) {
+            return done(error)
+          }
+          $.ajax({
+            url: protocolName + '://fake-host/native',
+            cache: false,
+            success: function (data, status, request) {
+              assert.equal(data, text)
+              assert.equal(request.getResponseHeader('Content-Type'), 'text/plain')
+              $.ajax({
+                url: protocolName + '://fake-host/other',
+                cache: false,
+                success: function (data) {
+                  assert.equal(data, 'fallback')
+                  done()
+                },
+                error: function (xhr, errorType, error) {
+                  done(error)
+                }
+              })
+            },
+            error: function (xhr, errorType, error) {
+              done(error)
+            }
+          })
+        })
+      })
+    })
+
+    it('sends the files in directories', function (done) {
+      var assetsPath = path.join(__dirname, 'fixtures', 'assets')
+      protocol.registerStringProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        protocol.setNativeRoutes(protocolName, {
+          directories: {
+            [protocolName + '://fake-host/assets/']: assetsPath
+          }
+        }, function (error) {
+          if (error) {
+            return done(error)
+          }
+          $.ajax({
+            url: protocolName + '://fake-host/assets/LICENSE',
+            cache: false,
+            success: function (data) {
+              assert.equal(data, fs.readFileSync(path.join(assetsPath, 'LICENSE'), 'utf8'))
+              done()
+            },
+            error: function (xhr, errorType, error) {
+              done(error)
+            }
+          })
+        })
+      })
+    })
+
+    it('only matches directories on path segments', function (done) {
+      var assetsPath = path.join(__dirname, 'fixtures', 'assets')
+      protocol.registerStringProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        protocol.setNativeRoutes(protocolName, {
+          directories: {
+            [protocolName + '://fake-host/assets']: assetsPath
+          }
+        }, function (error) {
+          if (error) {
+            return done(error)
+          }
+          $.ajax({
+            url: protocolName + '://fake-host/assets-other/LICENSE',
+            cache: false,
+            success: function (data) {
+              assert.equal(data, 'fallback')
+              done()
+            },
+            error: function (xhr, errorType, error) {
+              done(error)
+            }
+          })
+        })
+      })
+    })
+
+    it('throws error when the routes are invalid', function () {
+      assert.throws(function () {
+        protocol.setNativeRoutes(protocolName, {
+          files: {'http://fake-host': {data: text}}
+        })
+      }, /is not a URL of the 'sp' scheme/)
+      assert.throws(function () {
+        protocol.setNativeRoutes(protocolName, {
+          directories: {[protocolName + '://fake-host/']: 'relative'}
+        })
+      }, /must be an absolute path/)
+    })
+
+    it('returns error when scheme is not registered', function (done) {
+      protocol.setNativeRoutes(protocolName, {}, function (error) {
+        assert.notEqual(error, null)
+        done()
+      })
+    })
+  })
+
+  describe('protocol response cache', function () {
+    var handlerCalls = 0
+    var handler = function (request, callback) {
+      handlerCalls++
+      callback({
+        data: text,
+        mimeType: 'text/plain',
+        headers: {'Cache-Control': 'max-age=60', 'ETag': '"v1"', 'X-Custom': 'custom'}
+      })
+    }
+
+    beforeEach(function () {
+      handlerCalls = 0
+      protocol.setResponseCacheSize(1024 * 1024)
+    })
+
+    afterEach(function () {
+      protocol.setResponseCacheSize(0)
+    })
+
+    var request = function (callback) {
+      $.ajax({
+        url: protocolName + '://fake-host/cached',
+        success: function (data, status, request) {
+          assert.equal(data, text)
+          callback(request)
+        },
+        error: function (xhr, errorType, error) {
+          callback(null, error)
+        }
+      })
+    }
+
+    it('sends the cached response without calling the handler', function (done) {
+      protocol.registerStringProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        request(function (xhr, error) {
+          if (error) {
+            return done(error)
+          }
+          assert.equal(xhr.getResponseHeader('ETag'), '"v1"')
+          request(function (xhr, error) {
+            if (error) {
+              return done(error)
+            }
+            assert.equal(handlerCalls, 1)
+            assert.equal(xhr.getResponseHeader('Content-Type'), 'text/plain')
+            assert.equal(xhr.getResponseHeader('X-Custom'), 'custom')
+            protocol.getResponseCacheStats(function (stats) {
+              assert.equal(stats.hits, 1)
+              assert.equal(stats.entries, 1)
+              done()
+            })
+          })
+        })
+      })
+    })
+
+    it('answers a matching If-None-Match with 304', function (done) {
+      protocol.registerStringProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        request(function (xhr, error) {
+          if (error) {
+            return done(error)
+          }
+          $.ajax({
+            url: protocolName + '://fake-host/cached',
+            headers: {'If-None-Match': '"other", W/"v1"'},
+            complete: function (xhr) {
+              assert.equal(xhr.status, 304)
+              assert.equal(handlerCalls, 1)
+              done()
+            }
+          })
+        })
+      })
+    })
+
+    it('fails the request when a header is invalid', function (done) {
+      var invalidHandler = function (request, callback) {
+        callback({data: text, headers: {'Cache-Control': 'max-age=60', 'ETag': 'v1'}})
+      }
+      protocol.registerStringProtocol(protocolName, invalidHandler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        request(function (xhr, error) {
+          assert.equal(xhr, null)
+          done()
+        })
+      })
+    })
+
+    it('calls the handler again after the response is invalidated', function (done) {
+      protocol.registerStringProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        request(function (xhr, error) {
+          if (error) {
+            return done(error)
+          }
+          protocol.invalidateResponseCache(protocolName + '://fake-host/')
+          request(function (xhr, error) {
+            if (error) {
+              return done(error)
+            }
+            assert.equal(handlerCalls, 2)
+            done()
+          })
+        })
+      })
+    })
+
+    it('does not cache responses without max-age', function (done) {
+      var noCacheHandler = function (request, callback) {
+        handlerCalls++
+        callback({data: text, headers: {'Cache-Control': 'no-cache'}})
+      }
+      protocol.registerStringProtocol(protocolName, noCacheHandler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        request(function (xhr, error) {
+          if (error) {
+            return done(error)
+          }
+          request(function (xhr, error) {
+            if (error) {
+              return done(error)
+            }
+            assert.equal(handlerCalls, 2)
+            done()
+          })
+        })
+      })
+    })
+  })
+
   describe('protocol.registerStandardSchemes', function () {
     const standardScheme = remote.getGlobal('standardScheme')
     const origin = standardScheme + '://fake-host'
@@ -299,6 +299,67 @@ describe('session module', function () {
     })
   })
 
+  describe('ses.setSpareRendererPoolSize(size)', function () {
+    afterEach(function () {
+      session.defaultSession.setSpareRendererPoolSize(0)
+    })
+
+    it('throws when the size is negative', function () {
+      assert.throws(function () {
+        session.defaultSession.setSpareRendererPoolSize(-1)
+      }, /Size must not be negative/)
+    })
+
+    it('lets navigations take spare renderers', function (done) {
+      const ses = session.defaultSession
+      const before = ses.getSpareRendererPoolStats()
+      const pages = ['base-page.html', 'a.html', 'base-page.html']
+      ses.setSpareRendererPoolSize(1)
+      w.webContents.on('did-finish-load', function () {
+        if (pages.length > 0) {
+          w.loadURL('file://' + path.join(fixtures, 'pages', pages.shift()))
+          return
+        }
+        const stats = ses.getSpareRendererPoolStats()
+        assert(stats.launches > before.launches)
+        assert(stats.hits > before.hits)
+        assert(stats.savedTime > before.savedTime)
+        ses.setSpareRendererPoolSize(0)
+        assert.equal(ses.getSpareRendererPoolStats().spares, 0)
+        done()
+      })
+      w.loadURL('file://' + path.join(fixtures, 'pages', pages.shift()))
+    })
+
+    it('shuts down the spares it discards', function (done) {
+      const ses = session.defaultSession
+      const isRunning = function (pid) {
+        try {
+          process.kill(pid, 0)
+          return true
+        } catch (error) {
+          return false
+        }
+      }
+      // The pool launches spares after the first navigation that needs one.
+      ses.setSpareRendererPoolSize(2)
+      w.webContents.once('did-finish-load', function () {
+        const waitForLaunch = function () {
+          const pids = ses.getSpareRendererPoolStats().processIds
+          if (pids.length < 2) return setTimeout(waitForLaunch, 50)
+          ses.setSpareRendererPoolSize(0)
+          const waitForExit = function () {
+            if (pids.some(isRunning)) return setTimeout(waitForExit, 50)
+            done()
+          }
+          waitForExit()
+        }
+        waitForLaunch()
+      })
+      w.loadURL('file://' + path.join(fixtures, 'pages', 'a.html'))
+    })
+  })
+
   describe('ses.protocol', function () {
     const partitionName = 'temp'
     const protocolName = 'sp'
@@ -39,6 +39,21 @@ describe('webRequest module', function () {
       ses.webRequest.onBeforeRequest(null)
     })
 
+    it('throws for an invalid filter', function () {
+      assert.throws(function () {
+        ses.webRequest.onBeforeRequest('filter', function () {})
+      }, /Filter must be an Object/)
+      assert.throws(function () {
+        ses.webRequest.onBeforeRequest({urls: ['not a pattern']}, function () {})
+      }, /Invalid url pattern/)
+      assert.throws(function () {
+        ses.webRequest.onBeforeRequest({
+          urls: ['not a pattern'],
+          batch: {interval: 10}
+        }, function () {})
+      }, /Invalid url pattern/)
+    })
+
     it('can cancel the request', function (done) {
       ses.webRequest.onBeforeRequest(function (details, callback) {
         callback({
@@ -85,6 +100,39 @@ describe('webRequest module', function () {
       })
     })
 
+    it('can filter URLs with many patterns', function (done) {
+      var urls = []
+      for (var i = 0; i < 1000; i++) {
+        urls.push('*://*.host' + i + '.com/*')
+        urls.push(defaultURL + 'path' + i + '/*')
+      }
+      urls.push('http://127.0.0.1/*')
+      urls.push(defaultURL + 'filter/*')
+      ses.webRequest.onBeforeRequest({urls: urls}, function (details, callback) {
+        callback({
+          cancel: true
+        })
+      })
+      $.ajax({
+        url: defaultURL + 'nofilter/test',
+        success: function (data) {
+          assert.equal(data, '/nofilter/test')
+          $.ajax({
+            url: defaultURL + 'filter/test',
+            success: function () {
+              done('unexpected success')
+            },
+            error: function () {
+              done()
+            }
+          })
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+
     it('receives details object', function (done) {
       ses.webRequest.onBeforeRequest(function (details, callback) {
         assert.equal(typeof details.id, 'number')
@@ -242,6 +290,44 @@ describe('webRequest module', function () {
     })
   })
 
+  describe('webRequest.onCompleted', function () {
+    afterEach(function () {
+      ses.webRequest.onCompleted(null)
+    })
+
+    it('delivers details in batches', function (done) {
+      var filter = {
+        urls: [defaultURL + 'batch/*'],
+        batch: {interval: 50, maxSize: 2}
+      }
+      var urls = []
+      ses.webRequest.onCompleted(filter, function (batch) {
+        assert(Array.isArray(batch))
+        assert(batch.length <= 2)
+        batch.forEach(function (details) {
+          assert.equal(typeof details.id, 'number')
+          urls.push(details.url)
+        })
+        if (urls.length === 3) {
+          assert.deepEqual(urls.sort(), [
+            defaultURL + 'batch/1',
+            defaultURL + 'batch/2',
+            defaultURL + 'batch/3'
+          ])
+          done()
+        }
+      })
+      for (var i = 1; i <= 3; i++) {
+        $.ajax({
+          url: defaultURL + 'batch/' + i,
+          error: function (xhr, errorType) {
+            done(errorType)
+          }
+        })
+      }
+    })
+  })
+
   describe('webRequest.onHeadersReceived', function () {
     afterEach(function () {
       ses.webRequest.onHeadersReceived(null)
@@ -410,6 +496,12 @@ describe('webRequest module', function () {
       ses.webRequest.onCompleted(null)
     })
 
+    it('throws without a listener', function () {
+      assert.throws(function () {
+        ses.webRequest.onCompleted()
+      }, /Must pass null or a Function/)
+    })
+
     it('receives details object', function (done) {
       ses.webRequest.onCompleted(function (details) {
         assert.equal(typeof details.fromCache, 'boolean')
@@ -453,4 +545,140 @@ describe('webRequest module', function () {
       })
     })
   })
+
+  describe('webRequest.setRules', function () {
+    afterEach(function () {
+      ses.webRequest.setRules(null)
+      ses.webRequest.onBeforeRequest(null)
+    })
+
+    it('throws for invalid rules', function () {
+      assert.throws(function () {
+        ses.webRequest.setRules([{action: 'unknown'}])
+      }, /Unknown rule action/)
+      assert.throws(function () {
+        ses.webRequest.setRules([{action: 'redirect'}])
+      }, /redirectURL/)
+      assert.throws(function () {
+        ses.webRequest.setRules('rules')
+      }, /Must pass null or an Array/)
+    })
+
+    it('throws for invalid headers', function () {
+      assert.throws(function () {
+        ses.webRequest.setRules([{
+          action: 'modifyHeaders',
+          requestHeaders: {set: {'X-Test': 'a\r\nX-Injected: b'}}
+        }])
+      }, /Invalid value of header 'X-Test'/)
+      assert.throws(function () {
+        ses.webRequest.setRules([{
+          action: 'modifyHeaders',
+          responseHeaders: {set: {'X Test': 'a'}}
+        }])
+      }, /Invalid header name 'X Test'/)
+      assert.throws(function () {
+        ses.webRequest.setRules([{
+          action: 'modifyHeaders',
+          responseHeaders: {remove: ['X:Test']}
+        }])
+      }, /Invalid header name 'X:Test'/)
+    })
+
+    it('can block requests without calling listeners', function (done) {
+      ses.webRequest.setRules([{
+        urls: [defaultURL + 'blocked/*'],
+        action: 'block'
+      }])
+      ses.webRequest.onBeforeRequest(function (details, callback) {
+        assert.notEqual(details.url, defaultURL + 'blocked/test')
+        callback({})
+      })
+      $.ajax({
+        url: defaultURL + 'allowed/test',
+        success: function (data) {
+          assert.equal(data, '/allowed/test')
+          $.ajax({
+            url: defaultURL + 'blocked/test',
+            success: function () {
+              done('unexpected success')
+            },
+            error: function () {
+              done()
+            }
+          })
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+
+    it('can redirect requests', function (done) {
+      ses.webRequest.setRules([{
+        urls: [defaultURL + 'from/*'],
+        action: 'redirect',
+        redirectURL: defaultURL + 'to'
+      }])
+      $.ajax({
+        url: defaultURL + 'from/test',
+        success: function (data) {
+          assert.equal(data, '/to')
+          done()
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+
+    it('can modify headers', function (done) {
+      ses.webRequest.setRules([{
+        action: 'modifyHeaders',
+        requestHeaders: {set: {Accept: '*/*;test/header'}},
+        responseHeaders: {set: {Rule: 'Header'}, remove: ['Custom']}
+      }])
+      $.ajax({
+        url: defaultURL,
+        success: function (data, textStatus, xhr) {
+          assert.equal(data, '/header/received')
+          assert.equal(xhr.getResponseHeader('Rule'), 'Header')
+          assert.equal(xhr.getResponseHeader('Custom'), null)
+          done()
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+  })
+
+  describe('webRequest.getEventStats', function () {
+    afterEach(function () {
+      ses.webRequest.onSendHeaders(null)
+    })
+
+    it('counts the details that were dispatched and read', function (done) {
+      var before = ses.webRequest.getEventStats().onSendHeaders
+      var dispatched = before ? before.dispatched : 0
+      var materialized = before ? before.materializedFields : 0
+      ses.webRequest.onSendHeaders(function (details) {
+        assert.equal(details.url, defaultURL)
+      })
+      $.ajax({
+        url: defaultURL,
+        success: function () {
+          var stats = ses.webRequest.getEventStats().onSendHeaders
+          assert(stats.dispatched > dispatched)
+          assert.equal(stats.materializedFields, materialized)
+          assert(stats.lazyFields >= stats.dispatched)
+          assert.equal(typeof stats.averageLatency, 'number')
+          done()
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+  })
 })
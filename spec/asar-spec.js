@@ -31,6 +31,13 @@ describe('asar package', function () {
         assert.equal(fs.readFileSync(file3).toString().trim(), 'file3')
       })
 
+      it('returns a buffer that does not share memory with the archive', function () {
+        var file1 = path.join(fixtures, 'asar', 'a.asar', 'file1')
+        var buffer = fs.readFileSync(file1)
+        buffer.fill(0)
+        assert.equal(fs.readFileSync(file1).toString().trim(), 'file1')
+      })
+
       it('reads from a empty file', function () {
         var file = path.join(fixtures, 'asar', 'empty.asar', 'file1')
         var buffer = fs.readFileSync(file)
@@ -72,6 +79,15 @@ describe('asar package', function () {
         var p = path.join(fixtures, 'asar', 'unpack.asar', 'a.txt')
         assert.equal(fs.readFileSync(p).toString().trim(), 'a')
       })
+
+      it('reads a compressed file', function () {
+        var p = path.join(fixtures, 'asar', 'compressed.asar', 'hello.txt')
+        var content = fs.readFileSync(p, 'utf8')
+        assert.equal(content, 'hello compressed world\n'.repeat(20))
+        assert.equal(fs.statSync(p).size, content.length)
+        p = path.join(fixtures, 'asar', 'compressed.asar', 'plain.txt')
+        assert.equal(fs.readFileSync(p).toString().trim(), 'plain')
+      })
     })
 
     describe('fs.readFile', function () {
@@ -118,6 +134,15 @@ describe('asar package', function () {
           done()
         })
       })
+
+      it('reads a compressed file', function (done) {
+        var p = path.join(fixtures, 'asar', 'compressed.asar', 'hello.txt')
+        fs.readFile(p, 'utf8', function (err, content) {
+          assert.equal(err, null)
+          assert.equal(content, 'hello compressed world\n'.repeat(20))
+          done()
+        })
+      })
     })
 
     describe('fs.lstatSync', function () {
@@ -616,6 +641,59 @@ describe('asar package', function () {
         var p = path.join(fixtures, 'asar', 'unpack.asar', 'a.txt')
         assert.equal(internalModuleReadFile(p).toString().trim(), 'a')
       })
+
+      it('reads a compressed file', function () {
+        var p = path.join(fixtures, 'asar', 'compressed.asar', 'module.js')
+        assert.equal(internalModuleReadFile(p), "module.exports = 'compressed module'\n")
+        assert.equal(require(p), 'compressed module')
+      })
+    })
+
+    describe('archive cache', function () {
+      var asar = process.binding('atom_common_asar')
+
+      it('reuses opened archives and reports the counters', function () {
+        var p = path.join(fixtures, 'asar', 'a.asar')
+        var before = asar.getArchiveCacheStats()
+        assert(asar.createArchive(p))
+        assert(asar.createArchive(p))
+        var after = asar.getArchiveCacheStats()
+        assert.equal(after.hits + after.misses, before.hits + before.misses + 2)
+        assert(after.hits > before.hits)
+        assert(after.archiveCount > 0)
+        assert.equal(typeof after.evictions, 'number')
+        assert.equal(typeof after.headerMemory, 'number')
+      })
+
+      it('closes the least recently used archives opened by fs', function () {
+        var originalFs = require('original-fs')
+        var os = require('os')
+        var dir = originalFs.mkdtempSync(path.join(os.tmpdir(), 'electron-asar-spec-'))
+        var content = originalFs.readFileSync(path.join(fixtures, 'asar', 'a.asar'))
+        var count = 70
+        var archives = []
+        for (var i = 0; i < count; ++i) {
+          archives.push(path.join(dir, i + '.asar'))
+          originalFs.writeFileSync(archives[i], content)
+        }
+        try {
+          var before = asar.getArchiveCacheStats()
+          archives.forEach(function (archive) {
+            assert.equal(fs.readFileSync(path.join(archive, 'file1')).toString().trim(), 'file1')
+          })
+          var after = asar.getArchiveCacheStats()
+          assert(after.archiveCount <= 64)
+          assert(after.evictions - before.evictions >= count - 64)
+        } finally {
+          // Archives that are still referenced can not be deleted on Windows.
+          try {
+            archives.forEach(function (archive) {
+              originalFs.unlinkSync(archive)
+            })
+            originalFs.rmdirSync(dir)
+          } catch (error) {}
+        }
+      })
     })
 
     describe('process.noAsar', function () {
@@ -696,6 +774,14 @@ describe('asar package', function () {
       })
     })
 
+    it('can request a compressed file in package', function (done) {
+      var p = path.resolve(fixtures, 'asar', 'compressed.asar', 'hello.txt')
+      $.get('file://' + p, function (data) {
+        assert.equal(data, 'hello compressed world\n'.repeat(20))
+        done()
+      })
+    })
+
     it('can request a linked file in package', function (done) {
       var p = path.resolve(fixtures, 'asar', 'a.asar', 'link2', 'link1')
       $.get('file://' + p, function (data) {
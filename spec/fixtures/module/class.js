@@ -25,5 +25,18 @@ class DerivedClass extends BaseClass {
 
 module.exports = {
   base: new BaseClass(),
-  derived: new DerivedClass()
+  derived: new DerivedClass(),
+  create () {
+    return new DerivedClass()
+  },
+  addMethod () {
+    BaseClass.prototype.added = function () {
+      return 'added'
+    }
+  },
+  setChangedMember (isMethod) {
+    BaseClass.prototype.changed = isMethod ? function () {
+      return 'method'
+    } : 'property'
+  }
 }
@@ -38,6 +38,33 @@ ipcMain.on('message', function (event, arg) {
   event.sender.send('message', arg)
 })
 
+ipcMain.on('structured-message', function (event, ...args) {
+  event.sender.sendStructured('structured-message', ...args)
+})
+
+ipcMain.on('broadcast-message', function (event, ids, ...args) {
+  const targets = ids.map((id) => electron.webContents.fromId(id))
+  event.returnValue = electron.webContents.broadcast(targets, 'broadcast-message', ...args)
+})
+
+ipcMain.handle('invoke-echo', function (event, ...args) {
+  return args
+})
+
+ipcMain.handle('invoke-async', function (event, value) {
+  return new Promise((resolve) => {
+    setTimeout(() => resolve(value * 2), 10)
+  })
+})
+
+ipcMain.handle('invoke-error', function () {
+  throw new Error('handler failed')
+})
+
+ipcMain.handle('invoke-never', function () {
+  return new Promise(() => {})
+})
+
 // Write output to file if OUTPUT_TO_FILE is defined.
 const outputToFile = process.env.OUTPUT_TO_FILE
 const print = function (_, args) {